@@ -1,4 +1,4 @@
-QT       += core gui
+QT       += core gui concurrent
 qtHaveModule(printsupport): QT += printsupport
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
@@ -42,8 +42,11 @@ SOURCES += \
     src/data/calculation/intervalconflictreport.cpp \
     src/data/calculation/railwaystationeventaxis.cpp \
     src/data/calculation/stationeventaxis.cpp \
+    src/data/common/jsonstreamreader.cpp \
     src/data/common/qesystem.cpp \
     src/data/common/stationname.cpp \
+    src/data/common/timeutil.cpp \
+    src/data/diagram/binaryformat.cpp \
     src/data/diagram/config.cpp \
     src/data/diagram/diadiff.cpp \
     src/data/diagram/diagram.cpp \
@@ -53,6 +56,7 @@ SOURCES += \
     src/data/diagram/trainevents.cpp \
     src/data/diagram/traingap.cpp \
     src/data/diagram/trainline.cpp \
+    src/data/diagram/trainlineindex.cpp \
     src/data/gapset/crgroups.cpp \
     src/data/gapset/crset.cpp \
     src/data/gapset/gapgroupabstract.cpp \
@@ -69,12 +73,16 @@ SOURCES += \
     src/data/rail/rulernode.cpp \
     src/data/rail/trackdiagramdata.cpp \
     src/data/train/routing.cpp \
+    src/data/train/timetablearrays.cpp \
     src/data/train/train.cpp \
     src/data/train/traincollection.cpp \
     src/data/train/trainfiltercore.cpp \
     src/data/train/trainname.cpp \
+    src/data/train/trainnameindex.cpp \
     src/data/train/trainstation.cpp \
+    src/data/train/trainstationindex.cpp \
     src/data/train/traintype.cpp \
+    src/data/train/typeclassifier.cpp \
     src/data/train/typemanager.cpp \
     src/dialogs/batchcopytraindialog.cpp \
     src/dialogs/changestationnamedialog.cpp \
@@ -150,6 +158,7 @@ SOURCES += \
     src/railnet/path/railpreviewdialog.cpp \
     src/railnet/raildb/raildb.cpp \
     src/railnet/raildb/raildbcontext.cpp \
+    src/railnet/raildb/raildbindex.cpp \
     src/railnet/raildb/raildbitems.cpp \
     src/railnet/raildb/raildbmodel.cpp \
     src/railnet/raildb/raildbnavi.cpp \
@@ -241,10 +250,14 @@ HEADERS += \
     src/data/calculation/intervalconflictreport.h \
     src/data/calculation/railwaystationeventaxis.h \
     src/data/calculation/stationeventaxis.h \
+    src/data/common/backgroundtask.h \
     src/data/common/direction.h \
+    src/data/common/jsonstreamreader.h \
     src/data/common/qeglobal.h \
     src/data/common/qesystem.h \
     src/data/common/stationname.h \
+    src/data/common/timeutil.h \
+    src/data/diagram/binaryformat.h \
     src/data/diagram/config.h \
     src/data/diagram/diadiff.h \
     src/data/diagram/diagram.h \
@@ -254,6 +267,7 @@ HEADERS += \
     src/data/diagram/trainevents.h \
     src/data/diagram/traingap.h \
     src/data/diagram/trainline.h \
+    src/data/diagram/trainlineindex.h \
     src/data/diagram/xtl_matrix.hpp \
     src/data/gapset/crgroups.h \
     src/data/gapset/crset.h \
@@ -274,12 +288,16 @@ HEADERS += \
     src/data/rail/rulernode.h \
     src/data/rail/trackdiagramdata.h \
     src/data/train/routing.h \
+    src/data/train/timetablearrays.h \
     src/data/train/train.h \
     src/data/train/traincollection.h \
     src/data/train/trainfiltercore.h \
     src/data/train/trainname.h \
+    src/data/train/trainnameindex.h \
     src/data/train/trainstation.h \
+    src/data/train/trainstationindex.h \
     src/data/train/traintype.h \
+    src/data/train/typeclassifier.h \
     src/data/train/typemanager.h \
     src/dialogs/batchcopytraindialog.h \
     src/dialogs/changestationnamedialog.h \
@@ -347,6 +365,7 @@ HEADERS += \
     src/railnet/graph/railnet.h \
     src/railnet/graph/vertexlistwidget.h \
     src/railnet/graph/viewadjacentwidget.h \
+    src/railnet/graph/xtl_csr.hpp \
     src/railnet/graph/xtl_graph.hpp \
     src/railnet/path/graphpathmodel.h \
     src/railnet/path/pathoperation.h \
@@ -356,6 +375,7 @@ HEADERS += \
     src/railnet/path/railpreviewdialog.h \
     src/railnet/raildb/raildb.h \
     src/railnet/raildb/raildbcontext.h \
+    src/railnet/raildb/raildbindex.h \
     src/railnet/raildb/raildbitems.h \
     src/railnet/raildb/raildbmodel.h \
     src/railnet/raildb/raildbnavi.h \
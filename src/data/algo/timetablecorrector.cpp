@@ -1,7 +1,7 @@
 ﻿#include "timetablecorrector.h"
 #include <vector>
 #include <data/train/train.h>
-#include <util/utilfunc.h>
+#include <data/common/timeutil.h>
 #include <stdexcept>
 
 bool TimetableCorrector::autoCorrect(std::shared_ptr<Train> train)
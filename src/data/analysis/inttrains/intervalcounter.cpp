@@ -1,12 +1,18 @@
 ﻿#include "intervalcounter.h"
 #include <optional>
+#include <atomic>
+#include <QVector>
+#include <QThread>
+#include <QtConcurrent>
 
 #include <data/train/trainfiltercore.h>
 #include <data/train/traincollection.h>
 #include <data/train/train.h>
+#include <data/train/timetablearrays.h>
 #include <data/diagram/trainadapter.h>
 #include <data/diagram/trainline.h>
 #include <data/rail/railstation.h>
+#include <data/rail/railway.h>
 
 IntervalCounter::IntervalCounter(const TrainCollection &coll,
                                  const TrainFilterCore& filter):
@@ -15,6 +21,16 @@ IntervalCounter::IntervalCounter(const TrainCollection &coll,
 
 }
 
+IntervalCounter::IntervalCounter(const IntervalCounter& other, const TrainCollection& coll,
+                                 const TrainFilterCore& filter):
+    coll(coll), _businessOnly(other._businessOnly), _stopOnly(other._stopOnly),
+    _passenterOnly(other._passenterOnly), _freightOnly(other._freightOnly), _filter(filter),
+    _multiStart(other._multiStart), _multiEnd(other._multiEnd),
+    _regexStart(other._regexStart), _regexEnd(other._regexEnd)
+{
+
+}
+
 IntervalTrainList IntervalCounter::getIntervalTrains(
         std::shared_ptr<const Railway> rail,
         std::shared_ptr<const RailStation> from,
@@ -29,14 +45,14 @@ IntervalTrainList IntervalCounter::getIntervalTrains(
         if (!adp) continue;
         std::optional<std::deque<AdapterStation>::iterator> start_itr=std::nullopt;
         bool start_is_starting=false;
-        foreach(auto line, adp->lines()){
+        for (const auto& line : adp->lines()){
             for(auto itr=line->stations().begin();
                 itr!=line->stations().end();++itr){
-                if (itr->railStation.lock() == from){
+                if (itr->station == from.get()){
                     start_itr=itr;
                     start_is_starting=line->isStartingStation(itr);
                 }else if(start_itr.has_value() &&
-                         itr->railStation.lock() == to){
+                         itr->station == to.get()){
                     // 结束
                     IntervalTrainInfo info(train, &*(start_itr.value()->trainStation),
                                            &*(itr->trainStation),start_is_starting,
@@ -56,30 +72,56 @@ IntervalTrainList IntervalCounter::getIntervalTrains(
         const QString &from, const QString &to)
 {
     auto search_start = transSearchStation(from, _multiStart), search_end = transSearchStation(to, _multiEnd);
+    const auto& names_start = transSearchNames(search_start, _regexStart),
+        & names_end = transSearchNames(search_end, _regexEnd);
+
+    // 2026.10  由车站索引取得各车次中与发站、到站匹配的站序，不再逐车次逐站判断站名
+    auto& index = coll.stationIndex();
+    const auto& hits_start = _regexStart ? index.findRegex(coll.trains(), search_start) :
+        index.find(coll.trains(), names_start);
+    const auto& hits_end = _regexEnd ? index.findRegex(coll.trains(), search_end) :
+        index.find(coll.trains(), names_end);
+
     IntervalTrainList res{};
     foreach(auto train,coll.trains()){
+        auto itr_start = hits_start.constFind(train.get()), itr_end = hits_end.constFind(train.get());
+        if (itr_start == hits_start.cend() || itr_end == hits_end.cend())
+            continue;
         if (!_filter.check(train))
             continue;
+        auto arrays = train->timetableArrays();
+        const auto& pos_start = itr_start.value(), & pos_end = itr_end.value();
+
+        // 按站序合并两表，逻辑与逐站遍历时刻表一致：同一站先按发站判断
         const TrainStation* start_station=nullptr;
         bool start_is_starting=false;
-        for(auto itr=train->timetable().begin();
-            itr!=train->timetable().end();++itr){
-            //if (itr->name.equalOrBelongsTo(from)){
-            if (checkStationName(itr->name, search_start, _regexStart)){
+        for (size_t i = 0, j = 0; i < pos_start.size() || j < pos_end.size();) {
+            int pos;
+            bool is_start;
+            if (j >= pos_end.size() || (i < pos_start.size() && pos_start[i] <= pos_end[j])) {
+                pos = pos_start[i++];
+                is_start = true;
+                if (j < pos_end.size() && pos_end[j] == pos)
+                    j++;
+            }
+            else {
+                pos = pos_end[j++];
+                is_start = false;
+            }
+            const TrainStation* this_station = &*arrays->node(pos);
+            if (is_start) {
                 // 2022.04.24：允许多车站后，替代需要条件
                 // 如果上一站满足停车和营业条件但本站不满足，不替换；否则替换
-                auto* this_station = &*itr;
-                bool this_is_starting = train->isStartingStation(itr->name);
+                bool this_is_starting = train->isStartingStation(this_station->name);
                 if (!start_station || !checkStationStopBusiness(*start_station, start_is_starting) ||
                     checkStationStopBusiness(*this_station, this_is_starting)) {
                     start_station = this_station;
                     start_is_starting = this_is_starting;
                 }
-            }else if(start_station &&
-                    checkStationName(itr->name, search_end, _regexEnd)){    
+            }else if(start_station){
                 IntervalTrainInfo info(
-                            train, start_station, &*itr, start_is_starting,
-                            train->isTerminalStation(itr->name));
+                            train, start_station, this_station, start_is_starting,
+                            train->isTerminalStation(this_station->name));
                 if (checkStopBusiness(info)){
                     res.emplace_back(std::move(info));
                     start_station=nullptr;
@@ -92,49 +134,60 @@ IntervalTrainList IntervalCounter::getIntervalTrains(
 
 RailIntervalCount IntervalCounter::getIntervalCountSource(
         std::shared_ptr<const Railway> rail,
-        std::shared_ptr<const RailStation> center) const
+        std::shared_ptr<const RailStation> center, const TaskContext& ctx) const
 {
-    RailIntervalCount res{};
+    raw_count_t res{};
+    ctx.setProgressRange(0, coll.trainCount());
+    int cnt = 0;
     foreach(auto train,coll.trains()){
+        if (ctx.isCanceled())
+            return {};
+        ctx.setProgressValue(cnt++);
         auto adp=train->adapterFor(*rail);
         if (!adp) continue;
         const TrainStation* center_station=nullptr;
         bool center_is_start_or_end=false;
-        foreach(auto line,adp->lines()){
+        for (const auto& line : adp->lines()){
             if (!_filter.check(train))
                 continue;
             // 注意循环到的车站其实都是本线的，和PyETRC不一样。
             // 只要分清楚前后站即可，由center_station控制。
             for(auto itr=line->stations().begin();
                 itr!=line->stations().end();++itr){
-                if (itr->railStation.lock()==center){
+                if (itr->station==center.get()){
                     center_station=&*(itr->trainStation);
                     center_is_start_or_end=line->isStartingStation(itr);
 
                 }else{
                     // 非中心站
                     if (center_station
-                            && checkStation(itr->railStation.lock())){
+                            && checkStation(*itr->station)){
                         // 找到start->end的对
                         IntervalTrainInfo info(train,center_station,
                                                &*(itr->trainStation),
                                                center_is_start_or_end,
                                                line->isTerminalStation(itr));
                         if(checkStopBusiness(info)){
-                            res[itr->railStation.lock()].add(std::move(info));
+                            res[itr->station].add(std::move(info));
                         }
                     }
                 }
             }
         }
     }
-    return res;
+    return toRailCount(*rail, std::move(res));
 }
 
-RailIntervalCount IntervalCounter::getIntervalCountDrain(std::shared_ptr<const Railway> rail, std::shared_ptr<const RailStation> drain) const
+RailIntervalCount IntervalCounter::getIntervalCountDrain(std::shared_ptr<const Railway> rail,
+    std::shared_ptr<const RailStation> drain, const TaskContext& ctx) const
 {
-    RailIntervalCount res{};
+    raw_count_t res{};
+    ctx.setProgressRange(0, coll.trainCount());
+    int cnt = 0;
     foreach(auto train,coll.trains()){
+        if (ctx.isCanceled())
+            return {};
+        ctx.setProgressValue(cnt++);
         auto adp=train->adapterFor(*rail);
         if (!adp) continue;
         const TrainStation* center_station=nullptr;
@@ -144,17 +197,17 @@ RailIntervalCount IntervalCounter::getIntervalCountDrain(std::shared_ptr<const R
              lineit!=adp->lines().rend();++lineit){
             if (!_filter.check(train))
                 continue;
-            auto line=*lineit;
+            const auto& line=*lineit;
             for(auto itr=line->stations().rbegin();
                 itr!=line->stations().rend();++itr){
 
-                if (itr->railStation.lock()==drain){
+                if (itr->station==drain.get()){
                     center_station=&*(itr->trainStation);
                     center_is_start_or_end=line->isTerminalStation(&*itr);
                 }else{
                     // 非中心站
                     if (center_station
-                            && checkStation(itr->railStation.lock())){
+                            && checkStation(*itr->station)){
                         // 找到start->end的对
                         IntervalTrainInfo info(train,
                                                &*(itr->trainStation),
@@ -162,16 +215,130 @@ RailIntervalCount IntervalCounter::getIntervalCountDrain(std::shared_ptr<const R
                                                line->isStartingStation(&*itr),
                                                center_is_start_or_end);
                         if(checkStopBusiness(info)){
-                            res[itr->railStation.lock()].add(std::move(info));
+                            res[itr->station].add(std::move(info));
                         }
                     }
                 }
             }
         }
     }
+    return toRailCount(*rail, std::move(res));
+}
+
+RailIntervalMatrix IntervalCounter::getIntervalCountMatrix(
+        std::shared_ptr<const Railway> rail, const TaskContext& ctx) const
+{
+    // 车次按原顺序分块，每块在本地统计，最后按块的顺序合并，使各格中的车次顺序与逐站查询一致
+    struct Chunk {
+        int begin, end;
+        raw_matrix_t res;
+    };
+    const auto& trains = coll.trains();
+    const int n = trains.size();
+    const int chunk_size = std::max(1, n / (std::max(1, QThread::idealThreadCount()) * 4));
+    QVector<Chunk> chunks;
+    for (int i = 0; i < n; i += chunk_size) {
+        chunks.append({ i, std::min(n, i + chunk_size), {} });
+    }
+
+    ctx.setProgressRange(0, n);
+    std::atomic_int done{ 0 };
+    QtConcurrent::blockingMap(chunks, [this, &trains, &rail, &ctx, &done](Chunk& chunk) {
+        for (int i = chunk.begin; i < chunk.end; i++) {
+            if (ctx.isCanceled())
+                return;
+            countMatrixForTrain(chunk.res, trains.at(i), *rail);
+            ctx.setProgressValue(++done);
+        }
+        });
+    if (ctx.isCanceled())
+        return {};
+
+    raw_matrix_t merged{};
+    for (auto& chunk : chunks) {
+        for (auto& [from, row] : chunk.res) {
+            auto& dst_row = merged[from];
+            for (auto& [to, info] : row) {
+                dst_row[to].merge(std::move(info));
+            }
+        }
+    }
+    RailIntervalMatrix res{};
+    foreach(auto st, rail->stations()) {
+        if (auto itr = merged.find(st.get()); itr != merged.end()) {
+            res.emplace(st, toRailCount(*rail, std::move(itr->second)));
+        }
+    }
     return res;
 }
 
+void IntervalCounter::countMatrixForTrain(raw_matrix_t& res,
+        const std::shared_ptr<Train>& train, const Railway& rail) const
+{
+    if (!_filter.check(train))
+        return;
+    auto adp = train->adapterFor(rail);
+    if (!adp) return;
+
+    // 各发站最后一次经过时的车站，与getIntervalCountSource中的center_station相同
+    std::map<const RailStation*, std::pair<const TrainStation*, bool>> last;
+    for (const auto& line : adp->lines()){
+        for(auto itr=line->stations().begin();
+            itr!=line->stations().end();++itr){
+            const RailStation* st = itr->station;
+            if (checkStation(*st)) {
+                bool is_terminal = line->isTerminalStation(itr);
+                for (const auto& [from, p] : last) {
+                    if (from == st) continue;
+                    IntervalTrainInfo info(train, p.first, &*(itr->trainStation),
+                                           p.second, is_terminal);
+                    if (checkStopBusiness(info)) {
+                        res[from][st].add(std::move(info));
+                    }
+                }
+            }
+            last[st] = std::make_pair(&*(itr->trainStation), line->isStartingStation(itr));
+        }
+    }
+}
+
+IntervalCounter::MatrixKey IntervalCounter::matrixKey(std::shared_ptr<const Railway> rail) const
+{
+    MatrixKey key;
+    key.railway = rail;
+    foreach(auto train, coll.trains()) {
+        if (_filter.check(train))
+            key.trains.emplace_back(train);
+    }
+    key.businessOnly = _businessOnly;
+    key.stopOnly = _stopOnly;
+    key.passengerOnly = _passenterOnly;
+    key.freightOnly = _freightOnly;
+    return key;
+}
+
+bool IntervalCounter::isMatrixKeyCurrent(const MatrixKey& key,
+        std::shared_ptr<const Railway> rail) const
+{
+    // 按控制块比较：已释放的对象即使地址被重用也不会误判为相同
+    auto same = [](const auto& w, const auto& p) {
+        return !w.owner_before(p) && !p.owner_before(w);
+    };
+    if (!rail || !same(key.railway, rail))
+        return false;
+    if (key.businessOnly != _businessOnly || key.stopOnly != _stopOnly ||
+        key.passengerOnly != _passenterOnly || key.freightOnly != _freightOnly)
+        return false;
+    size_t i = 0;
+    foreach(auto train, coll.trains()) {
+        if (!_filter.check(train))
+            continue;
+        if (i >= key.trains.size() || !same(key.trains.at(i++), train))
+            return false;
+    }
+    return i == key.trains.size();
+}
+
 bool IntervalCounter::checkStopBusiness(const IntervalTrainInfo &info) const
 {
     return
@@ -206,6 +373,30 @@ bool IntervalCounter::checkStationName(const StationName& name,
     return false;
 }
 
+std::vector<StationName> IntervalCounter::transSearchNames(
+    const std::vector<QRegularExpression>& std_names, bool useReg) const
+{
+    std::vector<StationName> res;
+    if (!useReg) {
+        res.reserve(std_names.size());
+        for (const auto& n : std_names)
+            res.emplace_back(n.pattern());
+    }
+    return res;
+}
+
+bool IntervalCounter::checkStationName(const StationName& name, const std::vector<StationName>& names,
+    const std::vector<QRegularExpression>& std_names, bool useReg) const
+{
+    if (useReg)
+        return checkStationName(name, std_names, true);
+    for (const auto& n : names) {
+        if (name.equalOrBelongsTo(n))
+            return true;
+    }
+    return false;
+}
+
 std::vector<QRegularExpression> IntervalCounter::transSearchStation(const QString& input, bool useMulti) const
 {
     std::vector<QRegularExpression> res{};
@@ -222,8 +413,26 @@ std::vector<QRegularExpression> IntervalCounter::transSearchStation(const QStrin
 }
 
 bool IntervalCounter::checkStation(const std::shared_ptr<const RailStation> &st) const
+{
+    return checkStation(*st);
+}
+
+bool IntervalCounter::checkStation(const RailStation& st) const
 {
     return
-            (!_passenterOnly || st->passenger) &&
-            (!_freightOnly || st->freight);
+            (!_passenterOnly || st.passenger) &&
+            (!_freightOnly || st.freight);
+}
+
+RailIntervalCount IntervalCounter::toRailCount(const Railway& rail, raw_count_t&& data)
+{
+    RailIntervalCount res{};
+    if (data.empty())
+        return res;
+    foreach(auto st, rail.stations()) {
+        if (auto itr = data.find(st.get()); itr != data.end()) {
+            res.emplace(st, std::move(itr->second));
+        }
+    }
+    return res;
 }
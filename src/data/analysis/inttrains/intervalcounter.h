@@ -4,11 +4,13 @@
 #include <vector>
 #include <QString>
 #include <QRegularExpression>
+#include <data/common/backgroundtask.h>
 
 class StationName;
 class Railway;
 class TrainCollection;
 class RailStation;
+class Train;
 /**
  * @brief The IntervalCounter class
  * 2022.04.14 区间对数统计
@@ -33,6 +35,13 @@ class IntervalCounter
     bool _regexStart = false, _regexEnd = false;
 public:
     IntervalCounter(const TrainCollection& coll, const TrainFilterCore& filter);
+
+    /**
+     * 2026.10  条件与other相同，统计coll中的车次、按filter筛选。
+     * 用于在Diagram::snapshot()的数据上统计。
+     */
+    IntervalCounter(const IntervalCounter& other, const TrainCollection& coll,
+        const TrainFilterCore& filter);
     const auto& filter()const{return _filter;}
     bool businessOnly()const{return _businessOnly;}
     bool stopOnly()const{return _stopOnly;}
@@ -67,6 +76,8 @@ public:
      * 仅用站名判定的版本。需要全局遍历列车时刻表，而不管线路问题。
      * 暂定使用equalOrBelongTo()判定站名，即支持域解析符
      * 2022.04.24：入参改为QString，考虑多车站选择情况
+     * 2026.10：由TrainCollection的车站索引取得发站、到站在各车次中的站序，
+     * 只在这些站之间判断，不再遍历全部时刻表；结果与原来逐站判断的一致。
      */
     IntervalTrainList getIntervalTrains(
             const QString& from,
@@ -79,11 +90,13 @@ public:
      * 与pyETRC不同的是，这里同时返回所有的车次。
      * @param rail  线路
      * @param center  中心站：作为发站或者到站
+     * @param ctx  2026.10  后台任务上下文：按车次报告进度，取消时返回空
      * @return
      */
     RailIntervalCount getIntervalCountSource(
             std::shared_ptr<const Railway> rail,
-            std::shared_ptr<const RailStation> source
+            std::shared_ptr<const RailStation> source,
+            const TaskContext& ctx = {}
             )const;
 
     /**
@@ -95,16 +108,57 @@ public:
      */
     RailIntervalCount getIntervalCountDrain(
             std::shared_ptr<const Railway> rail,
-            std::shared_ptr<const RailStation> drain
+            std::shared_ptr<const RailStation> drain,
+            const TaskContext& ctx = {}
             )const;
 
+    /**
+     * 2026.10  全线OD矩阵：一次遍历各车次在本线的运行线，得到所有发站到所有到站的统计。
+     * 每一行（发站）与以该站调用getIntervalCountSource的结果一致（包括车次顺序）。
+     * 按车次分块并行统计，各块先在本地汇总，再按车次顺序合并。
+     */
+    RailIntervalMatrix getIntervalCountMatrix(
+            std::shared_ptr<const Railway> rail,
+            const TaskContext& ctx = {}
+            )const;
+
+    /**
+     * 2026.10  OD矩阵的缓存键：线路、通过筛选的各车次以及统计条件。
+     * 须在Diagram::snapshot()的数据上使用（见IntervalCounter(other, coll, filter)）：
+     * 快照复用未变化的线路副本、车次副本，而线路、参数变化时换用新的线路副本，
+     * 车次的任何内容（始发终到、类型、客货、时刻表、停站等）变化时换用新的车次副本，
+     * 因此按对象比较即可发现所有影响统计的修改；筛选结果变化时车次表也随之不同。
+     */
+    struct MatrixKey {
+        std::weak_ptr<const Railway> railway;
+        std::vector<std::weak_ptr<const Train>> trains;
+        bool businessOnly = false, stopOnly = false, passengerOnly = false, freightOnly = false;
+    };
+
+    MatrixKey matrixKey(std::shared_ptr<const Railway> rail)const;
+
+    /**
+     * 按当前数据和条件，key是否仍然有效
+     */
+    bool isMatrixKeyCurrent(const MatrixKey& key, std::shared_ptr<const Railway> rail)const;
+
     /**
      * 确定指定站是否要符合办客站/办货站限制
      * （是否要显示出来）
      */
     bool checkStation(const std::shared_ptr<const RailStation>& st)const;
+    bool checkStation(const RailStation& st)const;
 
 private:
+    /**
+     * 2026.10  统计过程中以车站的非拥有指针（AdapterStation::station）为键，
+     * 避免逐站lock()；结束后按线路的车站表换回shared_ptr。
+     */
+    using raw_count_t = std::map<const RailStation*, IntervalCountInfo>;
+    using raw_matrix_t = std::map<const RailStation*, raw_count_t>;
+
+    static RailIntervalCount toRailCount(const Railway& rail, raw_count_t&& data);
+
     /**
      * @brief checkStopBusiness
      * 判定某待生成的事件是否符合营业站/始发终到站的约束。
@@ -113,8 +167,24 @@ private:
 
     bool checkStationStopBusiness(const TrainStation& st, bool isStartEnd);
 
+    /**
+     * 全线OD矩阵中单个车次的部分，结果加入res
+     */
+    void countMatrixForTrain(raw_matrix_t& res, const std::shared_ptr<Train>& train,
+        const Railway& rail)const;
+
     bool checkStationName(const StationName& name, const std::vector<QRegularExpression>& std_names, bool useReg)const;
 
+    /**
+     * 2026.10  不启用正则时，预先将pattern()解释为站名（驻留），逐站判断时只比较编号。
+     * 启用正则时返回空表。
+     */
+    std::vector<StationName> transSearchNames(const std::vector<QRegularExpression>& std_names,
+        bool useReg)const;
+
+    bool checkStationName(const StationName& name, const std::vector<StationName>& names,
+        const std::vector<QRegularExpression>& std_names, bool useReg)const;
+
     /**
      * 2022.05.06：改为正则表达式的列表。
      * 如果不启用正则，就直接按pattern()解释为站名。
@@ -1,4 +1,5 @@
 ﻿#include "intervaltraininfo.h"
+#include <iterator>
 
 
 void IntervalCountInfo::add(IntervalTrainInfo &&data)
@@ -19,6 +20,16 @@ void IntervalCountInfo::add(IntervalTrainInfo &&data)
     _list.emplace_back(std::move(data));
 }
 
+void IntervalCountInfo::merge(IntervalCountInfo&& other)
+{
+    _startCount += other._startCount;
+    _endCount += other._endCount;
+    _startEndCount += other._startEndCount;
+    _list.insert(_list.end(), std::make_move_iterator(other._list.begin()),
+        std::make_move_iterator(other._list.end()));
+    other.clear();
+}
+
 void IntervalCountInfo::clear()
 {
     _startCount=_endCount=_startEndCount=0;
@@ -55,6 +55,11 @@ public:
      */
     void add(IntervalTrainInfo&& data);
 
+    /**
+     * 2026.10  将other的数据接在后面，合并统计
+     */
+    void merge(IntervalCountInfo&& other);
+
     void clear();
 
     const auto& list()const{return _list;}
@@ -68,3 +73,9 @@ public:
 
 using RailIntervalCount=std::map<std::shared_ptr<const RailStation>,
         IntervalCountInfo>;
+
+/**
+ * 2026.10  全线OD矩阵：发站 -> (到站 -> 统计)
+ */
+using RailIntervalMatrix=std::map<std::shared_ptr<const RailStation>,
+        RailIntervalCount>;
@@ -2,18 +2,28 @@
 
 #include <data/diagram/diagram.h>
 
-TrainGapAna::TrainGapAna(Diagram &diagram, const TrainFilterCore &filter):
+TrainGapAna::TrainGapAna(const Diagram &diagram, const TrainFilterCore &filter):
     diagram(diagram), filter(filter)
 {
 
 }
 
 std::map<TrainGapTypePair, int> TrainGapAna::globalMinimal(
-        std::shared_ptr<Railway> rail) const
+        std::shared_ptr<Railway> rail, const TaskContext& ctx) const
+{
+    return globalMinimal(*diagram.stationEventAxisCached(rail), ctx);
+}
+
+std::map<TrainGapTypePair, int> TrainGapAna::globalMinimal(
+        const RailwayStationEventAxis& events, const TaskContext& ctx) const
 {
     std::map<TrainGapTypePair,int> res{};
-    auto events=diagram.stationEventsForRail(rail);
+    ctx.setProgressRange(0, static_cast<int>(events.size()));
+    int cnt = 0;
     for(auto _p=events.begin();_p!=events.end();++_p){
+        if (ctx.isCanceled())
+            return {};
+        ctx.setProgressValue(cnt++);
         const RailStationEventList& lst=_p->second;
         auto gaps=diagram.getTrainGaps(lst, filter, _singleLine);
         TrainGapStatistics stat=diagram.countTrainGaps(gaps, _cutSecs);
@@ -1,8 +1,10 @@
 ﻿#pragma once
 
 #include <data/diagram/traingap.h>
+#include <data/common/backgroundtask.h>
 
 class Railway;
+class RailwayStationEventAxis;
 
 
 class TrainFilterCore;
@@ -19,17 +21,28 @@ class Diagram;
  */
 class TrainGapAna
 {
-    Diagram& diagram;
+    const Diagram& diagram;
     const TrainFilterCore& filter;
     bool _singleLine=false;
     int _cutSecs;
 public:
-    TrainGapAna(Diagram& diagram, const TrainFilterCore& filter);
+    TrainGapAna(const Diagram& diagram, const TrainFilterCore& filter);
 
     void setSingleLine(bool on){_singleLine=on;}
     void setCutSecs(int secs){_cutSecs=secs;}
 
+    /**
+     * 各类间隔的全局最小值。
+     * 2026.10  ctx: 后台任务上下文，按车站报告进度；取消时返回空
+     */
     std::map<TrainGapTypePair,int>
-        globalMinimal(std::shared_ptr<Railway> rail)const;
+        globalMinimal(std::shared_ptr<Railway> rail, const TaskContext& ctx = {})const;
+
+    /**
+     * 2026.10  按给定的车站事件表计算，不读取运行图的事件表缓存。
+     * 后台任务使用：事件表在主线程由快照生成后交给任务。
+     */
+    std::map<TrainGapTypePair,int>
+        globalMinimal(const RailwayStationEventAxis& events, const TaskContext& ctx = {})const;
 };
 
@@ -3,9 +3,12 @@
 #include <data/train/train.h>
 #include <data/rail/ruler.h>
 #include <data/rail/rulernode.h>
-#include <util/utilfunc.h>
+#include <data/common/timeutil.h>
 #include <data/rail/forbid.h>
+#include <data/diagram/trainadapter.h>
+#include <data/diagram/trainline.h>
 #include <exception>
+#include <algorithm>
 
 
 class BackoffExeed : public std::exception
@@ -20,9 +23,104 @@ GreedyPainter::GreedyPainter(Diagram& diagram) :
 
 }
 
+GreedyPainter::GreedyPainter(const GreedyPainter& other) :
+	diagram(other.diagram), _railway(other._railway), _ruler(other._ruler),
+	_anchor(other._anchor), _start(other._start), _end(other._end),
+	_localStarting(other._localStarting), _localTerminal(other._localTerminal),
+	_anchorAsArrive(other._anchorAsArrive), _dir(other._dir), _anchorTime(other._anchorTime),
+	_settledStops(other._settledStops), _constraints(other._constraints),
+	_usedForbids(other._usedForbids), _maxBackoffTimes(other._maxBackoffTimes)
+{
+
+}
+
 bool GreedyPainter::paint(const TrainName& trainName)
 {
-	_railAxis = diagram.stationEventAxisForRail(_railway);
+	return paintWithAxis(trainName, diagram.stationEventAxisCached(_railway));
+}
+
+std::vector<GreedyPainter::BatchResult>
+	GreedyPainter::paintBatch(std::shared_ptr<RailwayStationEventAxis> axis,
+		const std::vector<BatchRequest>& requests, const TaskContext& ctx,
+		const std::atomic_bool* stop)
+{
+	auto stopped = [&ctx, stop]() {
+		return ctx.isCanceled() || (stop && stop->load());
+	};
+
+	// 单次铺画的设置，结束后恢复
+	auto anchor = _anchor, start = _start, end = _end;
+	auto dir = _dir;
+	auto anchorTime = _anchorTime;
+	bool anchorAsArrive = _anchorAsArrive, localStarting = _localStarting, localTerminal = _localTerminal;
+	auto settledStops = _settledStops;
+	auto ruler = _ruler;
+
+	std::vector<BatchResult> res;
+	res.reserve(requests.size());
+	ctx.setProgressRange(0, static_cast<int>(requests.size()));
+	for (const auto& req : requests) {
+		if (stopped())
+			break;
+		ctx.setProgressValue(static_cast<int>(res.size()));
+		_anchor = req.anchor;
+		_start = req.start;
+		_end = req.end;
+		_dir = req.dir;
+		_anchorAsArrive = req.anchorAsArrive;
+		_localStarting = req.localStarting;
+		_localTerminal = req.localTerminal;
+		_settledStops = req.settledStops;
+		_ruler = req.ruler ? req.ruler : ruler;
+
+		BatchResult& r = res.emplace_back();
+		const int step = std::max(req.windowStep, 1);
+		for (int delay = 0; delay <= req.windowSecs && !stopped(); delay += step) {
+			_anchorTime = req.anchorTime.addSecs(delay);
+			r.attempts++;
+			r.success = paintWithAxis(req.trainName, axis);
+			if (r.success)
+				break;
+		}
+		if (!r.success && stopped()) {
+			// 重试中途停止，结果不完整
+			res.pop_back();
+			break;
+		}
+		r.train = _train;
+		r.anchorTime = _anchorTime;
+		r.backoffCount = backoffCount;
+		for (const auto& log : _logs) {
+			r.logs.append(log->toString());
+		}
+
+		if (r.success && _train) {
+			// 加入事件表，作为后续车次的约束
+			auto adp = _train->bindToRailway(_railway, diagram.config());
+			if (adp) {
+				for (const auto& line : adp->lines()) {
+					if (!line->isNull())
+						axis->insertLine(line);
+				}
+			}
+		}
+	}
+	ctx.setProgressValue(static_cast<int>(res.size()));
+
+	_anchor = anchor; _start = start; _end = end;
+	_dir = dir;
+	_anchorTime = anchorTime;
+	_anchorAsArrive = anchorAsArrive; _localStarting = localStarting; _localTerminal = localTerminal;
+	_settledStops = std::move(settledStops);
+	_ruler = ruler;
+	_railAxis.reset();
+	return res;
+}
+
+bool GreedyPainter::paintWithAxis(const TrainName& trainName,
+	std::shared_ptr<const RailwayStationEventAxis> axis)
+{
+	_railAxis = std::move(axis);
 	_train = std::make_shared<Train>(trainName);
 	_logs.clear();
 	backoffCount = 0;
@@ -162,8 +260,8 @@ bool GreedyPainter::calForward(std::shared_ptr<const RailInterval> railint, cons
 
 	auto st_from = node->railInterval().fromStation();
 	auto st_to = node->railInterval().toStation();
-	const auto& ax_from = _railAxis.at(st_from);
-	const auto& ax_to = _railAxis.at(st_to);
+	const auto& ax_from = _railAxis->at(st_from);
+	const auto& ax_to = _railAxis->at(st_to);
 
 	auto itr = _settledStops.find(st_to);
 	bool next_stop = ((itr != _settledStops.end()) || (st_to == _end && _localTerminal));
@@ -289,7 +387,7 @@ bool GreedyPainter::calForward(std::shared_ptr<const RailInterval> railint, cons
 
 		// 区间运行冲突
 
-		auto rep = _railAxis.intervalConflicted(st_from, st_to, _dir, ev_start.time, int_secs, _constraints.isSingleLine(), false);
+		auto rep = _railAxis->intervalConflicted(st_from, st_to, _dir, ev_start.time, int_secs, _constraints.isSingleLine(), false);
 		if (rep.type != IntervalConflictReport::NoConflict) {
 			// 存在冲突
 			if (!stop && st_from != _anchor) {
@@ -434,8 +532,8 @@ bool GreedyPainter::calBackward(std::shared_ptr<const RailInterval> railint, con
 
 	auto st_from = node->railInterval().toStation();
 	auto st_to = node->railInterval().fromStation();
-	const auto& ax_from = _railAxis.at(st_from);
-	const auto& ax_to = _railAxis.at(st_to);
+	const auto& ax_from = _railAxis->at(st_from);
+	const auto& ax_to = _railAxis->at(st_to);
 
 	auto itr = _settledStops.find(st_to);
 	bool next_stop = ((itr != _settledStops.end()) || (st_to == _start && _localStarting));
@@ -562,7 +660,7 @@ bool GreedyPainter::calBackward(std::shared_ptr<const RailInterval> railint, con
 
 		// 区间运行冲突  注意区间的判定按照正向运行的逻辑传参
 
-		auto rep = _railAxis.intervalConflicted(st_to, st_from, _dir, tm_dep, int_secs, 
+		auto rep = _railAxis->intervalConflicted(st_to, st_from, _dir, tm_dep, int_secs, 
 			_constraints.isSingleLine(), true);
 		if (rep.type != IntervalConflictReport::NoConflict) {
 			// 存在冲突
@@ -1,8 +1,13 @@
 ﻿#pragma once
 #include <memory>
+#include <vector>
+#include <atomic>
+#include <QStringList>
 #include "gapconstraints.h"
 #include "railwaystationeventaxis.h"
 #include "calculationlog.h"
+#include "data/train/trainname.h"
+#include "data/common/backgroundtask.h"
 
 namespace _greedypaint_detail {
 	class _RecurseLogger;
@@ -39,7 +44,7 @@ class GreedyPainter
 	 */
 	std::shared_ptr<Train> _train;
 	GapConstraints _constraints;
-	RailwayStationEventAxis _railAxis;
+	std::shared_ptr<const RailwayStationEventAxis> _railAxis;
 
 	std::vector<std::unique_ptr<CalculationLogAbstract>> _logs;
 	std::vector<std::shared_ptr<Forbid>> _usedForbids;
@@ -48,7 +53,45 @@ class GreedyPainter
 	int backoffCount = 0;
 
 public:
+	/**
+	 * 2026.10  批量铺画中的一个铺画请求。
+	 * 各项含义与单次铺画的同名设置相同；ruler为空时使用当前设置的标尺。
+	 * 若在anchorTime铺画失败，在[anchorTime, anchorTime+windowSecs]内
+	 * 每隔windowStep秒推后锚点时刻重试，直到成功或超出时间窗。
+	 */
+	struct BatchRequest {
+		TrainName trainName;
+		std::shared_ptr<const RailStation> anchor, start, end;
+		Direction dir = Direction::Down;
+		QTime anchorTime;
+		bool anchorAsArrive = true;
+		bool localStarting = false, localTerminal = false;
+		std::map<std::shared_ptr<const RailStation>, int> settledStops;
+		std::shared_ptr<Ruler> ruler;
+		int windowSecs = 0;
+		int windowStep = 60;
+	};
+
+	/**
+	 * 2026.10  批量铺画中一个请求的结果
+	 */
+	struct BatchResult {
+		std::shared_ptr<Train> train;   // 最后一次尝试的铺画结果（成功时已绑定到本线）
+		bool success = false;
+		QTime anchorTime;       // 最后一次尝试的锚点时刻
+		int attempts = 0;       // 尝试次数（时间窗内）
+		int backoffCount = 0;   // 最后一次尝试的回退次数
+		QStringList logs;       // 最后一次尝试的运行记录
+	};
+
 	GreedyPainter(Diagram& diagram);
+
+	/**
+	 * 2026.10  复制铺画设置（线路、标尺、锚点、约束条件等），不复制铺画结果和运行记录。
+	 * 用于后台铺画：任务使用副本，界面可以继续使用原对象。
+	 */
+	GreedyPainter(const GreedyPainter& other);
+	GreedyPainter& operator=(const GreedyPainter&) = delete;
 	auto railway() { return _railway; }
 	auto ruler() { return _ruler; }
 	auto anchor() { return _anchor; }
@@ -86,7 +129,27 @@ public:
 	 */
 	bool paint(const TrainName& trainName);
 
+	/**
+	 * @brief paintBatch  2026.10  批量铺画
+	 * 按顺序逐个铺画，使用同一个车站事件表axis：
+	 * 每个铺画成功的车次绑定到本线后，其事件增量地加入axis，作为后续车次的约束。
+	 * axis为本线现有事件表的副本，由调用方在主线程生成（事件表缓存只能在主线程访问）。
+	 * 线路、间隔约束、最大回退次数使用当前设置；单次铺画的其他设置在结束后恢复。
+	 * 铺画结果不加入运行图，由调用方处理。运行图在此期间不得被修改。
+	 * stop置位时停止，返回已完成的车次（正在铺画而未成功的车次不计入）。
+	 * 注意经ctx取消时，后台任务的结果被丢弃，要取回部分结果应使用stop。
+	 */
+	std::vector<BatchResult> paintBatch(std::shared_ptr<RailwayStationEventAxis> axis,
+		const std::vector<BatchRequest>& requests, const TaskContext& ctx = {},
+		const std::atomic_bool* stop = nullptr);
+
 private:
+	/**
+	 * paint的实现：以axis为已有车站事件表铺画
+	 */
+	bool paintWithAxis(const TrainName& trainName,
+		std::shared_ptr<const RailwayStationEventAxis> axis);
+
 	void addLog(std::unique_ptr<CalculationLogAbstract> log);
 
 	/**
@@ -1,5 +1,7 @@
 ﻿#include "railwaystationeventaxis.h"
-#include <util/utilfunc.h>
+#include <data/common/timeutil.h>
+#include <data/diagram/trainline.h>
+#include <data/rail/railstation.h>
 #include <QDebug>
 
 IntervalConflictReport RailwayStationEventAxis::intervalConflicted(std::shared_ptr<RailStation> from, 
@@ -152,3 +154,29 @@ RailwayStationEventAxis::isConflictedWith(
     }
     return {};
 }
+
+void RailwayStationEventAxis::insertLine(const std::shared_ptr<const TrainLine>& line)
+{
+    if (line->isNull())
+        return;
+    double y1 = line->firstRailStation()->y_coeff.value(),
+        y2 = line->lastRailStation()->y_coeff.value();
+    double ymin = std::min(y1, y2), ymax = std::max(y1, y2);
+    for (auto& [st, axis] : *this) {
+        // 运行线范围以外的车站，事件必定为空
+        if (!st->y_coeff.has_value() || st->y_coeff.value() < ymin ||
+            st->y_coeff.value() > ymax)
+            continue;
+        const auto& lst = line->stationEventFromRail(st);
+        for (const auto& ev : lst) {
+            axis.insertEvent(ev);
+        }
+    }
+}
+
+void RailwayStationEventAxis::removeLine(const std::shared_ptr<const TrainLine>& line)
+{
+    for (auto& p : *this) {
+        p.second.removeLineEvents(line);
+    }
+}
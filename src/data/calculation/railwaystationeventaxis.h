@@ -38,6 +38,17 @@ public:
             std::shared_ptr<RailStation> from, std::shared_ptr<RailStation> to, Direction dir,
             const QTime& tm_start, int secs, bool singleLine, bool backward)const;
 
+    /**
+     * 增量维护：将运行线在本线各站的事件插入到对应的事件表中。
+     * 要求运行线属于本线路，且已经铺画（车站y坐标已知）。
+     */
+    void insertLine(const std::shared_ptr<const TrainLine>& line);
+
+    /**
+     * 增量维护：从各站的事件表中删除指定运行线的事件。
+     */
+    void removeLine(const std::shared_ptr<const TrainLine>& line);
+
 private:
 
     /**
@@ -1,6 +1,6 @@
 ﻿#include "stationeventaxis.h"
 #include "gapconstraints.h"
-#include <util/utilfunc.h>
+#include <data/common/timeutil.h>
 #include <QDebug>
 
 void StationEventAxis::sortEvents()
@@ -57,6 +57,40 @@ void StationEventAxis::insertEvent(std::shared_ptr<RailStationEvent> ev)
     }
 }
 
+int StationEventAxis::removeLineEvents(const std::shared_ptr<const TrainLine>& line)
+{
+    std::shared_ptr<RailStationEvent> evs[2];
+    if (auto itr = _preEvents.find(line); itr != _preEvents.end()) {
+        evs[0] = itr->second;
+        _preEvents.erase(itr);
+    }
+    if (auto itr = _postEvents.find(line); itr != _postEvents.end()) {
+        evs[1] = itr->second;
+        _postEvents.erase(itr);
+    }
+    if (evs[0] == evs[1]) {
+        // 通过事件同时在两个表里面
+        evs[1].reset();
+    }
+
+    int cnt = 0;
+    for (const auto& ev : evs) {
+        if (!ev) continue;
+        auto [first, last] = std::equal_range(begin(), end(), ev,
+            RailStationEvent::PtrTimeComparator());
+        auto itr = std::find(first, last, ev);
+        if (itr != last) {
+            erase(itr);
+            cnt++;
+        }
+        else {
+            qDebug() << "StationEventAxis::removeLineEvents: WARNING: event not found in axis "
+                << ev->time << Qt::endl;
+        }
+    }
+    return cnt;
+}
+
 std::shared_ptr<RailStationEvent> StationEventAxis::conflictEvent(
         const RailStationEventBase& ev,
         const GapConstraints &constraint) const
@@ -45,6 +45,13 @@ public:
      */
     void insertEvent(std::shared_ptr<RailStationEvent> ev);
 
+    /**
+     * 删除指定运行线的所有事件。通过_preEvents, _postEvents查找，
+     * 再按时刻二分定位删除，不做全表扫描。
+     * 返回删除的事件数。
+     */
+    int removeLineEvents(const std::shared_ptr<const TrainLine>& line);
+
     /**
      * @brief conflictEvent 找出与指定事件冲突的事件。
      * 如果没有冲突事件，即当前排图是许可的，则返回空。
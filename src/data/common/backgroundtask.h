@@ -0,0 +1,80 @@
+﻿#pragma once
+
+#include <QFuture>
+#include <QFutureInterface>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QString>
+#include <functional>
+
+/**
+ * 2026.10  后台任务的上下文：供计算函数报告进度、查询是否已取消。
+ * 默认构造的对象不关联任何任务（同步调用），此时不报告进度，也不会被取消，
+ * 因此耗时的数据层函数可以统一以 const TaskContext& ctx = {} 作为最后一个参数。
+ * 各方法都是线程安全的，可在并行计算的各线程中调用。
+ */
+class TaskContext
+{
+    QFutureInterfaceBase* const _fi = nullptr;
+
+public:
+    TaskContext() = default;
+    explicit TaskContext(QFutureInterfaceBase& fi) : _fi(&fi) {}
+
+    inline bool isCanceled()const { return _fi && _fi->isCanceled(); }
+
+    inline void setProgressRange(int minimum, int maximum)const {
+        if (_fi) _fi->setProgressRange(minimum, maximum);
+    }
+
+    inline void setProgressValue(int value)const {
+        if (_fi) _fi->setProgressValue(value);
+    }
+
+    inline void setProgressText(const QString& text)const {
+        if (_fi) _fi->setProgressValueAndText(_fi->progressValue(), text);
+    }
+};
+
+/**
+ * 2026.10  后台任务框架
+ * 分析计算交由全局线程池执行：func(const TaskContext&)在工作线程中运行，
+ * 其返回值作为QFuture的结果；界面线程以QFutureWatcher接收进度和结果
+ * （参见qeutil::showTaskProgress）。取消后func的返回值被丢弃，QFuture无结果。
+ *
+ * func所读的数据在任务期间不得被修改：调用方或者传入数据的副本（按值捕获），
+ * 或者在任务期间阻止对数据的修改。
+ */
+namespace qetask {
+
+    template <typename T>
+    class TaskRunnable : public QRunnable
+    {
+        QFutureInterface<T> _fi;
+        std::function<T(const TaskContext&)> _func;
+    public:
+        TaskRunnable(const QFutureInterface<T>& fi, std::function<T(const TaskContext&)> func) :
+            _fi(fi), _func(std::move(func)) {}
+
+        void run()override
+        {
+            if (!_fi.isCanceled()) {
+                TaskContext ctx(_fi);
+                T res = _func(ctx);
+                if (!_fi.isCanceled())
+                    _fi.reportResult(std::move(res));
+            }
+            _fi.reportFinished();
+        }
+    };
+
+    template <typename T>
+    QFuture<T> run(std::function<T(const TaskContext&)> func)
+    {
+        QFutureInterface<T> fi;
+        fi.reportStarted();
+        QFuture<T> future = fi.future();
+        QThreadPool::globalInstance()->start(new TaskRunnable<T>(fi, std::move(func)));
+        return future;
+    }
+}
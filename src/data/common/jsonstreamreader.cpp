@@ -0,0 +1,227 @@
+﻿#include "jsonstreamreader.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QDebug>
+#include <QFile>
+#include <cstring>
+
+JsonStreamReader::JsonStreamReader(const char* data, qint64 size):
+    _begin(data), _cur(data), _end(data + size)
+{
+    // UTF-8 BOM
+    if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+        _cur += 3;
+}
+
+JsonStreamReader::JsonStreamReader(const QByteArray& data):
+    JsonStreamReader(data.constData(), data.size())
+{
+}
+
+bool JsonStreamReader::enterObject()
+{
+    skipSpaces();
+    if (_cur < _end && *_cur == '{') {
+        ++_cur;
+        return true;
+    }
+    setError();
+    return false;
+}
+
+bool JsonStreamReader::enterArray()
+{
+    skipSpaces();
+    if (_cur < _end && *_cur == '[') {
+        ++_cur;
+        return true;
+    }
+    setError();
+    return false;
+}
+
+bool JsonStreamReader::nextMember(QString& key)
+{
+    skipSpaces();
+    if (_cur >= _end) {
+        setError();
+        return false;
+    }
+    if (*_cur == '}') {
+        ++_cur;
+        return false;
+    }
+    if (*_cur == ',') {
+        ++_cur;
+        skipSpaces();
+    }
+    const char* start = _cur;
+    if (!skipString()) {
+        setError();
+        return false;
+    }
+    if (std::memchr(start, '\\', _cur - start)) {
+        // 含转义的键很少见，交给Qt处理
+        QByteArray wrapped = '[' + QByteArray(start, _cur - start) + ']';
+        key = parseValue(wrapped).toArray().at(0).toString();
+    }
+    else {
+        key = QString::fromUtf8(start + 1, static_cast<int>(_cur - start - 2));
+    }
+    skipSpaces();
+    if (_cur >= _end || *_cur != ':') {
+        setError();
+        return false;
+    }
+    ++_cur;
+    return true;
+}
+
+bool JsonStreamReader::nextElement()
+{
+    skipSpaces();
+    if (_cur >= _end) {
+        setError();
+        return false;
+    }
+    if (*_cur == ']') {
+        ++_cur;
+        return false;
+    }
+    if (*_cur == ',')
+        ++_cur;
+    return true;
+}
+
+QByteArray JsonStreamReader::skipValue()
+{
+    skipSpaces();
+    const char* start = _cur;
+    if (_cur >= _end) {
+        setError();
+        return {};
+    }
+    switch (*_cur) {
+    case '"': if (!skipString()) setError(); break;
+    case '{':
+    case '[': if (!skipCompound()) setError(); break;
+    default: skipScalar(); break;
+    }
+    if (_error)
+        return {};
+    return QByteArray::fromRawData(start, static_cast<int>(_cur - start));
+}
+
+QJsonValue JsonStreamReader::readValue()
+{
+    QByteArray raw = skipValue();
+    if (raw.isEmpty())
+        return QJsonValue(QJsonValue::Undefined);
+    if (raw.at(0) == '{' || raw.at(0) == '[')
+        return parseValue(raw);
+    // Qt5的QJsonDocument只接受对象或数组
+    QByteArray wrapped = '[' + QByteArray(raw.constData(), raw.size()) + ']';
+    return parseValue(wrapped).toArray().at(0);
+}
+
+QJsonValue JsonStreamReader::parseValue(const QByteArray& raw)
+{
+    QJsonParseError err;
+    QJsonDocument doc = QJsonDocument::fromJson(raw, &err);
+    if (err.error != QJsonParseError::NoError) {
+        qDebug() << "JsonStreamReader::parseValue: WARNING: " << err.errorString()
+            << " at " << err.offset;
+        return QJsonValue(QJsonValue::Undefined);
+    }
+    if (doc.isObject())
+        return doc.object();
+    return doc.array();
+}
+
+QJsonObject JsonStreamReader::readObjectExcept(const QByteArray& data, const QString& streamKey,
+    QByteArray& streamValue, bool* ok)
+{
+    QJsonObject res;
+    streamValue.clear();
+    JsonStreamReader reader(data);
+    QString key;
+    if (reader.enterObject()) {
+        while (reader.nextMember(key)) {
+            if (key == streamKey)
+                streamValue = reader.skipValue();
+            else
+                res.insert(key, reader.readValue());
+        }
+    }
+    if (ok)
+        *ok = !reader.hasError();
+    return res;
+}
+
+QByteArray JsonStreamReader::mapFile(QFile& file)
+{
+    qint64 size = file.size();
+    if (size > 0) {
+        if (uchar* p = file.map(0, size)) {
+            return QByteArray::fromRawData(reinterpret_cast<const char*>(p),
+                static_cast<int>(size));
+        }
+    }
+    return file.readAll();
+}
+
+void JsonStreamReader::skipSpaces()
+{
+    while (_cur < _end && (*_cur == ' ' || *_cur == '\n' || *_cur == '\r' || *_cur == '\t'))
+        ++_cur;
+}
+
+bool JsonStreamReader::skipString()
+{
+    if (_cur >= _end || *_cur != '"')
+        return false;
+    for (++_cur; _cur < _end; ++_cur) {
+        if (*_cur == '\\') {
+            ++_cur;    // 跳过被转义的字符（包括\"）
+        }
+        else if (*_cur == '"') {
+            ++_cur;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JsonStreamReader::skipCompound()
+{
+    int depth = 0;
+    while (_cur < _end) {
+        switch (*_cur) {
+        case '"':
+            if (!skipString())
+                return false;
+            continue;
+        case '{':
+        case '[':
+            ++depth; break;
+        case '}':
+        case ']':
+            if (--depth == 0) {
+                ++_cur;
+                return true;
+            }
+            break;
+        default: break;
+        }
+        ++_cur;
+    }
+    return false;
+}
+
+void JsonStreamReader::skipScalar()
+{
+    while (_cur < _end && !std::strchr(",}] \t\r\n", *_cur))
+        ++_cur;
+}
@@ -0,0 +1,86 @@
+﻿#pragma once
+
+#include <QByteArray>
+#include <QJsonValue>
+#include <QString>
+#include <QJsonObject>
+
+class QFile;
+
+/**
+ * 2026.10  轻量的JSON流式扫描器
+ * 直接在原始文本（通常是映射到内存的文件）上按词法结构前进，不构建整体的DOM。
+ * 只识别值的边界：对于不关心或需要单独处理的值，可跳过或取得其原始文本，
+ * 再交给QJsonDocument单独解析（例如逐个车次解析），
+ * 从而避免整个文件的QJsonDocument与原文本、数据对象三份数据同时存在。
+ *
+ * 不做完整的语法检查，只保证结构正确的JSON能被正确划分；
+ * 遇到明显的结构错误时置hasError()，此后所有操作均返回失败。
+ * 所给数据在扫描器及其返回的原始文本的生命期内必须有效。
+ */
+class JsonStreamReader
+{
+    const char* _begin, * _cur, * _end;
+    bool _error = false;
+public:
+    JsonStreamReader(const char* data, qint64 size);
+    explicit JsonStreamReader(const QByteArray& data);
+
+    inline bool hasError()const { return _error; }
+    inline bool atEnd()const { return _cur >= _end; }
+    inline qint64 offset()const { return _cur - _begin; }
+
+    /**
+     * 期望下一个值为对象/数组，并进入之。否则置错误标志，返回false
+     */
+    bool enterObject();
+    bool enterArray();
+
+    /**
+     * 在对象内：读取下一个成员的键，并定位到其值之前。
+     * 对象结束（已越过'}'）或出错时返回false。
+     */
+    bool nextMember(QString& key);
+
+    /**
+     * 在数组内：定位到下一个元素之前。
+     * 数组结束（已越过']'）或出错时返回false。
+     */
+    bool nextElement();
+
+    /**
+     * 跳过当前的一个值，返回其原始文本（不复制数据，依赖原数据的生命期）
+     */
+    QByteArray skipValue();
+
+    /**
+     * 解析当前的一个值。对象、数组直接解析原文；标量值包装后解析。
+     */
+    QJsonValue readValue();
+
+    /**
+     * 将一段完整的JSON文本（对象或数组）解析为QJsonValue；出错返回Undefined
+     */
+    static QJsonValue parseValue(const QByteArray& raw);
+
+    /**
+     * 读取顶层对象：除streamKey以外的成员正常解析到返回的对象中，
+     * streamKey对应的值不解析，将其原文写入streamValue，交由调用方逐个元素处理。
+     * ok: 是否为结构正确的JSON对象
+     */
+    static QJsonObject readObjectExcept(const QByteArray& data, const QString& streamKey,
+        QByteArray& streamValue, bool* ok = nullptr);
+
+    /**
+     * 尽量将已打开的文件整体映射到内存，返回不复制数据的QByteArray（生命期同映射，即同file）；
+     * 映射失败时退回到readAll()。
+     */
+    static QByteArray mapFile(QFile& file);
+
+private:
+    void skipSpaces();
+    bool skipString();
+    bool skipCompound();
+    void skipScalar();
+    inline void setError() { _error = true; _cur = _end; }
+};
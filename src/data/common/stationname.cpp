@@ -1,30 +1,161 @@
 ﻿#include "stationname.h"
 #include <QtCore>
+#include <QReadWriteLock>
+
+/**
+ * 站名部分（不含场名）的驻留条目
+ */
+struct StationName::InternedPart {
+    QString station;
+    quint32 id;
+};
+
+/**
+ * 站名驻留表。编号0保留给空字符串、空站名。
+ * 表中只保存弱引用：条目由引用它的StationName持有，最后一个引用释放时从表中删除。
+ * 编号单调递增，不重复使用，因此已释放站名的编号不会与其他站名混淆。
+ */
+class StationName::Table {
+    using part_t = InternedPart;
+    using name_t = Interned;
+
+    QReadWriteLock _lock;
+    QHash<QString, std::weak_ptr<const part_t>> _parts;
+    QHash<QPair<QString, QString>, std::weak_ptr<const name_t>> _names;
+    quint32 _nextPartId = 1, _nextNameId = 1;
+
+    /**
+     * 在表中查找未释放的条目；须持有锁
+     */
+    template <typename Map, typename Key>
+    static auto findAlive(const Map& map, const Key& key)
+    {
+        auto itr = map.constFind(key);
+        return itr == map.constEnd() ? decltype(itr.value().lock()){} : itr.value().lock();
+    }
+
+    /**
+     * 条目释放时调用：若表中仍是已释放的条目（未被同名的新条目取代），则删除
+     */
+    template <typename Map, typename Key>
+    void release(Map& map, const Key& key)
+    {
+        QWriteLocker locker(&_lock);
+        auto itr = map.find(key);
+        if (itr != map.end() && itr.value().expired())
+            map.erase(itr);
+    }
+
+public:
+    std::shared_ptr<const part_t> part(const QString& station) {
+        if (station.isEmpty())
+            return nullptr;
+        {
+            QReadLocker locker(&_lock);
+            if (auto p = findAlive(_parts, station))
+                return p;
+        }
+        QWriteLocker locker(&_lock);
+        if (auto p = findAlive(_parts, station))
+            return p;
+        std::shared_ptr<const part_t> p(new part_t{ station, _nextPartId++ },
+            [this](const part_t* t) {
+                release(_parts, t->station);
+                delete t;
+            });
+        _parts.insert(station, p);
+        return p;
+    }
+
+    std::shared_ptr<const name_t> name(const QString& station, const QString& field) {
+        if (station.isEmpty() && field.isEmpty())
+            return nullptr;
+        const auto key = qMakePair(station, field);
+        {
+            QReadLocker locker(&_lock);
+            if (auto p = findAlive(_names, key))
+                return p;
+        }
+        // 站名部分的条目须在加写锁之前取得：其释放也要加锁
+        auto stationPart = part(station);
+        QWriteLocker locker(&_lock);
+        if (auto p = findAlive(_names, key))
+            return p;
+        quint32 stationId = stationPart ? stationPart->id : 0;
+        std::shared_ptr<const name_t> p(
+            new name_t{ station, field, stationId, _nextNameId++, std::move(stationPart) },
+            [this](const name_t* t) {
+                release(_names, qMakePair(t->station, t->field));
+                delete t;   // 在锁外释放站名部分
+            });
+        _names.insert(key, p);
+        return p;
+    }
+
+    int nameCount() {
+        QReadLocker locker(&_lock);
+        int n = 1;
+        for (auto p = _names.cbegin(); p != _names.cend(); ++p) {
+            if (!p.value().expired())
+                n++;
+        }
+        return n;
+    }
+};
+
+StationName::Table& StationName::table()
+{
+    // 不析构：静态的StationName可能在其后才释放
+    static auto* t = new Table;
+    return *t;
+}
+
+const QString& StationName::emptyString()
+{
+    static const QString s;
+    return s;
+}
 
 const StationName& StationName::nullName=StationName::fromSingleLiteral("");
 
-StationName::StationName(const QString &station, const QString &field):
-    _station(station),_field(field)
+StationName::StationName(const QString &station, const QString &field)
+{
+    intern(station, field);
+}
+
+void StationName::setStation(const QString& s)
+{
+    intern(s, field());
+}
+
+void StationName::setField(const QString& s)
 {
+    intern(station(), s);
+}
+
+int StationName::internedCount()
+{
+    return table().nameCount();
+}
 
+void StationName::intern(const QString& station, const QString& field)
+{
+    _d = table().name(station, field);
 }
 
-StationName::StationName(const QString& singleLiteral):
-    _station(),_field()
+StationName::StationName(const QString& singleLiteral)
 {
     auto t = singleLiteral.split("::");
     if (t.isEmpty());
     else if (t.length() == 1) {
-        _station = singleLiteral;
+        intern(singleLiteral, {});
     }
     else if (t.length() == 2) {
-        _station = t.at(0);
-        _field = t.at(1);
+        intern(t.at(0), t.at(1));
     }
     else {
         qDebug() << "Warning: invalid station name literal: " << singleLiteral << Qt::endl;
-        _station = t.at(0);
-        _field = t.at(1);
+        intern(t.at(0), t.at(1));
     }
 }
 
@@ -35,37 +166,32 @@ StationName StationName::fromSingleLiteral(const QString &s)
 
 QString StationName::toSingleLiteral() const
 {
-    if(_field.isEmpty()){
-        return _station;
+    if(field().isEmpty()){
+        return station();
     }else{
-        return _station+"::"+_field;
+        return station()+"::"+field();
     }
 }
 
 QString StationName::toDisplayLiteral() const
 {
-    if(_field.isEmpty()){
-        return _station;
+    if(field().isEmpty()){
+        return station();
     }else{
-        return _station+"*"+_field;
+        return station()+"*"+field();
     }
 }
 
-bool StationName::operator==(const StationName &name) const
-{
-    return _station==name._station && _field==name._field;
-}
-
 bool StationName::operator<(const StationName& name) const
 {
-    if (_station == name._station)
-        return _field < name._field;
-    return _station < name._station;
+    if (station() == name.station())
+        return field() < name.field();
+    return station() < name.station();
 }
 
 bool StationName::operator>(const StationName& name) const
 {
-    if (_station == name._station)
-        return _field > name._field;
-    return _station > name._station;
+    if (station() == name.station())
+        return field() > name.field();
+    return station() > name.station();
 }
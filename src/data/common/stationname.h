@@ -6,14 +6,33 @@
 #include <QHash>
 #include <QDebug>
 #include <stdint.h>
+#include <memory>
 
 /**
  * QETRC新增类
  * 对站名的封装，主要是为了解决域解析符问题
+ * 2026.10  站名驻留：每个不同的站名（站名+场名）在构造时映射到全局唯一的32位编号，
+ * 相等判断、散列均只用编号；字符串数据也由驻留表共享。
+ * 编号只在本进程内有效，不写入文件。
+ * 驻留表的条目由引用计数管理：最后一个引用它的StationName析构后即从表中删除，
+ * 因此搜索框输入等临时站名不会常驻。编号不重复使用，同名的站名再次出现时取得新编号。
  */
 class StationName
 {
-    QString _station, _field;
+    /**
+     * 驻留表中的条目。站名部分另有编号（stationId），供按站名查找各场
+     */
+    struct InternedPart;
+    struct Interned {
+        QString station, field;
+        quint32 stationId, id;
+        std::shared_ptr<const InternedPart> stationPart;    // 持有站名部分的条目
+    };
+
+    class Table;
+    std::shared_ptr<const Interned> _d;     // 空站名为空指针
+    static Table& table();
+    static const QString& emptyString();
 
     /**
      * 2021.08.15：这个双参数的构造函数似乎没用过
@@ -29,15 +48,29 @@ public:
     StationName(const QString& singleLiteral);
     static const StationName& nullName;
 
+    /**
+     * 2026.10  移动后原对象为空站名
+     */
     StationName(const StationName&)=default;
-    StationName(StationName&&)=default;
+    StationName(StationName&& another)noexcept = default;
     StationName& operator=(const StationName&)=default;
-    StationName& operator=(StationName&&)=default;
+    StationName& operator=(StationName&& another)noexcept = default;
 
-    inline const QString& station()const{return _station;}
-    inline const QString& field()const{return _field;}
-    inline void setStation(const QString& s){_station=s;}
-    inline void setField(const QString& s){_field=s;}
+    inline const QString& station()const{return _d ? _d->station : emptyString();}
+    inline const QString& field()const{return _d ? _d->field : emptyString();}
+    void setStation(const QString& s);
+    void setField(const QString& s);
+
+    /**
+     * 2026.10  驻留编号。相等的站名编号相同，反之亦然
+     */
+    inline quint32 id()const { return _d ? _d->id : 0; }
+    inline quint32 stationId()const { return _d ? _d->stationId : 0; }
+
+    /**
+     * 驻留表中现存的不同站名的数量（含空站名），用于统计
+     */
+    static int internedCount();
 
     /**
      * 与旧有的Python实现类似，从域解析符::形式解出来
@@ -53,7 +86,9 @@ public:
     /**
      * 这是基本的实现，仅考虑是否完全一样
      */
-    bool operator==(const StationName& name)const;
+    inline bool operator==(const StationName& name)const {
+        return _d == name._d;
+    }
 
     inline bool operator!=(const StationName& name)const {
         return !operator==(name);
@@ -67,11 +102,11 @@ public:
      * 是否为仅有站名没有场名的类型
      */
     inline bool isBare()const{
-        return _field.isEmpty();
+        return field().isEmpty();
     }
 
     inline bool empty()const {
-        return _station.isEmpty() && _field.isEmpty();
+        return !_d;
     }
 
     inline operator bool()const {
@@ -79,30 +114,35 @@ public:
     }
 
     inline bool equalOrContains(const StationName& another)const{
-        return (station()==another.station()) &&
-                (field()==another.field() || isBare());
+        return (stationId()==another.stationId()) &&
+                (_d==another._d || isBare());
     }
 
     inline bool equalOrBelongsTo(const StationName& another)const{
-        return (station()==another.station()) &&
-                (field()==another.field() || another.isBare());
+        return (stationId()==another.stationId()) &&
+                (_d==another._d || another.isBare());
     }
 
-    inline bool isSingleName()const { return _field.isEmpty(); }
+    inline bool isSingleName()const { return field().isEmpty(); }
 
     /**
      * 相等，或者其中有一个有场名，另一个没有
      */
     inline bool generalEqual(const StationName& another)const {
-        return (station() == another.station()) &&
-            (field() == another.field() || another.isBare() || isBare());
+        return (stationId() == another.stationId()) &&
+            (_d == another._d || another.isBare() || isBare());
     }
 
+private:
+    /**
+     * 在全局驻留表中查找（或登记）站名，引用其条目。线程安全。
+     */
+    void intern(const QString& station, const QString& field);
 };
 
 inline uint qHash(const StationName& sn, uint seed)
 {
-    return qHash(sn.station(),seed) ^ qHash(sn.field(),seed);
+    return qHash(sn.id(), seed);
 }
 
 inline QDebug operator<<(QDebug debug, const StationName& s){
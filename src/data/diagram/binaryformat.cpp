@@ -0,0 +1,682 @@
+﻿#include "binaryformat.h"
+#include "data/train/train.h"
+
+#include <QHash>
+#include <QVector>
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QTime>
+#include <QtEndian>
+#include <QDebug>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+const QString qebinary::fileSuffix = "qetgrb";
+
+namespace {
+
+    enum Tag : quint8 {
+        TagNull = 0,
+        TagFalse,
+        TagTrue,
+        TagInt,      // int32
+        TagDouble,   // IEEE754 binary64
+        TagString,   // 字符串号
+        TagArray,    // 个数 + 各值
+        TagObject,   // 个数 + (键号, 值)...
+        TagRecords,  // 个数 + 键数 + 键号... + 逐条记录的各值
+        TagTimetable,  // 个数 + 定长的时刻表记录（版本2起）
+    };
+
+    constexpr int HEADER_SIZE = qebinary::MAGIC_SIZE + 4 * sizeof(quint32);
+    constexpr int MAX_DEPTH = 256;
+
+    /**
+     * 时刻表记录：站名号 到达 出发 备注号 股道号 是否营业 + 3字节保留，共24字节。
+     * 时刻为当日秒数，-1表示空串；没有track键时股道号为NO_STRING。
+     */
+    constexpr int TIMETABLE_RECORD_SIZE = 24;
+    constexpr quint32 NO_STRING = 0xFFFFFFFFu;
+    const QString TIMETABLE_KEY = QStringLiteral("timetable");
+
+    /**
+     * 时刻字符串对应的秒数。只接受"hh:mm:ss"格式且能原样写回的串（空串为-1），
+     * 其他情况返回false，该时刻表按通用格式存储，以保证无损。
+     */
+    bool timeToSecs(const QString& s, qint32& secs)
+    {
+        if (s.isEmpty()) {
+            secs = -1;
+            return true;
+        }
+        const QTime& tm = QTime::fromString(s, "hh:mm:ss");
+        if (!tm.isValid() || tm.toString("hh:mm:ss") != s)
+            return false;
+        secs = tm.msecsSinceStartOfDay() / 1000;
+        return true;
+    }
+
+    inline QString secsToTime(qint32 secs)
+    {
+        return secs < 0 ? QString() : QTime(0, 0).addSecs(secs).toString("hh:mm:ss");
+    }
+
+    class Encoder {
+        QByteArray _buf;
+        QHash<QString, quint32> _ids;
+        QVector<QString> _strings;
+    public:
+        inline const QByteArray& buffer()const { return _buf; }
+        inline const QVector<QString>& strings()const { return _strings; }
+
+        quint32 stringId(const QString& s) {
+            auto itr = _ids.find(s);
+            if (itr == _ids.end()) {
+                itr = _ids.insert(s, static_cast<quint32>(_strings.size()));
+                _strings.append(s);
+            }
+            return itr.value();
+        }
+
+        template <typename T>
+        void put(T v) {
+            T le = qToLittleEndian(v);
+            _buf.append(reinterpret_cast<const char*>(&le), sizeof(T));
+        }
+
+        void writeValue(const QJsonValue& v);
+
+    private:
+        void writeArray(const QJsonArray& ar);
+        void writeObject(const QJsonObject& obj);
+
+        /**
+         * 对象成员的值。车次的timetable可按定长记录存储时，写为TagTimetable
+         */
+        void writeMember(const QString& key, const QJsonValue& v);
+
+        /**
+         * 按定长记录写出时刻表；不满足条件（键不是TrainStation::toJson的那一组、
+         * 类型不对或时刻不是规范格式）时不写任何内容并返回false
+         */
+        bool writeTimetable(const QJsonArray& ar);
+
+        /**
+         * 数组是否可按记录数组存储：至少两个元素，都是键相同的非空对象
+         */
+        static bool isRecordArray(const QJsonArray& ar, QStringList& keys);
+    };
+
+    void Encoder::writeValue(const QJsonValue& v)
+    {
+        switch (v.type()) {
+        case QJsonValue::Bool: put<quint8>(v.toBool() ? TagTrue : TagFalse); break;
+        case QJsonValue::Double: {
+            double d = v.toDouble();
+            if (std::trunc(d) == d && d >= std::numeric_limits<qint32>::min() &&
+                d <= std::numeric_limits<qint32>::max() && !(d == 0 && std::signbit(d))) {
+                put<quint8>(TagInt);
+                put<qint32>(static_cast<qint32>(d));
+            }
+            else {
+                quint64 bits;
+                std::memcpy(&bits, &d, sizeof(bits));
+                put<quint8>(TagDouble);
+                put<quint64>(bits);
+            }
+        }break;
+        case QJsonValue::String: put<quint8>(TagString); put<quint32>(stringId(v.toString())); break;
+        case QJsonValue::Array: writeArray(v.toArray()); break;
+        case QJsonValue::Object: writeObject(v.toObject()); break;
+        default: put<quint8>(TagNull); break;
+        }
+    }
+
+    void Encoder::writeArray(const QJsonArray& ar)
+    {
+        QStringList keys;
+        if (isRecordArray(ar, keys)) {
+            put<quint8>(TagRecords);
+            put<quint32>(static_cast<quint32>(ar.size()));
+            put<quint32>(static_cast<quint32>(keys.size()));
+            for (const auto& k : keys)
+                put<quint32>(stringId(k));
+            for (const auto& p : ar) {
+                const QJsonObject& obj = p.toObject();
+                for (const auto& k : keys)
+                    writeMember(k, obj.value(k));
+            }
+        }
+        else {
+            put<quint8>(TagArray);
+            put<quint32>(static_cast<quint32>(ar.size()));
+            for (const auto& p : ar)
+                writeValue(p);
+        }
+    }
+
+    void Encoder::writeObject(const QJsonObject& obj)
+    {
+        put<quint8>(TagObject);
+        put<quint32>(static_cast<quint32>(obj.size()));
+        for (auto p = obj.begin(); p != obj.end(); ++p) {
+            put<quint32>(stringId(p.key()));
+            writeMember(p.key(), p.value());
+        }
+    }
+
+    void Encoder::writeMember(const QString& key, const QJsonValue& v)
+    {
+        if (key == TIMETABLE_KEY && v.isArray() && writeTimetable(v.toArray()))
+            return;
+        writeValue(v);
+    }
+
+    bool Encoder::writeTimetable(const QJsonArray& ar)
+    {
+        struct Record {
+            QString name, note, track;
+            qint32 arrive, depart;
+            bool business, hasTrack;
+        };
+        QVector<Record> records;
+        records.reserve(ar.size());
+        for (const auto& p : ar) {
+            if (!p.isObject())
+                return false;
+            const QJsonObject& obj = p.toObject();
+            const auto& name = obj.value("zhanming"), & arrive = obj.value("ddsj"),
+                & depart = obj.value("cfsj"), & note = obj.value("note"),
+                & business = obj.value("business"), & track = obj.value("track");
+            Record r;
+            r.hasTrack = obj.contains("track");
+            if (obj.size() != (r.hasTrack ? 6 : 5) || !name.isString() || !arrive.isString() ||
+                !depart.isString() || !note.isString() || !business.isBool() ||
+                (r.hasTrack && !track.isString()))
+                return false;
+            if (!timeToSecs(arrive.toString(), r.arrive) || !timeToSecs(depart.toString(), r.depart))
+                return false;
+            r.name = name.toString();
+            r.note = note.toString();
+            r.track = track.toString();
+            r.business = business.toBool();
+            records.append(r);
+        }
+
+        put<quint8>(TagTimetable);
+        put<quint32>(static_cast<quint32>(records.size()));
+        for (const auto& r : records) {
+            put<quint32>(stringId(r.name));
+            put<qint32>(r.arrive);
+            put<qint32>(r.depart);
+            put<quint32>(stringId(r.note));
+            put<quint32>(r.hasTrack ? stringId(r.track) : NO_STRING);
+            put<quint8>(r.business);
+            put<quint8>(0);
+            put<quint16>(0);
+        }
+        return true;
+    }
+
+    bool Encoder::isRecordArray(const QJsonArray& ar, QStringList& keys)
+    {
+        if (ar.size() < 2 || !ar.first().isObject())
+            return false;
+        keys = ar.first().toObject().keys();
+        if (keys.isEmpty())
+            return false;
+        for (const auto& p : ar) {
+            if (!p.isObject())
+                return false;
+            const QJsonObject& obj = p.toObject();
+            if (obj.size() != keys.size())
+                return false;
+            // QJsonObject的键有序，因此逐个比较即可
+            int i = 0;
+            for (auto q = obj.begin(); q != obj.end(); ++q, ++i) {
+                if (q.key() != keys.at(i))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    class Decoder {
+        const char* const _data;
+        const qint64 _size;
+        bool _ok = true;
+        QVector<QString> _strings;
+    public:
+        Decoder(const QByteArray& data) :
+            _data(data.constData()), _size(data.size()) {}
+
+        inline bool ok()const { return _ok; }
+        inline void fail() { _ok = false; }
+
+        template <typename T>
+        T get(qint64& pos) {
+            if (!_ok || pos < 0 || pos + static_cast<qint64>(sizeof(T)) > _size) {
+                _ok = false;
+                return T{};
+            }
+            T v = qFromLittleEndian<T>(_data + pos);
+            pos += sizeof(T);
+            return v;
+        }
+
+        bool readStrings(qint64 pos, quint32 count);
+
+        QString string(quint32 id) {
+            if (id >= static_cast<quint32>(_strings.size())) {
+                _ok = false;
+                return {};
+            }
+            return _strings.at(id);
+        }
+
+        QJsonValue readValue(qint64& pos, int depth = 0);
+
+        /**
+         * 读取trains段，直接构造车次。元素不是对象时失败
+         */
+        void readTrains(qint64& pos, TypeManager& manager, QList<std::shared_ptr<Train>>& trains);
+
+    private:
+        /**
+         * 读取一条时刻表记录的各字段，不做转换
+         */
+        struct TimetableRecord {
+            quint32 name, note, track;
+            qint32 arrive, depart;
+            bool business;
+        };
+        TimetableRecord readTimetableRecord(qint64& pos);
+
+        /**
+         * 一个车次的成员。TagTimetable的时刻表直接读入table，其他成员解码到obj中
+         */
+        void readTrainMember(qint64& pos, const QString& key, QJsonObject& obj,
+            std::list<TrainStation>& table, bool& hasTable);
+
+        /**
+         * 由解码的成员构造车次：其他成员由Train::fromJson读取，再装入直接读入的时刻表
+         */
+        std::shared_ptr<Train> makeTrain(const QJsonObject& obj, std::list<TrainStation>& table,
+            bool hasTable, TypeManager& manager);
+
+        /**
+         * 记录数组的键表。键数为0的记录数组不合法（此时个数无法由数据长度约束）
+         */
+        QStringList readRecordKeys(qint64& pos, quint32 n, quint32 nkeys);
+
+        /**
+         * 声明的元素个数是否可能：每个元素至少占1字节，防止损坏的数据导致巨量分配
+         */
+        bool checkCount(qint64 pos, quint64 count) {
+            if (static_cast<quint64>(_size - pos) < count) {
+                _ok = false;
+            }
+            return _ok;
+        }
+    };
+
+    bool Decoder::readStrings(qint64 pos, quint32 count)
+    {
+        if (!checkCount(pos, static_cast<quint64>(count) * 8))
+            return false;
+        _strings.reserve(count);
+        for (quint32 i = 0; i < count; i++) {
+            quint32 off = get<quint32>(pos), len = get<quint32>(pos);
+            if (!_ok || static_cast<qint64>(off) + len > _size) {
+                _ok = false;
+                return false;
+            }
+            _strings.append(QString::fromUtf8(_data + off, static_cast<int>(len)));
+        }
+        return true;
+    }
+
+    QJsonValue Decoder::readValue(qint64& pos, int depth)
+    {
+        if (depth > MAX_DEPTH) {
+            _ok = false;
+            return {};
+        }
+        quint8 tag = get<quint8>(pos);
+        if (!_ok)
+            return {};
+        switch (tag) {
+        case TagNull: return QJsonValue(QJsonValue::Null);
+        case TagFalse: return false;
+        case TagTrue: return true;
+        case TagInt: return get<qint32>(pos);
+        case TagDouble: {
+            quint64 bits = get<quint64>(pos);
+            double d;
+            std::memcpy(&d, &bits, sizeof(d));
+            return d;
+        }
+        case TagString: return string(get<quint32>(pos));
+        case TagArray: {
+            quint32 n = get<quint32>(pos);
+            QJsonArray ar;
+            if (!checkCount(pos, n))
+                return {};
+            for (quint32 i = 0; i < n && _ok; i++)
+                ar.append(readValue(pos, depth + 1));
+            return ar;
+        }
+        case TagObject: {
+            quint32 n = get<quint32>(pos);
+            QJsonObject obj;
+            if (!checkCount(pos, static_cast<quint64>(n) * 5))
+                return {};
+            for (quint32 i = 0; i < n && _ok; i++) {
+                const QString& key = string(get<quint32>(pos));
+                obj.insert(key, readValue(pos, depth + 1));
+            }
+            return obj;
+        }
+        case TagRecords: {
+            quint32 n = get<quint32>(pos), nkeys = get<quint32>(pos);
+            const QStringList& keys = readRecordKeys(pos, n, nkeys);
+            if (!_ok)
+                return {};
+            QJsonArray ar;
+            for (quint32 i = 0; i < n && _ok; i++) {
+                QJsonObject obj;
+                for (const auto& k : keys)
+                    obj.insert(k, readValue(pos, depth + 1));
+                ar.append(obj);
+            }
+            return ar;
+        }
+        case TagTimetable: {
+            quint32 n = get<quint32>(pos);
+            if (!checkCount(pos, static_cast<quint64>(n) * TIMETABLE_RECORD_SIZE))
+                return {};
+            QJsonArray ar;
+            for (quint32 i = 0; i < n && _ok; i++) {
+                const auto& r = readTimetableRecord(pos);
+                QJsonObject obj{
+                    {"zhanming", string(r.name)},
+                    {"ddsj", secsToTime(r.arrive)},
+                    {"cfsj", secsToTime(r.depart)},
+                    {"business", r.business},
+                    {"note", string(r.note)},
+                };
+                if (r.track != NO_STRING)
+                    obj.insert("track", string(r.track));
+                ar.append(obj);
+            }
+            return ar;
+        }
+        default:
+            _ok = false;
+            return {};
+        }
+    }
+
+    QStringList Decoder::readRecordKeys(qint64& pos, quint32 n, quint32 nkeys)
+    {
+        if (nkeys == 0) {
+            _ok = false;
+            return {};
+        }
+        if (!checkCount(pos, static_cast<quint64>(nkeys) * 4))
+            return {};
+        QStringList keys;
+        keys.reserve(nkeys);
+        for (quint32 i = 0; i < nkeys; i++)
+            keys.append(string(get<quint32>(pos)));
+        checkCount(pos, static_cast<quint64>(n) * nkeys);
+        return keys;
+    }
+
+    Decoder::TimetableRecord Decoder::readTimetableRecord(qint64& pos)
+    {
+        TimetableRecord r;
+        r.name = get<quint32>(pos);
+        r.arrive = get<qint32>(pos);
+        r.depart = get<qint32>(pos);
+        r.note = get<quint32>(pos);
+        r.track = get<quint32>(pos);
+        r.business = get<quint8>(pos);
+        get<quint8>(pos);
+        get<quint16>(pos);
+        if (r.arrive < -1 || r.arrive >= 24 * 3600 || r.depart < -1 || r.depart >= 24 * 3600)
+            _ok = false;
+        return r;
+    }
+
+    void Decoder::readTrainMember(qint64& pos, const QString& key, QJsonObject& obj,
+        std::list<TrainStation>& table, bool& hasTable)
+    {
+        if (key != TIMETABLE_KEY || pos >= _size || static_cast<quint8>(_data[pos]) != TagTimetable) {
+            obj.insert(key, readValue(pos, 1));
+            return;
+        }
+        ++pos;
+        quint32 n = get<quint32>(pos);
+        if (!checkCount(pos, static_cast<quint64>(n) * TIMETABLE_RECORD_SIZE))
+            return;
+        hasTable = true;
+        for (quint32 i = 0; i < n && _ok; i++) {
+            const auto& r = readTimetableRecord(pos);
+            // 与TrainStation::fromJson读入的内容一致：不读股道
+            table.emplace_back(StationName::fromSingleLiteral(string(r.name)),
+                r.arrive < 0 ? QTime() : QTime(0, 0).addSecs(r.arrive),
+                r.depart < 0 ? QTime() : QTime(0, 0).addSecs(r.depart),
+                r.business, QString(), string(r.note));
+        }
+    }
+
+    std::shared_ptr<Train> Decoder::makeTrain(const QJsonObject& obj, std::list<TrainStation>& table,
+        bool hasTable, TypeManager& manager)
+    {
+        auto train = std::make_shared<Train>(obj, manager);
+        if (hasTable) {
+            train->timetable() = std::move(table);
+            train->invalidateTempData();
+        }
+        return train;
+    }
+
+    void Decoder::readTrains(qint64& pos, TypeManager& manager, QList<std::shared_ptr<Train>>& trains)
+    {
+        quint8 tag = get<quint8>(pos);
+        if (!_ok)
+            return;
+        if (tag == TagArray) {
+            quint32 n = get<quint32>(pos);
+            if (!checkCount(pos, n))
+                return;
+            trains.reserve(n);
+            for (quint32 i = 0; i < n && _ok; i++) {
+                if (get<quint8>(pos) != TagObject) {
+                    _ok = false;
+                    return;
+                }
+                quint32 nmem = get<quint32>(pos);
+                if (!checkCount(pos, static_cast<quint64>(nmem) * 5))
+                    return;
+                QJsonObject obj;
+                std::list<TrainStation> table;
+                bool hasTable = false;
+                for (quint32 j = 0; j < nmem && _ok; j++) {
+                    const QString& key = string(get<quint32>(pos));
+                    readTrainMember(pos, key, obj, table, hasTable);
+                }
+                if (_ok)
+                    trains.append(makeTrain(obj, table, hasTable, manager));
+            }
+        }
+        else if (tag == TagRecords) {
+            quint32 n = get<quint32>(pos), nkeys = get<quint32>(pos);
+            const QStringList& keys = readRecordKeys(pos, n, nkeys);
+            if (!_ok)
+                return;
+            trains.reserve(n);
+            for (quint32 i = 0; i < n && _ok; i++) {
+                QJsonObject obj;
+                std::list<TrainStation> table;
+                bool hasTable = false;
+                for (const auto& k : keys)
+                    readTrainMember(pos, k, obj, table, hasTable);
+                if (_ok)
+                    trains.append(makeTrain(obj, table, hasTable, manager));
+            }
+        }
+        else {
+            _ok = false;
+        }
+    }
+
+    /**
+     * 读取文件头和字符串表，pos置于段目录开头
+     */
+    bool readHeader(const QByteArray& data, Decoder& dec, qint64& pos, quint32& sectionCount,
+        const char* caller)
+    {
+        if (!qebinary::isBinaryDiagram(data)) {
+            qDebug() << caller << ": WARNING: not a binary diagram";
+            return false;
+        }
+        pos = qebinary::MAGIC_SIZE;
+        quint32 version = dec.get<quint32>(pos);
+        sectionCount = dec.get<quint32>(pos);
+        quint32 stringCount = dec.get<quint32>(pos);
+        quint32 stringTableOffset = dec.get<quint32>(pos);
+        if (version > qebinary::VERSION) {
+            qDebug() << caller << ": WARNING: unsupported version " << version;
+            return false;
+        }
+        if (!dec.readStrings(stringTableOffset, stringCount)) {
+            qDebug() << caller << ": WARNING: corrupted string table";
+            return false;
+        }
+        return true;
+    }
+}
+
+bool qebinary::isBinaryDiagram(const QByteArray& data)
+{
+    return data.size() >= HEADER_SIZE && std::memcmp(data.constData(), MAGIC, MAGIC_SIZE) == 0;
+}
+
+QByteArray qebinary::encode(const QJsonObject& obj)
+{
+    Encoder enc;
+    struct Section {
+        quint32 key, offset, size;
+    };
+    QVector<Section> sections;
+    sections.reserve(obj.size());
+    for (auto p = obj.begin(); p != obj.end(); ++p) {
+        quint32 start = static_cast<quint32>(enc.buffer().size());
+        enc.writeValue(p.value());
+        sections.append({ enc.stringId(p.key()), start,
+            static_cast<quint32>(enc.buffer().size()) - start });
+    }
+
+    // 各段在文件中的实际位置：文件头、段目录之后
+    const quint32 base = HEADER_SIZE + sections.size() * 3 * sizeof(quint32);
+    const auto& strings = enc.strings();
+    const quint32 stringTableOffset = base + static_cast<quint32>(enc.buffer().size());
+
+    Encoder out;
+    out.put<quint64>(0);   // 占位，下面写入magic
+    out.put<quint32>(VERSION);
+    out.put<quint32>(static_cast<quint32>(sections.size()));
+    out.put<quint32>(static_cast<quint32>(strings.size()));
+    out.put<quint32>(stringTableOffset);
+    for (const auto& s : sections) {
+        out.put<quint32>(s.key);
+        out.put<quint32>(base + s.offset);
+        out.put<quint32>(s.size);
+    }
+
+    QVector<QByteArray> utf8;
+    utf8.reserve(strings.size());
+    for (const auto& s : strings)
+        utf8.append(s.toUtf8());
+    quint32 poolOffset = stringTableOffset + strings.size() * 2 * sizeof(quint32);
+    for (const auto& s : utf8) {
+        out.put<quint32>(poolOffset);
+        out.put<quint32>(static_cast<quint32>(s.size()));
+        poolOffset += s.size();
+    }
+
+    QByteArray res = out.buffer();
+    std::memcpy(res.data(), MAGIC, MAGIC_SIZE);
+    // 段数据插在段目录与字符串表之间
+    res.insert(base, enc.buffer());
+    for (const auto& s : utf8)
+        res.append(s);
+    return res;
+}
+
+QJsonObject qebinary::decode(const QByteArray& data, bool* ok, const QStringList& sections,
+    const QStringList& skipped)
+{
+    QJsonObject res;
+    if (ok)
+        *ok = false;
+    Decoder dec(data);
+    qint64 pos;
+    quint32 sectionCount;
+    if (!readHeader(data, dec, pos, sectionCount, "qebinary::decode"))
+        return res;
+    for (quint32 i = 0; i < sectionCount && dec.ok(); i++) {
+        const QString& key = dec.string(dec.get<quint32>(pos));
+        qint64 offset = dec.get<quint32>(pos);
+        qint64 size = dec.get<quint32>(pos);
+        if (!dec.ok() || (!sections.isEmpty() && !sections.contains(key)) || skipped.contains(key))
+            continue;
+        qint64 p = offset;
+        const QJsonValue& v = dec.readValue(p);
+        if (p != offset + size)
+            dec.fail();
+        res.insert(key, v);
+    }
+    if (!dec.ok()) {
+        qDebug() << "qebinary::decode: WARNING: corrupted data";
+        return {};
+    }
+    if (ok)
+        *ok = true;
+    return res;
+}
+
+QList<std::shared_ptr<Train>> qebinary::decodeTrains(const QByteArray& data, TypeManager& manager,
+    bool* ok)
+{
+    QList<std::shared_ptr<Train>> res;
+    if (ok)
+        *ok = false;
+    Decoder dec(data);
+    qint64 pos;
+    quint32 sectionCount;
+    if (!readHeader(data, dec, pos, sectionCount, "qebinary::decodeTrains"))
+        return res;
+    for (quint32 i = 0; i < sectionCount && dec.ok(); i++) {
+        const QString& key = dec.string(dec.get<quint32>(pos));
+        qint64 offset = dec.get<quint32>(pos);
+        qint64 size = dec.get<quint32>(pos);
+        if (!dec.ok() || key != "trains")
+            continue;
+        qint64 p = offset;
+        dec.readTrains(p, manager, res);
+        if (p != offset + size)
+            dec.fail();
+        break;
+    }
+    if (!dec.ok()) {
+        qDebug() << "qebinary::decodeTrains: WARNING: corrupted data";
+        return {};
+    }
+    if (ok)
+        *ok = true;
+    return res;
+}
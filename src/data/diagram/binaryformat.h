@@ -0,0 +1,73 @@
+﻿#pragma once
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <memory>
+
+class Train;
+class TypeManager;
+
+/**
+ * 2026.10  qETRC二进制运行图格式 (*.qetgrb)
+ * 与JSON格式 (Diagram::toJson) 一一对应，可无损互相转换；
+ * 读入时不做文本解析，可直接在映射到内存的文件上解码。
+ *
+ * 文件布局（小端序，偏移量均相对于文件开头）：
+ *   文件头  magic[8]="QETRCBIN"  version  sectionCount  stringCount  stringTableOffset
+ *   段目录  sectionCount × {键的字符串号, 段偏移, 段长度}
+ *   各段    每个顶层成员（线路line/lines、车次trains、交路circuits、config、pages等）单独成段，
+ *           可只解码所需的段
+ *   字符串表  stringCount × {偏移, 长度} + UTF-8数据。
+ *           所有键和字符串值（主要是站名）只存一次，值中以编号引用
+ *
+ * 值的编码：1字节类型标记 + 数据。
+ * 元素都是同一组键的对象组成的数组（如标尺节点）按“记录数组”存储：
+ * 键表只写一次，每条记录按键表顺序依次存放各值。
+ *
+ * 车次的时刻表（timetable）按定长记录存储（版本2起）：每站24字节，
+ *   {站名号, 到达秒数, 出发秒数, 备注号, 股道号, 是否营业, 保留3字节}
+ * 时刻为当日秒数，空串记为-1；没有track键时股道号为0xFFFFFFFF。
+ * 只有键与类型同TrainStation::toJson、时刻为规范的"hh:mm:ss"的时刻表才如此存储，
+ * 其他的仍按通用编码，因此仍可无损转换。
+ *
+ * 读入运行图时，车次由decodeTrains()直接构造：时刻表记录直接成为TrainStation，
+ * 不经过QJsonObject，也不解析时刻字符串；其余各段仍解码为QJsonObject后照常读取。
+ */
+namespace qebinary {
+
+    constexpr char MAGIC[] = "QETRCBIN";
+    constexpr int MAGIC_SIZE = 8;
+    constexpr quint32 VERSION = 2;
+
+    extern const QString fileSuffix;
+
+    /**
+     * 数据是否以本格式的文件头开始
+     */
+    bool isBinaryDiagram(const QByteArray& data);
+
+    /**
+     * 将Diagram::toJson()给出的对象编码为二进制格式
+     */
+    QByteArray encode(const QJsonObject& obj);
+
+    /**
+     * 解码为与JSON格式相同的对象。
+     * sections非空时，只解码其中列出的顶层成员；skipped中的成员不解码。
+     * 数据损坏（越界、未知标记、版本不支持）时ok置为false，返回空对象。
+     */
+    QJsonObject decode(const QByteArray& data, bool* ok = nullptr,
+        const QStringList& sections = {}, const QStringList& skipped = {});
+
+    /**
+     * 2026.10  直接由trains段构造车次，结果与decode()后由Train(QJsonObject, TypeManager&)读取的相同
+     * （与TrainStation::fromJson一样，不读入股道）。
+     * 车次的其他成员仍解码为对象后由Train::fromJson读取，只有时刻表直接构造。
+     * 没有trains段时返回空表；数据损坏时ok置为false，返回空表。
+     */
+    QList<std::shared_ptr<Train>> decodeTrains(const QByteArray& data, TypeManager& manager,
+        bool* ok = nullptr);
+}
@@ -1,5 +1,9 @@
 ﻿#include "diadiff.h"
 #include <data/train/train.h>
+#include <data/train/timetablearrays.h>
+
+#include <algorithm>
+#include <utility>
 
 
 StationDiff::DiffType StationDiff::stationCompareType(
@@ -49,111 +53,109 @@ const TrainName& TrainDifference::trainName() const
     return train1 ? train1->trainName() : train2->trainName();
 }
 
-int TrainDifference::calSimilarity(const TrainStation &st1, const TrainStation &st2)
-{
-    if (st1.name == st2.name)
-        return 1;
-    else return 0;
-}
-
 void TrainDifference::compute()
 {
     if (train1->empty() || train2->empty()){
         // 特殊情况？
         return;
     }
-    xtl::matrix<int> table(train1->stationCount(),train2->stationCount()),
-            next_i(train1->stationCount(),train2->stationCount()),
-            next_j(train1->stationCount(),train2->stationCount());
-    table.fill(-1);
-    next_i.fill(-1);
-    next_j.fill(-1);
-
-    similarity=solve(0,0,train1->timetable().begin(),train2->timetable().begin(),
-                     table,next_i,next_j);
-    difference=genResult(0,0,train1->timetable().begin(),train2->timetable().begin(),
-                         next_i,next_j);
+    auto arr1 = train1->timetableArrays(), arr2 = train2->timetableArrays();
+    const auto& a1 = *arr1;
+    const auto& a2 = *arr2;
+    const int n1 = a1.size(), n2 = a2.size();
+
+    // 2026.10  站名、时刻都相同的首尾站直接配对，不进入DP；
+    // 整车未修改时前缀即覆盖全部站，只需一次线性扫描
+    auto identical = [&a1, &a2](int i, int j) {
+        return a1.nameId(i) == a2.nameId(j) && a1.arrive(i) == a2.arrive(j) &&
+            a1.depart(i) == a2.depart(j);
+    };
+    int pre = 0;
+    while (pre < n1 && pre < n2 && identical(pre, pre))
+        pre++;
+    int suf = 0;
+    while (suf < n1 - pre && suf < n2 - pre && identical(n1 - 1 - suf, n2 - 1 - suf))
+        suf++;
+
+    similarity = pre + suf;
+    difference = 0;
+    stations.reserve(std::max(n1, n2));
+    for (int i = 0; i < pre; i++)
+        difference += addStation(a1.node(i), a2.node(i));
+    similarity += solveCore(a1, a2, pre, n1 - suf, pre, n2 - suf);
+    for (int k = suf; k > 0; k--)
+        difference += addStation(a1.node(n1 - k), a2.node(n2 - k));
+
     if (difference==0)
         type=Unchanged;
 }
 
-int TrainDifference::solve(int s1, int s2, std::list<TrainStation>::const_iterator itr1,
-                           std::list<TrainStation>::const_iterator itr2, xtl::matrix<int> &table,
-                           xtl::matrix<int> &next_i, xtl::matrix<int> &next_j)
+int TrainDifference::solveCore(const TimetableArrays& a1, const TimetableArrays& a2,
+                               int b1, int e1, int b2, int e2)
 {
-    if (s1>=train1->stationCount() && s2>=train2->stationCount()){
-        // 双越界  长度为0的话直接这里走掉了
+    const int m = e1 - b1, n = e2 - b2;
+    if (m == 0 || n == 0) {
+        for (int i = b1; i < e1; i++)
+            difference += addStation(a1.node(i), std::nullopt);
+        for (int j = b2; j < e2; j++)
+            difference += addStation(std::nullopt, a2.node(j));
         return 0;
-    }else if (s1>=train1->stationCount()){
-        // s1越界，则2和空白匹配一位
-        next_i.get(s1-1,s2)=s1;
-        next_j.get(s1-1,s2)=s2+1;
-        return 0+solve(s1,s2+1,itr1,std::next(itr2),table,next_i,next_j);
-    }else if (s2>=train2->stationCount()){
-        next_i.get(s1,s2-1)=s1+1;
-        next_j.get(s1,s2-1)=s2;
-        return 0+solve(s1+1,s2,std::next(itr1),itr2,table,next_i,next_j);
     }
 
-    if (table.get(s1,s2) != -1){
-        return table.get(s1,s2);
-    }
-    int rec1=calSimilarity(*itr1,*itr2)+
-            solve(s1+1,s2+1,std::next(itr1),std::next(itr2),table,next_i,next_j);
-    int rec2=0+solve(s1,s2+1,itr1,std::next(itr2),table,next_i,next_j);
-    int rec3=0+solve(s1+1,s2,std::next(itr1),itr2,table,next_i,next_j);
-    int sol=std::max({rec1,rec2,rec3});
-    table.get(s1,s2)=sol;
-    if(sol==rec1){
-        next_i.get(s1,s2)=s1+1;
-        next_j.get(s1,s2)=s2+1;
-    }else if(sol==rec2){
-        next_i.get(s1,s2)=s1;
-        next_j.get(s1,s2)=s2+1;
-    }else{
-        next_i.get(s1,s2)=s1+1;
-        next_j.get(s1,s2)=s2;
+    // 分数：(相似度, 差异数)，相似度大者优，其次差异数小者优
+    using score_t = std::pair<int, int>;
+    auto better = [](const score_t& x, const score_t& y) {
+        return x.first > y.first || (x.first == y.first && x.second < y.second);
+    };
+    enum Step : unsigned char { Both, Next2, Next1 };
+
+    // row[j]为子问题(i, j)的分数，below为第i+1行；i==m或j==n时只能逐个删除/新增
+    std::vector<score_t> row(n + 1), below(n + 1);
+    std::vector<unsigned char> step(static_cast<size_t>(m) * n);
+    for (int j = 0; j <= n; j++)
+        below[j] = { 0, n - j };
+    for (int i = m - 1; i >= 0; i--) {
+        row[n] = { 0, m - i };
+        const auto& st1 = *a1.node(b1 + i);
+        for (int j = n - 1; j >= 0; j--) {
+            const auto& st2 = *a2.node(b2 + j);
+            int sim = a1.nameId(b1 + i) == a2.nameId(b2 + j) ? 1 : 0;
+            int diff;
+            switch (StationDiff::stationCompareType(st1, st2)) {
+            case StationDiff::Unchanged: diff = 0; break;
+            case StationDiff::NewAdded: diff = 2; break;   // 两个无关，分别删除、新增
+            default: diff = 1; break;
+            }
+            score_t best{ sim + below[j + 1].first, diff + below[j + 1].second };
+            Step s = Both;
+            if (score_t r{ row[j + 1].first, row[j + 1].second + 1 }; better(r, best)) {
+                best = r;
+                s = Next2;
+            }
+            if (score_t r{ below[j].first, below[j].second + 1 }; better(r, best)) {
+                best = r;
+                s = Next1;
+            }
+            row[j] = best;
+            step[static_cast<size_t>(i) * n + j] = s;
+        }
+        std::swap(row, below);
     }
-    return sol;
-}
 
-int TrainDifference::genResult(int s1, int s2, std::list<TrainStation>::const_iterator itr1,
-                               std::list<TrainStation>::const_iterator itr2,
-                               xtl::matrix<int>& next_i, xtl::matrix<int>& next_j)
-{
-    if (s1==-1 || s2==-1){
-        return 0;
-    }
-    if (s1>=train1->stationCount() && s2>=train2->stationCount()){
-        return 0;
-    }else if (s1>=train1->stationCount()){
-        addStation(std::nullopt,itr2);
-        return 1+genResult(s1,s2+1,itr1,std::next(itr2),next_i,next_j);
-    }else if(s2>=train2->stationCount()){
-        addStation(itr1,std::nullopt);
-        return 1+genResult(s1+1,s2,std::next(itr1),itr2,next_i,next_j);
-    }
-    int nxi=next_i.get(s1,s2);
-    int nxj=next_j.get(s1,s2);
-    int diff;
-    if (nxi!=s1 && nxj!=s2){
-        diff=addStation(itr1,itr2);
-    }else if(nxi!=s1){
-        diff=addStation(itr1,std::nullopt);
-    }else{
-        diff=addStation(std::nullopt,itr2);
+    // 回溯
+    int i = 0, j = 0;
+    while (i < m && j < n) {
+        switch (step[static_cast<size_t>(i) * n + j]) {
+        case Both: difference += addStation(a1.node(b1 + i), a2.node(b2 + j)); i++; j++; break;
+        case Next2: difference += addStation(std::nullopt, a2.node(b2 + j)); j++; break;
+        default: difference += addStation(a1.node(b1 + i), std::nullopt); i++; break;
+        }
     }
-    return diff+genResult(nxi,nxj,nextItr(s1,itr1,nxi),
-                          nextItr(s2,itr2,nxj),next_i,next_j);
-}
-
-
-
-std::list<TrainStation>::const_iterator TrainDifference::nextItr(int s,
-                        std::list<TrainStation>::const_iterator itr, int nx)
-{
-    std::advance(itr,nx-s);
-    return itr;
+    for (; i < m; i++)
+        difference += addStation(a1.node(b1 + i), std::nullopt);
+    for (; j < n; j++)
+        difference += addStation(std::nullopt, a2.node(b2 + j));
+    return below[0].first;
 }
 
 int TrainDifference::addStation(std::optional<std::list<TrainStation>::const_iterator> si,
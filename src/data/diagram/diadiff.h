@@ -4,9 +4,9 @@
 #include <list>
 #include <vector>
 #include <optional>
-#include "xtl_matrix.hpp"
 
 class TrainStation;
+class TimetableArrays;
 
 struct StationDiff{
     enum DiffType{
@@ -63,49 +63,21 @@ public:
     const TrainName& trainName()const;
 
 private:
-    int calSimilarity(const TrainStation& st1, const TrainStation& st2);
-
     /**
      * 计算的总入口函数。将结果直接保存在类内。原则上，只能调用一次。
      */
     void compute();
 
     /**
-     * @brief solve  递归求解。pyETRC.Train.globalDiff.solve()
-     * @param s1 train1车次起始下标子问题
-     * @param s2 train2车次起始下标子问题
-     * @param table DP字典
-     * @param next_i DP路径
-     * @param next_j
+     * 2026.10  去掉相同前缀、后缀之后，中间部分的自底向上DP。pyETRC.Train.globalDiff.solve()
+     * 下标区间为train1的[b1, e1)与train2的[b2, e2)。
+     * 以相似度（同名站配对数）最大为第一目标，差异数最小为第二目标；
+     * 同分时依次优先配对、跳过train2的站、跳过train1的站。
+     * 分数只保留两行，回溯方向按字节存储；不递归。
      * @return 相似度
      */
-    int solve(int s1, int s2, std::list<TrainStation>::const_iterator itr1,
-              std::list<TrainStation>::const_iterator itr2,
-              xtl::matrix<int>& table,
-              xtl::matrix<int>& next_i, xtl::matrix<int>& next_j);
-
-    /**
-     * @brief genResult  pyETRC.Train.globalDiff.generate_result()
-     * itr (1,2) 是与s (1,2)对应的迭代器，用来回避下标运算。
-     * 如果s1, s2之间有一个是-1，那么立即返回，此时不用考虑迭代器。
-     * 迭代器总是单向移动的。
-     * @return
-     */
-    int genResult(int s1,int s2,
-                  std::list<TrainStation>::const_iterator itr1,
-                  std::list<TrainStation>::const_iterator itr2,
-                  xtl::matrix<int>& next_i,
-                  xtl::matrix<int>& next_j);
-
-    /**
-     * @brief nextItr  用迭代器作差的方法，计算与nx对应的下一个迭代器。
-     * @param s 初始下标 （非-1）
-     * @param itr 初始迭代器
-     * @param nx 目标下标
-     * @return 新的迭代器，与nx对应
-     */
-    std::list<TrainStation>::const_iterator
-        nextItr(int s, std::list<TrainStation>::const_iterator itr, int nx);
+    int solveCore(const TimetableArrays& a1, const TimetableArrays& a2,
+                  int b1, int e1, int b2, int e2);
 
     int addStation(std::optional<std::list<TrainStation>::const_iterator> si,
                    std::optional<std::list<TrainStation>::const_iterator> sj);
@@ -1,18 +1,28 @@
 ﻿#include "diagram.h"
 #include "data/rail/railway.h"
 #include "trainadapter.h"
-#include "util/utilfunc.h"
+#include "trainlineindex.h"
+#include "data/common/timeutil.h"
 #include "data/train/routing.h"
 #include "data/diagram/traingap.h"
 #include "data/train/trainfiltercore.h"
 #include "data/diagram/diagrampage.h"
 #include "data/rail/forbid.h"
 #include "mainwindow/version.h"
+#include "data/common/jsonstreamreader.h"
+#include "binaryformat.h"
 
 #include <QFile>
+#include <QFileInfo>
 #include <QJsonObject>
 #include <numeric>
+#include <algorithm>
 #include <QJsonDocument>
+#include <QtConcurrent>
+#include <QCryptographicHash>
+#include <unordered_map>
+#include <tuple>
+#include <atomic>
 #include <cmath>
 
 
@@ -22,6 +32,7 @@ void Diagram::addRailway(std::shared_ptr<Railway> rail)
     foreach (auto p , trains()) {
         p->bindToRailway(rail, _config);
     }
+    invalidateAllTempData();
 }
 
 void Diagram::insertRailwayAt(int i, std::shared_ptr<Railway> rail)
@@ -30,6 +41,7 @@ void Diagram::insertRailwayAt(int i, std::shared_ptr<Railway> rail)
     foreach(auto p, trains()) {
         p->bindToRailway(rail, _config);
     }
+    invalidateAllTempData();
 }
 
 void Diagram::addTrains(const TrainCollection& coll)
@@ -58,20 +70,31 @@ void Diagram::updateRailway(std::shared_ptr<Railway> r)
     foreach (const auto& p, _trainCollection.trains()){
         p->updateBoundRailway(r, _config);
     }
+    invalidateAllTempData();
 }
 
 void Diagram::updateTrain(std::shared_ptr<Train> t)
 {
     foreach(const auto& r, railways()){
-        t->updateBoundRailway(r, _config);
+        auto cache = _eventAxes.find(r);
+        if (cache == _eventAxes.end()) {
+            t->updateBoundRailway(r, _config);
+        }
+        else {
+            std::shared_ptr<const TrainAdapter> old = t->adapterFor(*r);
+            auto adp = t->updateBoundRailway(r, _config);
+            updateEventAxisForTrain(*(cache->second), old, adp);
+        }
     }
+    invalidateTempData();
 }
 
 TrainEventList Diagram::listTrainEvents(const Train& train) const
 {
     TrainEventList res;
     foreach (auto p , train.adapters()) {
-        res.push_back(qMakePair(p, p->listAdapterEvents(_trainCollection)));
+        auto index = lineIndexFor(p->railway());
+        res.push_back(qMakePair(p, p->listAdapterEvents(*index)));
     }
     return res;
 }
@@ -84,8 +107,9 @@ DiagnosisList Diagram::diagnoseTrain(const Train& train, bool withIntMeet,
     bool filtByRange = railway && start && end;
     foreach(auto adp, train.adapters()) {
         if (!railway || adp->railway() == railway) {
+            auto index = lineIndexFor(adp->railway());
             foreach(auto line, adp->lines()) {
-                auto sub = line->diagnoseLine(_trainCollection, withIntMeet);
+                auto sub = line->diagnoseLine(*index, withIntMeet);
                 if (filtByRange) {
                     foreach(auto ev, sub) {
                         if (ev.inRange(start,end)) {
@@ -104,14 +128,93 @@ DiagnosisList Diagram::diagnoseTrain(const Train& train, bool withIntMeet,
 
 DiagnosisList Diagram::diagnoseAllTrains(bool withIntMeet, std::shared_ptr<Railway> railway, std::shared_ptr<RailStation> start,
     std::shared_ptr<RailStation> end) const
+{
+    auto future = diagnoseAllTrainsAsync(withIntMeet, railway, start, end);
+    future.waitForFinished();
+    return mergeDiagnosis(future);
+}
+
+namespace {
+    /**
+     * QtConcurrent::mapped使用的函数对象：单车次诊断
+     */
+    struct DiagnoseTrainFunctor {
+        using result_type = DiagnosisList;
+        const Diagram* diagram;
+        bool withIntMeet;
+        std::shared_ptr<Railway> railway;
+        std::shared_ptr<RailStation> start, end;
+
+        DiagnosisList operator()(const std::shared_ptr<Train>& train)const {
+            return diagram->diagnoseTrain(*train, withIntMeet, railway, start, end);
+        }
+    };
+}
+
+QFuture<DiagnosisList> Diagram::diagnoseAllTrainsAsync(bool withIntMeet,
+    std::shared_ptr<Railway> railway, std::shared_ptr<RailStation> start,
+    std::shared_ptr<RailStation> end) const
+{
+    // 工作线程中只读索引，因此这里先全部建好
+    if (railway) {
+        lineIndexFor(railway);
+    }
+    else {
+        foreach(const auto& r, railways()) {
+            lineIndexFor(r);
+        }
+    }
+    return QtConcurrent::mapped(_trainCollection.trains(),
+        DiagnoseTrainFunctor{ this, withIntMeet, railway, start, end });
+}
+
+DiagnosisList Diagram::mergeDiagnosis(const QFuture<DiagnosisList>& future)
 {
     DiagnosisList res;
-    foreach(auto t, _trainCollection.trains()) {
-        res.append(diagnoseTrain(*t, withIntMeet, railway, start, end));
+    for (int i = 0; i < future.resultCount(); i++) {
+        res.append(future.resultAt(i));
     }
     return res;
 }
 
+std::shared_ptr<const TrainLineIndex>
+    Diagram::lineIndexFor(std::shared_ptr<const Railway> railway) const
+{
+    // 已有的只做查找，不修改映射表，以便并行诊断时在工作线程中调用
+    if (auto itr = _lineIndexes.find(railway); itr != _lineIndexes.end()) {
+        return itr->second;
+    }
+    auto index = std::make_shared<TrainLineIndex>(_trainCollection, railway);
+    _lineIndexes.emplace(railway, index);
+    return index;
+}
+
+void Diagram::invalidateTempData()
+{
+    _lineIndexes.clear();
+}
+
+void Diagram::invalidateEventAxisForTrain(const Train& train)
+{
+    for (auto& [rail, cache] : _eventAxes) {
+        foreach(auto adp, train.adapters()) {
+            if (!adp->isInSameRailway(rail))
+                continue;
+            foreach(auto line, adp->lines()) {
+                if (cache->lines.erase(line)) {
+                    cache->axis.removeLine(line);
+                }
+            }
+        }
+    }
+}
+
+void Diagram::invalidateAllTempData()
+{
+    invalidateTempData();
+    _eventAxes.clear();
+}
+
 std::shared_ptr<DiagramPage> Diagram::createDefaultPage()
 {
     auto t = std::make_shared<DiagramPage>(_config, railways(),
@@ -212,6 +315,7 @@ void Diagram::removeRailwayAt(int i)
     foreach (auto p , _trainCollection.trains()) {
         p->unbindToRailway(rail);
     }
+    invalidateAllTempData();
 }
 
 void Diagram::removeRailwayAtU(int i)
@@ -221,16 +325,221 @@ void Diagram::removeRailwayAtU(int i)
     foreach(auto p, _trainCollection.trains()) {
         p->unbindToRailway(rail);
     }
+    invalidateAllTempData();
 }
 
 void Diagram::rebindAllTrains()
 {
-    foreach (auto t , _trainCollection.trains()) {
-        t->clearBoundRailways();
-        foreach (auto p , railways()) {
-            t->bindToRailway(p, _config);
+    auto future = bindAllTrainsAsync();
+    future.waitForFinished();
+    commitBinding(future);
+}
+
+namespace {
+    /**
+     * QtConcurrent::mapped使用的函数对象：单车次与所有线路的绑定。
+     * 与Train::bindToRailway一致，空的Adapter不保留。
+     */
+    struct BindTrainFunctor {
+        using result_type = Diagram::TrainAdapterList;
+        QList<std::shared_ptr<Railway>> railways;
+        const Config* config;
+
+        Diagram::TrainAdapterList operator()(const std::shared_ptr<Train>& train)const {
+            Diagram::TrainAdapterList res;
+            foreach(const auto & rail, railways) {
+                auto adp = std::make_shared<TrainAdapter>(train, rail, *config);
+                if (!adp->isNull())
+                    res.append(std::move(adp));
+            }
+            return res;
         }
+    };
+}
+
+QFuture<Diagram::TrainAdapterList> Diagram::bindAllTrainsAsync() const
+{
+    return QtConcurrent::mapped(_trainCollection.trains(),
+        BindTrainFunctor{ railways(), &_config });
+}
+
+bool Diagram::commitBinding(const QFuture<TrainAdapterList>& future)
+{
+    const auto& trains = _trainCollection.trains();
+    if (future.isCanceled() || future.resultCount() != trains.size()) {
+        qDebug() << "Diagram::commitBinding: WARNING: binding canceled or incomplete, "
+            << future.resultCount() << "/" << trains.size();
+        return false;
+    }
+    for (int i = 0; i < trains.size(); i++) {
+        trains.at(i)->setBoundRailways(future.resultAt(i));
+    }
+    invalidateAllTempData();
+    return true;
+}
+
+struct Diagram::SnapshotCache {
+    QByteArray fingerprint;
+
+    /**
+     * 与本图线路一一对应的副本
+     */
+    QList<std::shared_ptr<Railway>> railways;
+
+    struct TrainEntry {
+        std::weak_ptr<const Train> source;
+        std::shared_ptr<Train> clone;
+    };
+
+    /**
+     * 原车次 -> 副本。以地址为键，用source确认仍是同一对象
+     */
+    std::unordered_map<const Train*, TrainEntry> trains;
+};
+
+namespace {
+    /**
+     * 车次副本clone的内容是否仍与原车次src一致。
+     * 绑定由线路和参数决定，不在此比较；运行线的显示状态需比较。
+     */
+    bool snapshotTrainUnchanged(const Train& src, const Train& clone)
+    {
+        if (!(src.trainName() == clone.trainName()) || src.starting() != clone.starting() ||
+            src.terminal() != clone.terminal() || src.type() != clone.type() ||
+            src.passenger() != clone.passenger() || src.isShow() != clone.isShow() ||
+            src.autoPen() != clone.autoPen() || (!src.autoPen() && src.pen() != clone.pen()) ||
+            !src.timetableSame(clone))
+            return false;
+        const auto& adps1 = src.adapters(), & adps2 = clone.adapters();
+        if (adps1.size() != adps2.size())
+            return false;
+        for (int i = 0; i < adps1.size(); i++) {
+            const auto& lines1 = adps1.at(i)->lines(), & lines2 = adps2.at(i)->lines();
+            if (!std::equal(lines1.begin(), lines1.end(), lines2.begin(), lines2.end(),
+                [](const auto& p, const auto& q) {return p->show() == q->show(); }))
+                return false;
+        }
+        return true;
     }
+
+    /**
+     * 新绑定的副本，运行线显示状态按原车次设置
+     */
+    void copyLinesShow(const Train& src, Train& clone)
+    {
+        const auto& adps1 = src.adapters(), & adps2 = clone.adapters();
+        if (adps1.size() != adps2.size())
+            return;
+        for (int i = 0; i < adps1.size(); i++) {
+            const auto& lines1 = adps1.at(i)->lines(), & lines2 = adps2.at(i)->lines();
+            if (lines1.size() != lines2.size())
+                continue;
+            for (int j = 0; j < lines1.size(); j++) {
+                if (lines1.at(j)->show() != lines2.at(j)->show())
+                    lines2.at(j)->setIsShow(lines1.at(j)->show());
+            }
+        }
+    }
+}
+
+QByteArray Diagram::snapshotFingerprint() const
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(QJsonDocument(_config.toJson()).toJson(QJsonDocument::Compact));
+    foreach(const auto & rail, railways()) {
+        hash.addData(QJsonDocument(rail->toJson()).toJson(QJsonDocument::Compact));
+        // 排图标尺及纵坐标系数不在线路的JSON中
+        hash.addData(QByteArray::number(rail->ordinateIndex()));
+        foreach(const auto & st, rail->stations()) {
+            hash.addData(";");
+            if (st->y_coeff.has_value())
+                hash.addData(QByteArray::number(st->y_coeff.value(), 'g', 17));
+        }
+    }
+    return hash.result();
+}
+
+std::shared_ptr<const Diagram> Diagram::snapshot() const
+{
+    if (!_snapshotCache)
+        _snapshotCache = std::make_shared<SnapshotCache>();
+    auto& cache = *_snapshotCache;
+
+    if (QByteArray fp = snapshotFingerprint(); fp != cache.fingerprint) {
+        cache.fingerprint = fp;
+        cache.railways.clear();
+        cache.trains.clear();
+        foreach(const auto & src, railways()) {
+            auto rail = std::make_shared<Railway>();
+            *rail = *src;
+            if (int i = src->ordinateIndex(); i >= 0)
+                rail->setOrdinate(rail->getRuler(i));
+            cache.railways.append(rail);
+        }
+    }
+
+    auto snap = std::make_shared<Diagram>();
+    snap->_config = _config;
+    snap->_filename = _filename;
+    snap->_version = _version;
+    snap->_note = _note;
+    snap->_releaseCode = _releaseCode;
+    snap->railways() = cache.railways;
+
+    decltype(cache.trains) trains;
+    trains.reserve(_trainCollection.trains().size());
+    using fresh_t = std::pair<std::shared_ptr<const Train>, std::shared_ptr<Train>>;
+    QVector<fresh_t> fresh;
+    foreach(const auto & train, _trainCollection.trains()) {
+        std::shared_ptr<Train> clone;
+        if (auto itr = cache.trains.find(train.get()); itr != cache.trains.end() &&
+            itr->second.source.lock() == train &&
+            snapshotTrainUnchanged(*train, *itr->second.clone)) {
+            clone = itr->second.clone;
+        }
+        else {
+            clone = std::make_shared<Train>(*train);
+            fresh.append(std::make_pair(train, clone));
+        }
+        trains.emplace(train.get(), SnapshotCache::TrainEntry{ train, clone });
+        snap->_trainCollection.appendTrain(clone);
+    }
+    // 已删除车次的副本不再保留
+    cache.trains = std::move(trains);
+
+    BindTrainFunctor bind{ snap->railways(), &snap->_config };
+    QtConcurrent::blockingMap(fresh, [&bind](const fresh_t& p) {
+        p.second->setBoundRailways(bind(p.second));
+        copyLinesShow(*p.first, *p.second);
+        });
+    return snap;
+}
+
+std::shared_ptr<Railway> Diagram::railwayInSnapshot(const Diagram& snap, const Railway& railway) const
+{
+    for (int i = 0; i < railways().size() && i < snap.railways().size(); i++) {
+        if (railways().at(i).get() == &railway)
+            return snap.railways().at(i);
+    }
+    return nullptr;
+}
+
+QList<std::shared_ptr<Train>> Diagram::trainsInSnapshot(const Diagram& snap,
+    const QList<std::shared_ptr<Train>>& trains) const
+{
+    const auto& src = _trainCollection.trains();
+    const auto& clones = snap._trainCollection.trains();
+    QHash<const Train*, int> index;
+    for (int i = 0; i < src.size() && i < clones.size(); i++) {
+        index.insert(src.at(i).get(), i);
+    }
+    QList<std::shared_ptr<Train>> res;
+    res.reserve(trains.size());
+    foreach(const auto & train, trains) {
+        if (auto itr = index.find(train.get()); itr != index.end())
+            res.append(clones.at(itr.value()));
+    }
+    return res;
 }
 
 void Diagram::undoImportRailway()
@@ -239,6 +548,7 @@ void Diagram::undoImportRailway()
     foreach(auto p, _trainCollection.trains()) {
         p->unbindToRailway(t);
     }
+    invalidateAllTempData();
 }
 
 std::map<std::shared_ptr<RailInterval>, int> Diagram::sectionTrainCount(std::shared_ptr<Railway> railway) const
@@ -332,23 +642,148 @@ RailStationEventList
 std::map<std::shared_ptr<RailStation>, RailStationEventList>
     Diagram::stationEventsForRail(std::shared_ptr<Railway> railway)const
 {
+    auto buckets = stationEventBuckets(railway);
+    using PR = RailStationEventList::value_type;
+    QtConcurrent::blockingMap(buckets, [](StationEventBucket& bucket) {
+        std::sort(bucket.second.begin(), bucket.second.end(), [](const PR& p1, const PR& p2) {
+            return p1->time < p2->time;
+            });
+        });
+
     std::map<std::shared_ptr<RailStation>, RailStationEventList> res;
-    foreach(auto p, qAsConst(railway->stations())) {
-        if (p->direction != PassedDirection::NoVia) {
-            res.emplace(p, stationEvents(railway, p));
-        }
+    for (auto& p : buckets) {
+        res.emplace(p.first, std::move(p.second));
     }
     return res;
 }
 
 RailwayStationEventAxis Diagram::stationEventAxisForRail(std::shared_ptr<Railway> railway) const
 {
+    auto buckets = stationEventBuckets(railway);
+    // buildAxis中已经包含排序
+    QtConcurrent::blockingMap(buckets, [](StationEventBucket& bucket) {
+        bucket.second.buildAxis();
+        });
+
     RailwayStationEventAxis res;
+    for (auto& p : buckets) {
+        res.emplace(p.first, std::move(p.second));
+    }
+    return res;
+}
+
+std::shared_ptr<const RailwayStationEventAxis>
+    Diagram::stationEventAxisCached(std::shared_ptr<Railway> railway) const
+{
+    auto& cache = _eventAxes[railway];
+    if (!cache) {
+        cache = std::make_shared<EventAxisCache>();
+        cache->axis = stationEventAxisForRail(railway);
+        cache->lines = railwayLines(railway);
+    }
+    else {
+        syncEventAxis(*cache, railway);
+    }
+    return std::shared_ptr<const RailwayStationEventAxis>(cache, &(cache->axis));
+}
+
+std::set<std::shared_ptr<const TrainLine>>
+    Diagram::railwayLines(std::shared_ptr<const Railway> railway) const
+{
+    std::set<std::shared_ptr<const TrainLine>> res;
+    foreach(auto train, _trainCollection.trains()) {
+        foreach(auto adp, train->adapters()) {
+            if (adp->isInSameRailway(railway)) {
+                foreach(auto line, adp->lines()) {
+                    if (!line->isNull())
+                        res.insert(line);
+                }
+            }
+        }
+    }
+    return res;
+}
+
+void Diagram::syncEventAxis(EventAxisCache& cache, std::shared_ptr<const Railway> railway) const
+{
+    auto cur = railwayLines(railway);
+    std::vector<std::shared_ptr<const TrainLine>> removed, added;
+    std::set_difference(cache.lines.begin(), cache.lines.end(), cur.begin(), cur.end(),
+        std::back_inserter(removed));
+    std::set_difference(cur.begin(), cur.end(), cache.lines.begin(), cache.lines.end(),
+        std::back_inserter(added));
+    for (const auto& line : removed) {
+        cache.axis.removeLine(line);
+    }
+    for (const auto& line : added) {
+        cache.axis.insertLine(line);
+    }
+    cache.lines = std::move(cur);
+}
+
+void Diagram::updateEventAxisForTrain(EventAxisCache& cache,
+    std::shared_ptr<const TrainAdapter> oldAdp, std::shared_ptr<const TrainAdapter> newAdp)
+{
+    bool tracked = false;
+    if (oldAdp) {
+        foreach(auto line, oldAdp->lines()) {
+            if (cache.lines.erase(line)) {
+                cache.axis.removeLine(line);
+                tracked = true;
+            }
+        }
+    }
+    if (tracked && newAdp) {
+        foreach(auto line, newAdp->lines()) {
+            if (!line->isNull()) {
+                cache.axis.insertLine(line);
+                cache.lines.insert(line);
+            }
+        }
+    }
+}
+
+std::vector<Diagram::StationEventBucket>
+    Diagram::stationEventBuckets(std::shared_ptr<Railway> railway) const
+{
+    std::vector<StationEventBucket> res;
     foreach(auto p, qAsConst(railway->stations())) {
-        if (p->direction != PassedDirection::NoVia) {
-            StationEventAxis staxis=stationEvents(railway,p);
-            staxis.buildAxis();
-            res.emplace(p, std::move(staxis));
+        if (p->direction != PassedDirection::NoVia && p->y_coeff.has_value()) {
+            res.emplace_back(p, StationEventAxis{});
+        }
+    }
+    // 按y坐标排序，以便对每条运行线二分查找其覆盖的车站范围
+    std::stable_sort(res.begin(), res.end(),
+        [](const StationEventBucket& b1, const StationEventBucket& b2) {
+            return b1.first->y_coeff.value() < b2.first->y_coeff.value();
+        });
+    auto lower = [](const StationEventBucket& b, double y) {
+        return b.first->y_coeff.value() < y;
+    };
+    auto upper = [](double y, const StationEventBucket& b) {
+        return y < b.first->y_coeff.value();
+    };
+
+    // 运行线范围以外的车站，stationEventFromRail必定为空，因此只查范围以内的。
+    // 逐列车、逐运行线的遍历次序与stationEvents一致，从而排序后的结果也一致。
+    foreach(auto train, _trainCollection.trains()) {
+        foreach(auto adp, train->adapters()) {
+            if (!adp->isInSameRailway(railway))
+                continue;
+            foreach(auto line, adp->lines()) {
+                if (line->isNull())
+                    continue;
+                double y1 = line->firstRailStation()->y_coeff.value(),
+                    y2 = line->lastRailStation()->y_coeff.value();
+                auto first = std::lower_bound(res.begin(), res.end(), std::min(y1, y2), lower);
+                auto last = std::upper_bound(first, res.end(), std::max(y1, y2), upper);
+                for (auto p = first; p != last; ++p) {
+                    const auto& lst = line->stationEventFromRail(p->first);
+                    for (auto q = lst.begin(); q != lst.end(); ++q) {
+                        p->second.push_back(*q);
+                    }
+                }
+            }
         }
     }
     return res;
@@ -726,49 +1161,102 @@ ReadRulerReport Diagram::rulerFromMultiTrains(std::shared_ptr<Railway> railway,
     const QVector<std::shared_ptr<RailInterval>> intervals,
     const QList<std::shared_ptr<Train>> trains,
     bool useAverage, int defaultStart, int defaultStop, 
-    int cutStd, int cutSec, int prec, int cutCount)
+    int cutStd, int cutSec, int prec, int cutCount, const TaskContext& ctx) const
+{
+    auto res = readRulerSamples(railway, intervals, trains, ctx);
+    if (ctx.isCanceled())
+        return {};
+    rulerFromSamples(res, useAverage, defaultStart, defaultStop, cutStd, cutSec, prec, cutCount);
+    return res;
+}
+
+ReadRulerReport Diagram::readRulerSamples(std::shared_ptr<Railway> railway,
+    const QVector<std::shared_ptr<RailInterval>>& intervals,
+    const QList<std::shared_ptr<Train>>& trains, const TaskContext& ctx) const
 {
     ReadRulerReport res;
     //先直接把要计算的区间都加进去，免得多搞个set
     foreach(auto p, intervals) {
         res.insert({ p,{} });
     }
-    decltype(res.begin()) itr;
 
+    // 按(发站, 到站, 方向)的非拥有指针查找要计算的区间的编号，
+    // 逐站遍历时直接比较AdapterStation::station，不再lock()车站、复制区间指针
+    std::vector<readruler::IntervalReport*> reports;
+    std::map<std::tuple<const RailStation*, const RailStation*, Direction>, int> lookup;
+    for (auto itr = res.begin(); itr != res.end(); ++itr) {
+        const auto& it = itr->first;
+        lookup.emplace(std::make_tuple(it->fromStation().get(), it->toStation().get(),
+            it->direction()), static_cast<int>(reports.size()));
+        reports.push_back(&itr->second);
+    }
+
+    // 各车次的样本：(区间编号, 秒数, 附加类型)，按车次并行采集
+    struct TrainSamples {
+        std::shared_ptr<Train> train;
+        std::vector<std::tuple<int, int, TrainLine::IntervalAttachType>> samples;
+    };
+    QVector<TrainSamples> jobs;
+    jobs.reserve(trains.size());
     foreach(auto train, trains) {
-        auto adp = train->adapterFor(*railway);
-        if (!adp)continue;
-        foreach(auto line, adp->lines()) {
+        jobs.append({ train, {} });
+    }
+
+    ctx.setProgressRange(0, jobs.size());
+    std::atomic_int done{ 0 };
+    const int n = static_cast<int>(reports.size());
+    QtConcurrent::blockingMap(jobs, [&railway, &lookup, &ctx, &done, n](TrainSamples& job) {
+        if (ctx.isCanceled())
+            return;
+        ctx.setProgressValue(++done);
+        auto adp = job.train->adapterFor(*railway);
+        if (!adp)return;
+        std::vector<bool> seen(n, false);
+        for (const auto& line : adp->lines()) {
             if (line->count() < 2)continue;
             auto pr = line->stations().begin();
             for (auto p = std::next(pr); p != line->stations().end(); pr = p, ++p) {
-                if (pr->railStation.lock()->dirAdjacent(line->dir()) ==
-                    p->railStation.lock()) {
-                    // pr->p是合法的区间
-                    auto it = pr->railStation.lock()->dirNextInterval(line->dir());
-                    if ((itr = res.find(it)) != res.end()) {
-                        //此区间是要计算的区间
-                        int secs = qeutil::secsTo(pr->trainStation->depart,
-                            p->trainStation->arrive);
-                        auto att = line->getIntervalAttachType(pr, p);
-                        itr->second.raw.emplace(train, std::make_pair(secs, att));
-                    }
+                // pr->p是合法的、要计算的区间；同一车次只取第一次
+                auto itr = lookup.find(std::make_tuple(pr->station, p->station, line->dir()));
+                if (itr != lookup.end() && !seen[itr->second]) {
+                    seen[itr->second] = true;
+                    int secs = qeutil::secsTo(pr->trainStation->depart,
+                        p->trainStation->arrive);
+                    job.samples.emplace_back(itr->second, secs, line->getIntervalAttachType(pr, p));
                 }
             }
         }
+        });
+    if (ctx.isCanceled())
+        return {};
+
+    for (const auto& job : jobs) {
+        for (const auto& [i, secs, att] : job.samples) {
+            reports[i]->raw.push_back({ job.train, secs, att });
+        }
     }
+    return res;
+}
 
-    for (auto p = res.begin(); p != res.end(); ++p) {
-        __intervalFt(p->second);
+void Diagram::rulerFromSamples(ReadRulerReport& report, bool useAverage,
+    int defaultStart, int defaultStop, int cutStd, int cutSec, int prec, int cutCount)
+{
+    // 各区间的统计、计算相互独立
+    QVector<readruler::IntervalReport*> reports;
+    reports.reserve(static_cast<int>(report.size()));
+    for (auto p = report.begin(); p != report.end(); ++p) {
+        reports.append(&p->second);
+    }
+    QtConcurrent::blockingMap(reports, [=](readruler::IntervalReport* rep) {
+        __intervalFt(*rep);
         if (useAverage) {
-            __intervalRulerMean(p->second, defaultStart, defaultStop, 
+            __intervalRulerMean(*rep, defaultStart, defaultStop,
                 prec, cutStd, cutSec, cutCount);
         }
         else {
-            __intervalRulerMode(p->second, defaultStart, defaultStop, prec, cutCount);
+            __intervalRulerMode(*rep, defaultStart, defaultStop, prec, cutCount);
         }
-    }
-    return res;
+        });
 }
 
 QVector<int> Diagram::pageIndexWithRail(std::shared_ptr<const Railway> railway)const
@@ -784,11 +1272,8 @@ QVector<int> Diagram::pageIndexWithRail(std::shared_ptr<const Railway> railway)c
 
 void Diagram::bindAllTrains()
 {
-    foreach (auto p , railways()) {
-        foreach (auto t , _trainCollection.trains()) {
-            t->bindToRailway(p, _config);
-        }
-    }
+    // 读入时各车次尚无绑定，与重新绑定等价；按车次并行，Adapter顺序仍与线路顺序一致
+    rebindAllTrains();
 }
 
 QString Diagram::validPageName(const QString& prefix) const
@@ -1008,8 +1493,9 @@ bool Diagram::fromTrc(QTextStream& fin)
 
 void Diagram::__intervalFt(readruler::IntervalReport& itrep)
 {
-    for (auto p = itrep.raw.begin(); p != itrep.raw.end(); ++p) {
-        itrep.types[p->second.second].count[p->second.first]++;
+    itrep.types.clear();
+    for (const auto& sample : itrep.raw) {
+        itrep.types[sample.attach].count[sample.secs]++;
     }
 }
 
@@ -1268,8 +1754,8 @@ std::shared_ptr<const RailStationEvent> Diagram::findLastEvent(
 int readruler::IntervalReport::satisfiedCount()const
 {
     int cnt = 0;
-    for (auto p=raw.begin();p!=raw.end();++p) {
-        if (p->second.first == stdInterval(p->second.second))
+    for (const auto& sample : raw) {
+        if (sample.secs == stdInterval(sample.attach))
             cnt++;
     }
     return cnt;
@@ -1319,7 +1805,7 @@ bool Diagram::readDefaultConfigs(const QString& filename)
     return true;
 }
 
-bool Diagram::fromJson(const QString& filename)
+bool Diagram::fromJson(const QString& filename, bool bindTrains)
 {
     QFile f(filename);
     f.open(QFile::ReadOnly);
@@ -1327,14 +1813,28 @@ bool Diagram::fromJson(const QString& filename)
         qDebug() << "Diagram::fromJson: ERROR: open file " << filename << " failed. " << Qt::endl;
         return false;
     }
-    auto contents = f.readAll();
-    QJsonDocument doc = QJsonDocument::fromJson(contents);
-    bool flag = fromJson(doc.object());
+    //2026.10  文件映射到内存后流式读取：车次数组逐个车次解析，其余部分照常解析
+    const QByteArray& contents = JsonStreamReader::mapFile(f);
+    bool ok = false, flag;
+    const bool binary = qebinary::isBinaryDiagram(contents);
+    if (binary) {
+        //2026.10  二进制格式：直接在映射的数据上解码，无需文本解析；车次直接构造
+        const QJsonObject& obj = qebinary::decode(contents, &ok, {}, { "trains" });
+        if (!ok) {
+            qDebug() << "Diagram::fromJson: ERROR: corrupt binary file " << filename << Qt::endl;
+        }
+        flag = ok && fromJson(obj, &contents, bindTrains, true);
+    }
+    else {
+        QByteArray rawTrains;
+        const QJsonObject& obj = JsonStreamReader::readObjectExcept(contents, "trains", rawTrains, &ok);
+        flag = ok && fromJson(obj, &rawTrains, bindTrains);
+    }
     if (flag)
         _filename = filename;
 
     //2021.08.18：增加从trc读取的算法
-    if (!flag) {
+    if (!flag && !binary) {
         f.seek(0);
         QTextStream fin(&f);
         flag = fromTrc(fin);
@@ -1344,14 +1844,30 @@ bool Diagram::fromJson(const QString& filename)
     return flag;
 }
 
-bool Diagram::fromJson(const QJsonObject& obj)
+bool Diagram::fromJson(const QJsonObject& obj, bool bindTrains)
+{
+    return fromJson(obj, nullptr, bindTrains);
+}
+
+bool Diagram::fromJson(const QJsonObject& obj, const QByteArray* rawTrains, bool bindTrains,
+    bool binary)
 {
-    if (obj.empty())
+    if (obj.empty() && (!rawTrains || rawTrains->isEmpty()))
         return false;
     railways().clear();
 
     //车次和Config直接转发即可
-    _trainCollection.fromJson(obj, _defaultManager);
+    if (rawTrains) {
+        const bool trainsOk = binary ? _trainCollection.fromBinary(obj, *rawTrains, _defaultManager) :
+            _trainCollection.fromJson(obj, *rawTrains, _defaultManager);
+        if (!trainsOk) {
+            //2026.10  车次数据损坏时整体失败，不读入残缺的运行图
+            qDebug() << "Diagram::fromJson: ERROR: malformed trains, load aborted" << Qt::endl;
+            return false;
+        }
+    }
+    else
+        _trainCollection.fromJson(obj, _defaultManager);
     bool flag = _config.fromJson(obj.value("config").toObject());
     if (!flag) {
         //缺配置信息，使用默认值
@@ -1386,7 +1902,8 @@ bool Diagram::fromJson(const QJsonObject& obj)
         _pages.append(std::make_shared<DiagramPage>(p->toObject(), *this));
     }
 
-    bindAllTrains();
+    if (bindTrains)
+        bindAllTrains();
     return true;
 }
 
@@ -1549,8 +2066,13 @@ bool Diagram::save() const
             << Qt::endl;
         return false;
     }
-    QJsonDocument doc(toJson());
-    file.write(doc.toJson());
+    if (QFileInfo(_filename).suffix().compare(qebinary::fileSuffix, Qt::CaseInsensitive) == 0) {
+        file.write(qebinary::encode(toJson()));
+    }
+    else {
+        QJsonDocument doc(toJson());
+        file.write(doc.toJson());
+    }
     file.close();
     return true;
 }
@@ -1563,6 +2085,8 @@ void Diagram::clear()
     _config = _defaultConfig;
     _note = "";
     _version = "";
+    _snapshotCache.reset();
+    invalidateAllTempData();
 }
 
 
@@ -1,9 +1,12 @@
 ﻿#pragma once
 
 #include <memory>
+#include <set>
 #include <QList>
 #include <QString>
+#include <QFuture>
 #include "config.h"
+#include "data/common/backgroundtask.h"
 #include "data/train/traincollection.h"
 #include "traingap.h"
 #include "data/diagram/trainline.h"    // for: alias
@@ -14,6 +17,8 @@ class Train;
 class Railway;
 struct TrainGap;
 class TrainFilterCore;
+class TrainLineIndex;
+class TrainAdapter;
 
 
 class DiagramPage;
@@ -32,14 +37,23 @@ namespace readruler {
         double value;   // 本类计算结果
     };
 
+    /**
+     * 2026.10  一个车次在一个区间的运行数据（样本）
+     */
+    struct Sample {
+        std::shared_ptr<Train> train;
+        int secs;
+        TrainLine::IntervalAttachType attach;
+    };
+
     /**
      * 标尺综合的返回值类型中属于每个区间的数据部分
      * 与pyETRC基本一致
-     *
+     * 2026.10  raw改为按车次顺序的平面表，每个车次至多一条（取最先经过的一次）。
      */
     struct IntervalReport {
         int interval = 0, start = 0, stop = 0;
-        std::map<std::shared_ptr<Train>, std::pair<int, TrainLine::IntervalAttachType>> raw;
+        std::vector<Sample> raw;
         std::map<TrainLine::IntervalAttachType, IntervalTypeReport> types;
         bool isValid()const { return interval || start || stop; }
 
@@ -74,6 +88,27 @@ class Diagram
     TypeManager _defaultManager;
     QList<std::shared_ptr<DiagramPage>> _pages;
 
+    /**
+     * 各线路的运行线索引，按需构建。数据变化时由invalidateTempData()清空。
+     */
+    mutable std::map<std::shared_ptr<const Railway>, std::shared_ptr<TrainLineIndex>> _lineIndexes;
+
+    /**
+     * 各线路车站事件表的缓存，以及生成事件表所用的运行线集合。
+     * 列车重新绑定时增量更新，而不是重新生成。
+     */
+    struct EventAxisCache {
+        RailwayStationEventAxis axis;
+        std::set<std::shared_ptr<const TrainLine>> lines;
+    };
+    mutable std::map<std::shared_ptr<const Railway>, std::shared_ptr<EventAxisCache>> _eventAxes;
+
+    /**
+     * 2026.10  快照的复用数据：线路副本及各车次的副本，见snapshot()。
+     */
+    struct SnapshotCache;
+    mutable std::shared_ptr<SnapshotCache> _snapshotCache;
+
 public:
     Diagram() = default;
 
@@ -105,16 +140,18 @@ public:
 
     /**
      * @brief fromJson  清空既有数据，从文件读取，同时保存文件名
+     * bindTrains: 见下
      */
-    bool fromJson(const QString& filename);
+    bool fromJson(const QString& filename, bool bindTrains = true);
 
     
 
     /**
      * @brief fromJson  读入数据后绑定车次和线路
      * 返回是否成功 （如果为空则失败）
+     * 2026.10  bindTrains=false时不绑定，由调用方通过bindAllTrainsAsync()异步绑定
      */
-    bool fromJson(const QJsonObject& obj);
+    bool fromJson(const QJsonObject& obj, bool bindTrains = true);
     QJsonObject toJson()const;
 
     /**
@@ -231,10 +268,72 @@ public:
         std::shared_ptr<Railway> railway, std::shared_ptr<RailStation> start,
         std::shared_ptr<RailStation> end)const;
 
+    /**
+     * 所有车次的诊断。2026.10起并行执行，结果按列车集合顺序合并，与逐车次计算一致。
+     */
     DiagnosisList diagnoseAllTrains(bool withIntMeet,
         std::shared_ptr<Railway> railway, std::shared_ptr<RailStation> start,
         std::shared_ptr<RailStation> end)const;
 
+    /**
+     * 2026.10  异步、并行的全图诊断。
+     * 按车次划分任务，交由全局线程池执行；返回的QFuture以车次数为进度范围，支持取消。
+     * 每个结果对应一个车次，顺序与列车集合一致，使用mergeDiagnosis合并。
+     * 调用前构建所需的运行线索引；执行期间不得修改运行图数据。
+     */
+    QFuture<DiagnosisList> diagnoseAllTrainsAsync(bool withIntMeet,
+        std::shared_ptr<Railway> railway, std::shared_ptr<RailStation> start,
+        std::shared_ptr<RailStation> end)const;
+
+    /**
+     * 按顺序合并diagnoseAllTrainsAsync的结果。
+     */
+    static DiagnosisList mergeDiagnosis(const QFuture<DiagnosisList>& future);
+
+    /**
+     * 指定线路的运行线索引（里程范围×时间窗口），用于事件表、诊断中筛选运行线对。
+     * 第一次使用时构建，之后缓存，直到invalidateTempData()。
+     */
+    std::shared_ptr<const TrainLineIndex>
+        lineIndexFor(std::shared_ptr<const Railway> railway)const;
+
+    /**
+     * 列车或线路数据变化（包括增删列车、修改时刻表、重新绑定等）后调用，
+     * 使得缓存的运行线索引等临时数据失效。
+     * 本类中的绑定操作会自动调用；直接操作TrainCollection的，需要手动调用。
+     * 车站事件表缓存是增量维护的，不在这里清除。
+     */
+    void invalidateTempData();
+
+    /**
+     * 2026.10  不经重新绑定、直接修改列车时刻表（如时刻微调）后调用：
+     * 运行线对象不变而事件时刻已变，增量比对发现不了，
+     * 因此从各线路的车站事件表缓存中删除该车次的运行线，下次使用时重新加入。
+     */
+    void invalidateEventAxisForTrain(const Train& train);
+
+    /**
+     * 2026.10  只读快照，供后台任务（对比、诊断、导出等）在一致的数据上计算，
+     * 而用户可以继续编辑本图。须在主线程调用；返回的对象此后不再修改，可在任意线程读取。
+     * 快照包含线路、参数以及全部车次（及其与线路的绑定），车次顺序与本图一致；
+     * 不包含运行图视图（Page）与交路，车次类型与本图共用。
+     *
+     * 结构共享：快照之间复用未变化的数据，写时复制。
+     * 线路与参数没有变化时，复用上一次的线路副本；
+     * 车次内容（车次、始发终到、类型、时刻表、显示状态等）没有变化的，复用上一次的车次副本
+     * 及其绑定，只复制、绑定（并行）有变化的车次。线路或参数变化时全部重新复制。
+     */
+    std::shared_ptr<const Diagram> snapshot()const;
+
+    /**
+     * 2026.10  本图的线路、车次在快照snap中对应的副本，按顺序对应。
+     * snap须是本图刚刚由snapshot()得到的，期间本图未修改；须在主线程调用。
+     * 找不到的线路返回空，找不到的车次略去。
+     */
+    std::shared_ptr<Railway> railwayInSnapshot(const Diagram& snap, const Railway& railway)const;
+    QList<std::shared_ptr<Train>> trainsInSnapshot(const Diagram& snap,
+        const QList<std::shared_ptr<Train>>& trains)const;
+
 
     /**
      * 创建默认的运行图视图，即按顺序包含本线的所有线路
@@ -290,9 +389,26 @@ public:
     /**
      * 更新参数（最大跨越站数）时执行
      * 重新绑定所有列车与所有线路
+     * 2026.10起按车次并行执行。
      */
     void rebindAllTrains();
 
+    using TrainAdapterList = QVector<std::shared_ptr<TrainAdapter>>;
+
+    /**
+     * 2026.10  异步、并行地计算所有车次与所有线路的绑定。
+     * 每个车次一个任务，在工作线程中按线路顺序构造该车次的全部Adapter，
+     * 不修改列车数据；返回的QFuture以车次数为进度范围，支持取消。
+     * 结果须由commitBinding()在主线程写回。执行期间不得修改列车或线路数据。
+     */
+    QFuture<TrainAdapterList> bindAllTrainsAsync()const;
+
+    /**
+     * 将bindAllTrainsAsync()的结果写回各车次，替换原有绑定。
+     * 如果任务已取消或结果不完整，不做任何修改，返回false。
+     */
+    bool commitBinding(const QFuture<TrainAdapterList>& future);
+
     /**
      * 2021.09.16  删除末尾的最后一条线路。保证没有关联的page之类的，
      * 但需要清除列车的绑定情况。
@@ -327,7 +443,8 @@ public:
 
     /**
      * 一次性获取所给线路的所有站事件表。
-     * 初版暂时是暴力调用`stationEvents`，但很明显这个可以优化。
+     * 2026.10 改为一次遍历所有运行线，将车站事件分配到各站，再并行排序。
+     * 结果与逐站调用`stationEvents`一致。
      */
     std::map<std::shared_ptr<RailStation>, RailStationEventList>
         stationEventsForRail(std::shared_ptr<Railway> railway)const;
@@ -341,6 +458,16 @@ public:
     RailwayStationEventAxis
         stationEventAxisForRail(std::shared_ptr<Railway> railway)const;
 
+    /**
+     * 2026.10
+     * 带缓存的stationEventAxisForRail，用于贪心排图、间隔分析等需要反复使用事件表的场合。
+     * 第一次调用时生成；此后`updateTrain`直接更新缓存，其他列车的增删、重新绑定
+     * 在下次调用时与列车集合比对，只对发生变化的运行线增删事件。
+     * 线路数据变化时整体失效。返回对象由本类维护，不应长期保存。
+     */
+    std::shared_ptr<const RailwayStationEventAxis>
+        stationEventAxisCached(std::shared_ptr<Railway> railway)const;
+
     /**
      * 2021.09.06
      * 基于车站事件表，转换成间隔表。
@@ -391,6 +518,7 @@ public:
      * @param cutSec  截断秒数
      * @param prec  精度/数据粒度
      * @param cutCount  最少类数据量
+     * @param ctx  2026.10  后台任务上下文：按车次报告进度，取消时返回空
      * @return  计算结果和相关的报告数据 详见类定义
      */
     ReadRulerReport rulerFromMultiTrains(
@@ -399,8 +527,28 @@ public:
             const QList<std::shared_ptr<Train>> trains,
             bool useAverage, int defaultStart, int defaultStop,
             int cutStd=1, int cutSec=10, int prec=1,
-            int cutCount=1
-            );
+            int cutCount=1, const TaskContext& ctx = {}
+            )const;
+
+    /**
+     * 2026.10  标尺综合第一步：采集各区间的样本（IntervalReport::raw），不做统计。
+     * 按车次并行遍历运行线，再按车次顺序归并到各区间。取消时返回空。
+     */
+    ReadRulerReport readRulerSamples(
+            std::shared_ptr<Railway> railway,
+            const QVector<std::shared_ptr<RailInterval>>& intervals,
+            const QList<std::shared_ptr<Train>>& trains,
+            const TaskContext& ctx = {}
+            )const;
+
+    /**
+     * 2026.10  标尺综合第二步：由已采集的样本计算各区间标尺，各区间并行。
+     * 每次都由raw重新统计，因此同一组样本可以按不同参数反复计算（如预览时调整截断参数）。
+     * 只使用所给样本，与本图数据无关。
+     */
+    static void rulerFromSamples(ReadRulerReport& report,
+            bool useAverage, int defaultStart, int defaultStop,
+            int cutStd=1, int cutSec=10, int prec=1, int cutCount=1);
 
     /**
      * 返回包含所给线路的Page的下标集合。
@@ -411,6 +559,53 @@ public:
 private:
     void bindAllTrains();
 
+    /**
+     * fromJson的实现。rawTrains非空时，车次由其（trains数组的JSON原文）流式读取，
+     * 否则从obj读取。
+     * 2026.10  binary为true时，rawTrains是整个二进制文件，车次由qebinary::decodeTrains直接构造。
+     */
+    bool fromJson(const QJsonObject& obj, const QByteArray* rawTrains, bool bindTrains,
+        bool binary = false);
+
+    using StationEventBucket = std::pair<std::shared_ptr<RailStation>, StationEventAxis>;
+
+    /**
+     * stationEventsForRail, stationEventAxisForRail的公共部分：
+     * 一次遍历本线所有运行线，将车站事件按车站分组，未排序。
+     * 结果按车站y坐标排序，只包含有y坐标且非不经由的车站。
+     */
+    std::vector<StationEventBucket>
+        stationEventBuckets(std::shared_ptr<Railway> railway)const;
+
+    /**
+     * 线路数据变化（增删线路、线路重新绑定），除invalidateTempData()以外，
+     * 还清除车站事件表缓存。
+     */
+    void invalidateAllTempData();
+
+    /**
+     * snapshot()所用：线路及参数的摘要，不同则不能复用线路副本。
+     */
+    QByteArray snapshotFingerprint()const;
+
+    /**
+     * 当前在指定线路上的所有（非空）运行线
+     */
+    std::set<std::shared_ptr<const TrainLine>>
+        railwayLines(std::shared_ptr<const Railway> railway)const;
+
+    /**
+     * 将缓存的车站事件表与当前列车集合同步：删除已不存在的运行线，加入新的运行线。
+     */
+    void syncEventAxis(EventAxisCache& cache, std::shared_ptr<const Railway> railway)const;
+
+    /**
+     * updateTrain中调用：用重新绑定后的新运行线替换原有运行线的事件。
+     * 仅当原有运行线在缓存中时才处理；否则留给syncEventAxis。
+     */
+    void updateEventAxisForTrain(EventAxisCache& cache, std::shared_ptr<const TrainAdapter> oldAdp,
+        std::shared_ptr<const TrainAdapter> newAdp);
+
     void sectionTrainCount(std::map<std::shared_ptr<RailInterval>, int>& res,
         std::shared_ptr<TrainLine> line)const;
 
@@ -419,26 +614,27 @@ private:
     /**
      * pyETRC.data.Graph.__intervalFt()  区间数据统计
      * 对四种起停附加情况，统计频数
+     * 2026.10  先清除原有的统计结果
      */
-    void __intervalFt(readruler::IntervalReport& itrep);
+    static void __intervalFt(readruler::IntervalReport& itrep);
 
     /**
      * 众数模式下的计算
      */
-    void __intervalRulerMode(readruler::IntervalReport& itrep, int defaultStart,
+    static void __intervalRulerMode(readruler::IntervalReport& itrep, int defaultStart,
         int defaultStop, int prec, int cutCount);
 
     /**
      * 均值模式下的计算
      * cutSec, cutStd皆用0表示不启用。
      */
-    void __intervalRulerMean(readruler::IntervalReport& itrep,
+    static void __intervalRulerMean(readruler::IntervalReport& itrep,
         int defaultStart, int defaultStop, int prec, int cutStd, int cutSec, int cutCount);
 
     /**
      * 解方程计算区间标尺。返回tuple，以避免修改。
      */
-    std::tuple<int, int, int>
+    static std::tuple<int, int, int>
         __computeIntervalRuler(const std::map<TrainLine::IntervalAttachType,double>& values,
             int defaultStart, int defaultStop, int prec);
 
@@ -1,7 +1,6 @@
 ﻿#include "diagrampage.h"
 #include "diagram.h"
 #include "trainadapter.h"
-#include "kernel/trainitem.h"
 
 
 DiagramPage::DiagramPage(const Config& config, const QList<std::shared_ptr<Railway> > &railways,
@@ -127,48 +126,16 @@ void DiagramPage::clearAllItems()
     _itemMap.clear();
 }
 
-void DiagramPage::highlightTrainItems(const Train& train)
+QList<TrainItem*> DiagramPage::trainItems(const Train& train) const
 {
+    QList<TrainItem*> res;
     for (auto adp : train.adapters()) {
         for (auto p : adp->lines()) {
-            if (_itemMap.contains(p.get())) {
-                _itemMap.value(p.get())->highlight();
-            }
-        }
-    }
-}
-
-void DiagramPage::unhighlightTrainItems(const Train& train)
-{
-    for (auto adp : train.adapters()) {
-        for (auto p : adp->lines()) {
-            if (_itemMap.contains(p.get())) {
-                _itemMap.value(p.get())->unhighlight();
-            }
-        }
-    }
-}
-
-void DiagramPage::highlightTrainItemsWithLink(const Train& train)
-{
-    for (auto adp : train.adapters()) {
-        for (auto p : adp->lines()) {
-            if (_itemMap.contains(p.get())) {
-                _itemMap.value(p.get())->highlightWithLink();
-            }
-        }
-    }
-}
-
-void DiagramPage::unhighlightTrainItemsWithLink(const Train& train)
-{
-    for (auto adp : train.adapters()) {
-        for (auto p : adp->lines()) {
-            if (_itemMap.contains(p.get())) {
-                _itemMap.value(p.get())->unhighlightWithLink();
-            }
+            if (auto* item = _itemMap.value(p.get(), nullptr))
+                res.append(item);
         }
     }
+    return res;
 }
 
 QList<QGraphicsRectItem*>& DiagramPage::dirForbidItem(const Forbid* forbid, Direction dir)
@@ -189,6 +156,7 @@ void DiagramPage::clearGraphics()
     _forbidUMap.clear();
     _belowLabels.clear();
     _overLabels.clear();
+    clearDirty();
 }
 
 bool DiagramPage::containsRailway(std::shared_ptr<const Railway> rail) const
@@ -229,6 +197,8 @@ void DiagramPage::swap(DiagramPage& other)
     _SWAP(_forbidUMap);
     _SWAP(_overLabels);
     _SWAP(_belowLabels);
+    _SWAP(_dirty);
+    _SWAP(_dirtyTrains);
 }
 
 
@@ -259,3 +229,45 @@ std::shared_ptr<DiagramPage> DiagramPage::clone() const
     auto page = std::make_shared<DiagramPage>(config(), _railways, _name, _note);
     return page;
 }
+
+void DiagramPage::clearDirty()
+{
+    _dirty = NotDirty;
+    _dirtyTrains.clear();
+}
+
+DiagramPage::DirtyFlags DiagramPage::configDirtyFlags(const Config& oldcfg, const Config& newcfg)
+{
+#define _CHANGED(_key) (oldcfg._key != newcfg._key)
+    DirtyFlags flags = NotDirty;
+    // 改变图幅几何：坐标全部失效
+    if (_CHANGED(seconds_per_pix) || _CHANGED(seconds_per_pix_y) || _CHANGED(pixels_per_km) ||
+        _CHANGED(start_hour) || _CHANGED(end_hour) || _CHANGED(show_ruler_bar) ||
+        _CHANGED(show_mile_bar) || _CHANGED(show_count_bar) ||
+        oldcfg.margins.toJson() != newcfg.margins.toJson()) {
+        return DirtyLayout;
+    }
+    // 只涉及底图样式
+    if (_CHANGED(grid_color) || _CHANGED(text_color) || _CHANGED(default_grid_width) ||
+        _CHANGED(bold_grid_width) || _CHANGED(bold_line_level) ||
+        _CHANGED(minutes_per_vertical_line) || _CHANGED(minute_mark_gap_pix)) {
+        flags |= DirtyGrid;
+    }
+    // 只涉及运行线及其标签、交路连线、不显示的类型
+    if (_CHANGED(show_line_in_station) || _CHANGED(start_label_height) ||
+        _CHANGED(end_label_height) || _CHANGED(show_full_train_name) ||
+        _CHANGED(show_time_mark) || _CHANGED(avoid_cover) || _CHANGED(base_label_height) ||
+        _CHANGED(step_label_height) || _CHANGED(valid_width) || _CHANGED(end_label_name) ||
+        _CHANGED(link_line_height) || _CHANGED(max_passed_stations) ||
+        _CHANGED(not_show_types)) {
+        flags |= DirtyTrains;
+    }
+    // 其余（auto_paint, default_db_file, table_row_height等）不影响图元
+    return flags;
+#undef _CHANGED
+}
+
+void DiagramPage::markConfigChanged(const Config& oldcfg, const Config& newcfg)
+{
+    markDirty(configDirtyFlags(oldcfg, newcfg));
+}
@@ -3,6 +3,8 @@
 #include <memory>
 #include <QList>
 #include <QHash>
+#include <QSet>
+#include <QFlags>
 
 
 #include "data/train/train.h"
@@ -69,6 +71,25 @@ class DiagramPage
     using label_map_t = std::multimap<double, LabelPositionInfo>;
     QHash<const RailStation*, label_map_t> _overLabels, _belowLabels;
 
+public:
+    /**
+     * 2026.10  图元的脏标记，用于DiagramWidget::updateGraph()增量更新。
+     * 只重建受影响的那部分图元，其余图元保持不动。
+     * 天窗没有单独的标记：天窗数据变化时由DiagramWidget::updateForbid()逐个更新，
+     * 几何变化时随DirtyLayout重新铺画。
+     */
+    enum DirtyFlag {
+        NotDirty = 0,
+        DirtyGrid = 0x1,      // 底图：时间线、站名线、表头等（几何不变，只是样式）
+        DirtyTrains = 0x2,    // 全部运行线
+        DirtyLayout = 0x8,    // 图幅几何变化，必须全部重新铺画
+    };
+    Q_DECLARE_FLAGS(DirtyFlags, DirtyFlag)
+
+private:
+    DirtyFlags _dirty = NotDirty;
+    QSet<std::shared_ptr<Train>> _dirtyTrains;
+
 public:
     DiagramPage(const Config& config, const QList<std::shared_ptr<Railway>>& railways,
         const QString& name, const QString& note = "");
@@ -138,12 +159,11 @@ public:
 
     void clearAllItems();
 
-    void highlightTrainItems(const Train& train);
-
-    void unhighlightTrainItems(const Train& train);
-
-    void highlightTrainItemsWithLink(const Train& train);
-    void unhighlightTrainItemsWithLink(const Train& train);
+    /**
+     * 2026.10  列车在本页的全部运行线图元，按运行线顺序。
+     * 本类只保存图元指针，不调用图元；高亮等操作由DiagramWidget完成（数据层不依赖kernel）。
+     */
+    QList<TrainItem*> trainItems(const Train& train)const;
 
     QList<QGraphicsRectItem*>& dirForbidItem(const Forbid* forbid, Direction dir);
 
@@ -208,8 +228,34 @@ public:
      */
     std::shared_ptr<DiagramPage> clone()const;
 
+    /**
+     * 2026.10  脏标记
+     * markTrainDirty()仅标记单个车次；若已有DirtyTrains或DirtyLayout，则单个车次的标记被吸收。
+     * 标记之后应尽快调用DiagramWidget::updateGraph()，由它清除标记。
+     */
+    void markDirty(DirtyFlags flags) { _dirty |= flags; }
+    void markTrainDirty(std::shared_ptr<Train> train) { _dirtyTrains.insert(train); }
+    DirtyFlags dirty()const { return _dirty; }
+    const auto& dirtyTrains()const { return _dirtyTrains; }
+    bool isDirty()const { return _dirty != NotDirty || !_dirtyTrains.isEmpty(); }
+    void clearDirty();
+
+    /**
+     * 2026.10  页面设置由oldcfg变为newcfg时需要重建的图元。
+     * 只影响颜色、线宽的为DirtyGrid，只影响运行线及其标签、选择、显示类型等的为DirtyTrains，
+     * 比例、时间范围、边距等改变图幅几何的为DirtyLayout。
+     */
+    static DirtyFlags configDirtyFlags(const Config& oldcfg, const Config& newcfg);
+
+    /**
+     * 按configDirtyFlags()标记
+     */
+    void markConfigChanged(const Config& oldcfg, const Config& newcfg);
+
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(DiagramPage::DirtyFlags)
+
 //inline auto overNullLabel() { return _overLabels.end(); }
 //inline auto belowNullLabel() { return _belowLabels.end(); }
 //inline auto startingNullLabel(Direction dir) {
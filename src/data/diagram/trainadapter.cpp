@@ -1,8 +1,8 @@
 ﻿#include "trainadapter.h"
 #include <cassert>
 
-#include "kernel/trainitem.h"
-#include "util/utilfunc.h"
+#include "data/train/train.h"
+#include "data/common/timeutil.h"
 #include "config.h"
 #include "data/rail/rulernode.h"
 
@@ -44,6 +44,16 @@ AdapterEventList TrainAdapter::listAdapterEvents(const TrainCollection& coll) co
 	return res;
 }
 
+AdapterEventList TrainAdapter::listAdapterEvents(const TrainLineIndex& index) const
+{
+	AdapterEventList res;
+	for (auto p : _lines) {
+		auto&& t = p->listLineEvents(index);
+		res.append(t);
+	}
+	return res;
+}
+
 const AdapterStation* TrainAdapter::lastStation() const
 {
 	if (_lines.empty())
@@ -164,6 +174,8 @@ void TrainAdapter::timetableInterpolation(std::shared_ptr<const Ruler> ruler,
 		}
 		line->timetaleInterpolation(ruler, toBegin, toEnd, prec);
 	}
+	//时刻表中插入了车站，站序改变
+	train()->refreshStationIndexes();
 }
 
 double TrainAdapter::relativeError(std::shared_ptr<const Ruler> ruler) const
@@ -211,13 +223,14 @@ void TrainAdapter::autoLines(const Config& config)
 	//qDebug() << "TrainAdapter::autoLines: INFO: binding " << train().trainName().full() <<
 	//	" @ " << rail.name() << Qt::endl;
 
-	for (auto tcur = table.begin(); tcur != table.end(); ++tcur) {
+	int tidx = 0;     //tcur的站序
+	for (auto tcur = table.begin(); tcur != table.end(); ++tcur, ++tidx) {
         std::shared_ptr rcur = rail->stationByGeneralName(tcur->name);
 		bool bound = false;   //本站是否成功绑定
 		if (rcur) {
 			if (!loccnt) {
 				//第一站，这时候什么都不知道，直接绑定
-				line->addStation(tcur, rcur);
+				line->addStation(tcur, tidx, rcur);
 				bound = true;
 			}
 			else if (loccnt == 1 && (
@@ -262,13 +275,13 @@ void TrainAdapter::autoLines(const Config& config)
 					line = std::make_shared<TrainLine>(*this);
 					loccnt = 0;
 					locdir = Direction::Undefined;
-					line->addStation(tcur, rcur);
+					line->addStation(tcur, tidx, rcur);
 					bound = true;
 				}
 				else if (rcur == rlast) {
 					//如果本站和上一站是同一站...直接绑定
 					//此时不对方向有任何判断
-					line->addStation(tcur, rcur);
+					line->addStation(tcur, tidx, rcur);
 					bound = true;
 				}
 				else {  //不是跨越区间数截断的情况
@@ -282,7 +295,7 @@ void TrainAdapter::autoLines(const Config& config)
 						// 因为是单向站，所以运行线方向可以直接断定
 						locdir = qeutil::passedDirToDir(rcur->direction);
 						loccnt = 0;   
-						line->addStation(tcur, rcur);
+						line->addStation(tcur, tidx, rcur);
 						line->_dir = locdir;
 						bound = true;
 					}
@@ -298,7 +311,7 @@ void TrainAdapter::autoLines(const Config& config)
 						line->_stations.push_back(_lines.last()->_stations.back());   //copy construct
 						loccnt = 1;  //这是上一站
 						line->_dir = locdir;
-						line->addStation(tcur, rcur);
+						line->addStation(tcur, tidx, rcur);
 						bound = true;
 					}
 					else {  //其他情况
@@ -306,7 +319,7 @@ void TrainAdapter::autoLines(const Config& config)
 						line->_dir = locdir;
 						
 						if (rcur->isDirectionVia(locdir)) {
-							line->addStation(tcur, rcur);
+							line->addStation(tcur, tidx, rcur);
 							bound = true;
 						}
 					}
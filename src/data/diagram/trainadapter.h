@@ -77,6 +77,11 @@ public:
      */
     AdapterEventList listAdapterEvents(const TrainCollection& coll)const;
 
+    /**
+     * 使用本线的运行线索引计算事件表
+     */
+    AdapterEventList listAdapterEvents(const TrainLineIndex& index)const;
+
     /**
      * 返回最后一个绑定的车站。
      * 如果为空（应该不存在这种情况），返回空指针
@@ -4,7 +4,7 @@
 #include "trainline.h"
 #include "data/rail/railstation.h"
 #include "data/train/train.h"
-#include "util/utilfunc.h"
+#include "data/common/timeutil.h"
 
 bool StationEvent::operator<(const StationEvent& another) const
 {
@@ -1,5 +1,5 @@
 ﻿#include "traingap.h"
-#include "util/utilfunc.h"
+#include "data/common/timeutil.h"
 #include "trainline.h"
 #include <QObject>
 #include <initializer_list>
@@ -2,10 +2,12 @@
 #include "data/common/stationname.h"
 #include "data/train/train.h"
 #include "trainadapter.h"
+#include "trainlineindex.h"
 #include "data/train/traincollection.h"
 #include "data/train/train.h"
 #include "data/rail/rail.h"
-#include "util/utilfunc.h"
+#include "data/common/timeutil.h"
+#include "data/train/timetablearrays.h"
 
 #include <QDebug>
 #include <cmath>
@@ -156,6 +158,45 @@ DiagnosisList TrainLine::diagnoseLine(const TrainCollection& coll, bool withIntM
     return res;
 }
 
+LineEventList TrainLine::listLineEvents(const TrainLineIndex& index) const
+{
+    LineEventList res;
+    res.reserve(static_cast<int>(_stations.size()));
+    for (size_t i = 0; i < _stations.size(); i++) {
+        res.push_back(StationEventList());
+    }
+
+    listStationEvents(res);
+
+    for (const auto& line : index.candidates(*this)) {
+        const Train& t = *(line->train());
+        if (line->dir() == dir()) {
+            eventsWithSameDir(res, *line, t);
+        }
+        else {
+            eventsWithCounter(res, *line, t);
+        }
+    }
+    return res;
+}
+
+DiagnosisList TrainLine::diagnoseLine(const TrainLineIndex& index, bool withIntMeet) const
+{
+    DiagnosisList res;
+
+    diagnoseSelf(res);
+
+    for (const auto& line : index.candidates(*this)) {
+        if (line->dir() == dir()) {
+            diagnoWithSameDir(res, *line, *(line->train()));
+        }
+        else if (withIntMeet) {
+            diagnoWithCounter(res, *line, *(line->train()));
+        }
+    }
+    return res;
+}
+
 int TrainLine::totalSecs() const
 {
     if (isNull())
@@ -178,16 +219,18 @@ std::pair<int, int> TrainLine::runStaySecs() const
             _stations.front().trainStation->depart));
     }
     int run = 0, stay = 0;
+    //2026.10  时刻数据取自连续存储的时刻表，不再逐个访问链表结点
+    auto arrays = train()->timetableArrays();
     auto p = _stations.begin();
     if (!isStartingStation(p) && startLabel()) {
-        stay += p->trainStation->stopSec();
+        stay += arrays->stopSecs(p->index);
     }
     auto p0 = p; ++p;
     for (; p != _stations.end(); ++p) {
         //run
-        run += qeutil::secsTo(p0->trainStation->depart, p->trainStation->arrive);
+        run += TimetableArrays::secsTo(arrays->depart(p0->index), arrays->arrive(p->index));
         if (!isTerminalStation(p))
-            stay += p->trainStation->stopSec();
+            stay += arrays->stopSecs(p->index);
         p0 = p;
     }
     return std::make_pair(run, stay);
@@ -197,8 +240,8 @@ double TrainLine::totalMile() const
 {
     if (isNull())
         return 0.0;
-    return std::abs(_stations.back().railStation.lock()->mile -
-        _stations.front().railStation.lock()->mile);
+    return std::abs(_stations.back().station->mile -
+        _stations.front().station->mile);
 }
 
 void TrainLine::listStationEvents(LineEventList& res) const
@@ -470,7 +513,7 @@ void TrainLine::eventsWithSameDir(LineEventList& res, const TrainLine& another,
         }
 
         auto tme = pme->trainStation, the = phe->trainStation;
-        auto rme = pme->railStation.lock(), rhe = phe->railStation.lock();
+        const RailStation* rme = pme->station, * rhe = phe->station;
         //判断站内有没有发生什么事情 这个复杂一点
         //麻烦在：可能出现一趟车站内停车，另一趟车通过但这里没有停点的情况
         if (ycond == 0 && (index!=0||startLabel())) {
@@ -530,7 +573,7 @@ void TrainLine::eventsWithSameDir(LineEventList& res, const TrainLine& another,
                         res[index - 1].emplace(StationEvent(
                             TrainEventType::OverTaking,
                             QTime::fromMSecsSinceStartOfDay(passedTime),
-                            rhe, std::cref(antrain), QObject::tr("推定")
+                            phe->railStation, std::cref(antrain), QObject::tr("推定")
                         ));
                         //qDebug() << ycond;
                         //qDebug() << "推定越行 " << mylast->trainStation->name << ", " <<
@@ -548,7 +591,7 @@ void TrainLine::eventsWithSameDir(LineEventList& res, const TrainLine& another,
                         //本次列车在本站被踩
                         res[index].emplace(StationEvent(
                             TrainEventType::Avoid, QTime::fromMSecsSinceStartOfDay(passedTime),
-                            rme, std::cref(antrain), QObject::tr("推定")
+                            pme->railStation, std::cref(antrain), QObject::tr("推定")
                         ));
                     }
                 }
@@ -608,7 +651,7 @@ void TrainLine::eventsWithCounter(LineEventList& res, const TrainLine& another,
         }
 
         auto tme = pme->trainStation, the = phe->trainStation;
-        auto rme = pme->railStation.lock(), rhe = phe->railStation.lock();
+        const RailStation* rme = pme->station, * rhe = phe->station;
         //判断站内有没有发生什么事情 这个复杂一点
         //麻烦在：可能出现一趟车站内停车，另一趟车通过但这里没有停点的情况
         if (ycond == 0 && (index != 0 || startLabel())) {
@@ -662,7 +705,7 @@ void TrainLine::eventsWithCounter(LineEventList& res, const TrainLine& another,
                             res[index - 1].emplace(StationEvent(
                                 TrainEventType::Meet,
                                 QTime::fromMSecsSinceStartOfDay(passedTime),
-                                rhe, std::cref(antrain), QObject::tr("推定")
+                                phe->railStation, std::cref(antrain), QObject::tr("推定")
                             ));
                         }
                     }
@@ -687,7 +730,7 @@ void TrainLine::eventsWithCounter(LineEventList& res, const TrainLine& another,
                             //本次列车在本站被踩
                             res[index].emplace(StationEvent(
                                 TrainEventType::Meet, QTime::fromMSecsSinceStartOfDay(passedTime),
-                                rme, std::cref(antrain), QObject::tr("推定")
+                                pme->railStation, std::cref(antrain), QObject::tr("推定")
                             ));
                         }
                     }
@@ -831,12 +874,12 @@ int TrainLine::xComp(const QTime& tm1, const QTime& tm2) const
     return res;
 }
 
-int TrainLine::getPreviousPassedTime(ConstAdaPtr st, std::shared_ptr<RailStation> target) const
+int TrainLine::getPreviousPassedTime(ConstAdaPtr st, const RailStation* target) const
 {
     static constexpr int msecsOfADay = 24 * 3600 * 1000;
     auto prev = std::prev(st);
-    double y0 = prev->railStation.lock()->y_coeff.value();
-    double yn = st->railStation.lock()->y_coeff.value();
+    double y0 = prev->station->y_coeff.value();
+    double yn = st->station->y_coeff.value();
     double yi = target->y_coeff.value();
 
     int x0 = prev->trainStation->depart.msecsSinceStartOfDay();
@@ -847,12 +890,12 @@ int TrainLine::getPreviousPassedTime(ConstAdaPtr st, std::shared_ptr<RailStation
 }
 
 int TrainLine::getPreviousPassedTime(std::deque<AdapterStation>::const_reverse_iterator st,
-    std::shared_ptr<RailStation> target) const
+    const RailStation* target) const
 {
     static constexpr int msecsOfADay = 24 * 3600 * 1000;
     auto prev = std::prev(st);
-    double y0 = prev->railStation.lock()->y_coeff.value();
-    double yn = st->railStation.lock()->y_coeff.value();
+    double y0 = prev->station->y_coeff.value();
+    double yn = st->station->y_coeff.value();
     double yi = target->y_coeff.value();
 
     int x0 = prev->trainStation->arrive.msecsSinceStartOfDay();
@@ -867,8 +910,8 @@ std::optional<std::tuple<double, QTime, TrainEventType>>
     TrainLine::findIntervalIntersectionSameDir(ConstAdaPtr mylast, ConstAdaPtr mythis, 
         ConstAdaPtr hislast, ConstAdaPtr histhis) const
 {
-    auto rm1 = mylast->railStation.lock(), rm2 = mythis->railStation.lock();
-    auto rh1 = hislast->railStation.lock(), rh2 = histhis->railStation.lock();
+    const RailStation* rm1 = mylast->station, * rm2 = mythis->station;
+    const RailStation* rh1 = hislast->station, * rh2 = histhis->station;
 
     //y值：是直接确定的
     double ym1 = rm1->y_coeff.value(), ym2 = rm2->y_coeff.value();
@@ -988,8 +1031,8 @@ std::optional<std::tuple<double, QTime, TrainEventType>>
         std::deque<AdapterStation>::const_reverse_iterator hislast, 
         std::deque<AdapterStation>::const_reverse_iterator histhis) const
 {
-    auto rm1 = mylast->railStation.lock(), rm2 = mythis->railStation.lock();
-    auto rh1 = hislast->railStation.lock(), rh2 = histhis->railStation.lock();
+    const RailStation* rm1 = mylast->station, * rm2 = mythis->station;
+    const RailStation* rh1 = hislast->station, * rh2 = histhis->station;
 
     //y值：是直接确定的
     double ym1 = rm1->y_coeff.value(), ym2 = rm2->y_coeff.value();
@@ -1179,7 +1222,7 @@ SnapEvent::pos_t
 
 double TrainLine::snapEventMile(ConstAdaPtr former, ConstAdaPtr latter, const QTime& time) const
 {
-    auto rfor = former->railStation.lock(), rlat = latter->railStation.lock();
+    const RailStation* rfor = former->station, * rlat = latter->station;
 
     //先算出里程
     const QTime& t0 = former->trainStation->depart, tn = latter->trainStation->arrive;
@@ -1314,8 +1357,8 @@ bool TrainLine::autoBusiness()
     bool passen = t->getIsPassenger();
     for (auto p = _stations.begin(); p != _stations.end(); ++p) {
         bool should_busi = (isStartingOrTerminal(p) || p->trainStation->isStopped())
-            && ((passen && p->railStation.lock()->passenger) ||
-                (!passen && p->railStation.lock()->freight));
+            && ((passen && p->station->passenger) ||
+                (!passen && p->station->freight));
         if (should_busi != p->trainStation->business) {
             p->trainStation->business = should_busi;
             flag = true;
@@ -1349,7 +1392,7 @@ const AdapterStation* TrainLine::stationFromRail(std::shared_ptr<RailStation> ra
 {
     // 2021.09.22：不能直接lower_bound，要考虑上下行
     auto p = stationFromYCoeff(rail->y_coeff.value());
-    if (p!=_stations.end()&& p->railStation.lock() == rail) {
+    if (p!=_stations.end()&& p->station == rail.get()) {
         return &(*p);
     }
     else return nullptr; 
@@ -1373,7 +1416,7 @@ RailStationEventList
     auto p = stationFromYCoeff(rail->y_coeff.value());   //运行方向区间后站
     if (p == _stations.end())
         return {};
-    else if (p->railStation.lock() == rail) {
+    else if (p->station == rail.get()) {
         // 2021.09.09新增规则：运行线首站到达、末站出发不算进来
         bool localFirst = (p == _stations.begin());
         bool localLast = (p == last);
@@ -1444,7 +1487,7 @@ std::optional<QTime> TrainLine::sectionTime(double y) const
         return std::nullopt;
     else if (p == _stations.begin()) {
         //首站的特殊处理
-        if (p->railStation.lock()->y_coeff.value() == y)
+        if (p->station->y_coeff.value() == y)
             return dir() == Direction::Down ?
             p->trainStation->arrive :
             p->trainStation->depart;
@@ -1452,8 +1495,8 @@ std::optional<QTime> TrainLine::sectionTime(double y) const
     else {
         //正常的区间情况 根据y值计算  此时p是运行方向区间后站
         auto q = std::prev(p);
-        double y0 = q->railStation.lock()->y_coeff.value();
-        double yn = p->railStation.lock()->y_coeff.value();
+        double y0 = q->station->y_coeff.value();
+        double yn = p->station->y_coeff.value();
         int dsn = q->trainStation->depart.secsTo(p->trainStation->arrive);
         int dsi = std::round((y - y0) / (yn - y0) * dsn);
         return q->trainStation->depart.addSecs(dsi);
@@ -1481,7 +1524,7 @@ SnapEventList TrainLine::getSnapEvents(const QTime& time) const
         }
         if (p->trainStation->timeInStoppedRange(time.msecsSinceStartOfDay())) {
             //恰好在站内
-            res.append(SnapEvent(shared_from_this(), p->railStation.lock()->mile,
+            res.append(SnapEvent(shared_from_this(), p->station->mile,
                 p->railStation.lock(), p->trainStation->isStopped()));
         }
         pr = p;
@@ -1546,7 +1589,7 @@ void TrainLine::timetaleInterpolation(std::shared_ptr<const Ruler> ruler, bool t
                 // 插入时刻表车站
                 auto train_itr = train()->timetable().emplace(std::next(itr->trainStation),
                     to_deter->name, tm, tm, false, "", QObject::tr("推定"));
-                auto line_itr = _stations.emplace(std::next(itr), train_itr, to_deter);
+                auto line_itr = _stations.emplace(std::next(itr), train_itr, -1, to_deter);
                 itr = line_itr;
             }
             p = std::next(itr);
@@ -1571,7 +1614,7 @@ void TrainLine::timetaleInterpolation(std::shared_ptr<const Ruler> ruler, bool t
             QTime tm = refTime.addSecs(-round_secs(acc_std_secs, precision));
             auto train_itr=train()->timetable().emplace(_stations.begin()->trainStation,
                 to_deter->name, tm, tm, is_starting, "", QObject::tr("推定"));
-            _stations.emplace_front(train_itr, to_deter);
+            _stations.emplace_front(train_itr, -1, to_deter);
             if (is_starting)break;
             else to_deter = to_deter->dirPrevAdjacent(dir());
         }
@@ -1596,7 +1639,7 @@ void TrainLine::timetaleInterpolation(std::shared_ptr<const Ruler> ruler, bool t
             auto train_itr = train()->timetable().emplace(
                 std::next(last->trainStation), to_deter->name,
                 tm, tm, is_terminal, "", QObject::tr("推定"));
-            _stations.emplace_back(train_itr, to_deter);
+            _stations.emplace_back(train_itr, -1, to_deter);
             last = std::prev(_stations.end());
             if (is_terminal)break;
             else to_deter = to_deter->dirAdjacent(dir());
@@ -1607,15 +1650,15 @@ void TrainLine::timetaleInterpolation(std::shared_ptr<const Ruler> ruler, bool t
 
 bool AdapterStation::operator<(double y) const
 {
-    return railStation.lock()->y_coeff.value() < y;
+    return station->y_coeff.value() < y;
 }
 
 double AdapterStation::yCoeff() const
 {
-    return railStation.lock()->y_coeff.value();
+    return station->y_coeff.value();
 }
 
 bool operator<(double y, const AdapterStation& adp)
 {
-    return y < adp.railStation.lock()->y_coeff.value();
+    return y < adp.station->y_coeff.value();
 }
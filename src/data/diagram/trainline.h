@@ -26,9 +26,19 @@ class Train;
 struct AdapterStation{
     std::list<TrainStation>::iterator trainStation;
     std::weak_ptr<RailStation> railStation;
-    AdapterStation(std::list<TrainStation>::iterator trainStation_,
+    int index;    // 2026.10  trainStation在列车时刻表中的站序，即Train::timetableArrays()的下标
+
+    /**
+     * 2026.10  railStation的非拥有指针，绑定时取得。
+     * 车站由Railway持有；线路的车站变化后都要重新绑定（替换整个TrainAdapter），
+     * 因此在Adapter有效期间此指针有效。遍历、比较车站时用此指针，避免反复lock()；
+     * 需要持有车站（如写入事件、作为结果的键）时才用railStation。
+     */
+    const RailStation* station;
+    AdapterStation(std::list<TrainStation>::iterator trainStation_, int index_,
         std::weak_ptr<RailStation> railStation_):
-        trainStation(trainStation_),railStation(railStation_){}
+        trainStation(trainStation_),railStation(railStation_),index(index_),
+        station(railStation_.lock().get()){}
     bool operator<(double y)const;
     double yCoeff()const;
 };
@@ -38,6 +48,7 @@ bool operator<(double y, const AdapterStation& adp);
 
 
 class TrainCollection;
+class TrainLineIndex;
 
 
 /**
@@ -51,6 +62,7 @@ class TrainLine:
     public std::enable_shared_from_this<TrainLine>
 {
     friend class TrainAdapter;
+    friend class TrainLineIndex;
     TrainAdapter& _adapter;
 
     /**
@@ -84,9 +96,9 @@ public:
     TrainLine(const TrainLine&) = default;
     TrainLine(TrainLine&&) = default;
 
-    inline void addStation(std::list<TrainStation>::iterator trainStation,
+    inline void addStation(std::list<TrainStation>::iterator trainStation, int index,
         std::weak_ptr<RailStation> rs) {
-        _stations.emplace_back(trainStation, rs);
+        _stations.emplace_back(trainStation, index, rs);
     }
 
     inline void pop_back() {
@@ -160,6 +172,15 @@ public:
      */
     DiagnosisList diagnoseLine(const TrainCollection& coll, bool withIntMeet)const;
 
+    /**
+     * 使用线路的运行线索引，只与里程、时间上可能相交的运行线比较。
+     * 结果与遍历整个列车集合的版本一致。
+     * 要求index是本运行线所在线路的索引。
+     */
+    LineEventList listLineEvents(const TrainLineIndex& index)const;
+
+    DiagnosisList diagnoseLine(const TrainLineIndex& index, bool withIntMeet)const;
+
     inline const AdapterStation* lastStation()const {
         return _stations.empty() ? nullptr : &(_stations.back());
     }
@@ -329,8 +350,8 @@ private:
      */
     template <typename ForwardIter1, typename ForwardIter2>
     inline int yComp(ForwardIter1 st1, ForwardIter2 st2)const {
-        double y1 = st1->railStation.lock()->y_coeff.value(),
-            y2 = st2->railStation.lock()->y_coeff.value();
+        double y1 = st1->station->y_coeff.value(),
+            y2 = st2->station->y_coeff.value();
         if (y1 == y2)
             return 0;
         else if (y1 < y2)
@@ -384,11 +405,11 @@ private:
      * @return 目标站的时刻，以【毫秒数】表示！！
      */
     //template <typename BidirIter>
-    int getPreviousPassedTime(ConstAdaPtr st, std::shared_ptr<RailStation> target)const;
+    int getPreviousPassedTime(ConstAdaPtr st, const RailStation* target)const;
     
 
     int getPreviousPassedTime(std::deque<AdapterStation>::const_reverse_iterator st,
-        std::shared_ptr<RailStation> target)const; 
+        const RailStation* target)const; 
 
     /**
      * @brief findIntervalIntersectionSameDIr 判断同向区间交点。
@@ -477,6 +498,7 @@ private:
      * 是第一或最后运行线；但如果当前时刻的首站、末站为始发终到站，则不进行外插，
      * 由本函数进行这个判断。
      * 暂定新推定的时刻直接进行绑定。
+     * 2026.10  新插入站的站序(AdapterStation::index)暂不设置，由Adapter完成后统一刷新。
      */
     void timetaleInterpolation(std::shared_ptr<const Ruler> ruler, bool toBegin,
         bool toEnd, int precision);
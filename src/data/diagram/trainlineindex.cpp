@@ -0,0 +1,82 @@
+﻿#include "trainlineindex.h"
+#include "trainline.h"
+#include "trainadapter.h"
+#include "data/train/train.h"
+#include "data/train/traincollection.h"
+#include "data/train/trainstation.h"
+#include "data/train/timetablearrays.h"
+
+#include <algorithm>
+
+TrainLineIndex::TrainLineIndex(const TrainCollection& coll,
+    std::shared_ptr<const Railway> railway)
+{
+    int order = 0;
+    for (const auto& train : coll.trains()) {
+        for (const auto& adp : train->adapters()) {
+            if (!adp->isInSameRailway(railway))
+                continue;
+            for (const auto& line : adp->lines()) {
+                if (line->isNull())
+                    continue;
+                int idx = static_cast<int>(_entries.size());
+                _entries.push_back(Entry{ line, line->yMin(), line->yMax(), order++ });
+                auto [first, last] = bucketRange(timeWindow(*line));
+                for (int b = first; b <= last; b++) {
+                    _buckets[b % BUCKET_COUNT].push_back(idx);
+                }
+            }
+        }
+    }
+}
+
+std::vector<std::shared_ptr<TrainLine>> TrainLineIndex::candidates(const TrainLine& line) const
+{
+    std::vector<std::shared_ptr<TrainLine>> res;
+    if (line.isNull())
+        return res;
+    double ymin = line.yMin(), ymax = line.yMax();
+    const Train* train = line.train().get();
+
+    // 桶内下标本身是递增的，合并后排序去重即恢复集合遍历顺序
+    std::vector<int> idxs;
+    auto [first, last] = bucketRange(timeWindow(line));
+    for (int b = first; b <= last; b++) {
+        for (int i : _buckets[b % BUCKET_COUNT]) {
+            const auto& ent = _entries[i];
+            // 与TrainLine::eventsWithSameDir等中的提前终止条件一致
+            if (std::max(ymin, ent.yMin) < std::min(ymax, ent.yMax) &&
+                ent.line->train().get() != train) {
+                idxs.push_back(i);
+            }
+        }
+    }
+    std::sort(idxs.begin(), idxs.end());
+    idxs.erase(std::unique(idxs.begin(), idxs.end()), idxs.end());
+
+    res.reserve(idxs.size());
+    for (int i : idxs) {
+        res.push_back(_entries[i].line);
+    }
+    return res;
+}
+
+std::pair<int, int> TrainLineIndex::timeWindow(const TrainLine& line)
+{
+    // 按站序取连续存储的累计时刻，首末站之间的未绑定站也计入，
+    // 由于逐站按PBC累计，结果不小于仅按绑定站累计的窗口
+    const auto& sts = line.stations();
+    auto arrays = line.train()->timetableArrays();
+    int first = sts.front().index, last = sts.back().index;
+    int s = arrays->arrive(first);
+    return std::make_pair(s, s + arrays->departElapsed(last) - arrays->arriveElapsed(first));
+}
+
+std::pair<int, int> TrainLineIndex::bucketRange(const std::pair<int, int>& window)
+{
+    if (window.second - window.first >= 24 * 3600 - BUCKET_SECS) {
+        // 覆盖全天（或接近全天），直接登记所有桶，避免取模后重复
+        return std::make_pair(0, BUCKET_COUNT - 1);
+    }
+    return std::make_pair(window.first / BUCKET_SECS, window.second / BUCKET_SECS);
+}
@@ -0,0 +1,68 @@
+﻿#pragma once
+
+#include <memory>
+#include <vector>
+#include <array>
+
+class TrainLine;
+class Railway;
+class TrainCollection;
+
+/**
+ * @brief The TrainLineIndex class
+ * 单条线路上所有运行线的 里程范围×时间窗口 索引。
+ * 用于事件表 (listLineEvents)、运行图诊断 (diagnoseLine) 中快速筛选可能发生交互的运行线，
+ * 代替逐车次、逐Adapter、逐运行线的遍历，使得全图事件计算接近线性。
+ *
+ * 时间轴按固定长度分桶，每条运行线登记到其时间窗口覆盖的所有桶中；
+ * 跨0点的运行线按PBC登记到首尾两部分的桶。
+ * 里程范围用y坐标表示（y坐标与站序单调对应，因此即使重新铺画后也不影响判断结果）。
+ *
+ * 索引只读，不跟踪列车或线路的变化；由Diagram负责在数据变化时失效重建。
+ */
+class TrainLineIndex
+{
+public:
+    struct Entry {
+        std::shared_ptr<TrainLine> line;
+        double yMin, yMax;
+        int order;   // 按列车集合遍历的顺序，用于保证结果顺序与逐个遍历时一致
+    };
+
+    static constexpr int BUCKET_SECS = 1800;
+    static constexpr int BUCKET_COUNT = 24 * 3600 / BUCKET_SECS;
+
+private:
+    std::vector<Entry> _entries;
+    std::array<std::vector<int>, BUCKET_COUNT> _buckets;
+
+public:
+    /**
+     * 从列车集合中提取在指定线路上的所有运行线，构建索引。
+     */
+    TrainLineIndex(const TrainCollection& coll, std::shared_ptr<const Railway> railway);
+
+    inline const auto& entries()const { return _entries; }
+    inline auto size()const { return _entries.size(); }
+
+    /**
+     * 与所给运行线里程范围、时间窗口都有交集的其他运行线，
+     * 不包含同一车次的运行线。
+     * 返回顺序与列车集合的遍历顺序一致。
+     */
+    std::vector<std::shared_ptr<TrainLine>> candidates(const TrainLine& line)const;
+
+    /**
+     * 运行线的时间窗口：[首站到达, 首站到达+总时长]，单位秒。
+     * 总时长逐站按PBC累加，因此可超过24小时。
+     */
+    static std::pair<int, int> timeWindow(const TrainLine& line);
+
+private:
+
+    /**
+     * 时间窗口覆盖的桶下标范围 [first, last]，last可能超过BUCKET_COUNT，使用时取模。
+     * 如果窗口覆盖全天，返回 [0, BUCKET_COUNT-1]。
+     */
+    static std::pair<int, int> bucketRange(const std::pair<int, int>& window);
+};
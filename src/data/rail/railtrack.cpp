@@ -1,5 +1,5 @@
 ﻿#include "railtrack.h"
-#include "util/utilfunc.h"
+#include "data/common/timeutil.h"
 #include "data/diagram/trainline.h"
 
 TrackItem::TrackItem(const QString &title, const StationName &stationName,
@@ -175,7 +175,7 @@ Railway::stationByGeneralName(const StationName& name)
 	auto p = stationByName(name);
 	if (p) 
 		return p;
-	const QList<StationName>& t = fieldMap.value(name.station());
+	const QList<StationName>& t = fieldMap.value(name.stationId());
 	for (const auto& p : t) {
 		if (p.equalOrContains(name)) {
 			return stationByName(p);
@@ -190,7 +190,7 @@ Railway::stationByGeneralName(const StationName& name) const
 	auto p = stationByName(name);
 	if (p)
 		return p;
-	const QList<StationName>& t = fieldMap.value(name.station());
+	const QList<StationName>& t = fieldMap.value(name.stationId());
 	for (const auto& p : t) {
 		if (p.equalOrContains(name)) {
 			return stationByName(p);
@@ -206,9 +206,9 @@ bool Railway::containsStation(const StationName& name) const
 
 bool Railway::containsGeneralStation(const StationName& name) const
 {
-	if (!fieldMap.contains(name.station()))
+	if (!fieldMap.contains(name.stationId()))
 		return false;
-	const auto& t = fieldMap.value(name.station());
+	const auto& t = fieldMap.value(name.stationId());
 	for (const auto& p : t) {
 		if (p.isBare() || p == name)
 			return true;
@@ -1185,18 +1185,18 @@ void Railway::addMapInfo(const std::shared_ptr<RailStation>& st)
 	//nameMap  直接添加
 	const auto& n = st->name;
 	nameMap.insert(n, st);
-	fieldMap[n.station()].append(n);
+	fieldMap[n.stationId()].append(n);
 }
 
 void Railway::removeMapInfo(const StationName& name)
 {
 	nameMap.remove(name);
 
-	auto t = fieldMap.find(name.station());
+	auto t = fieldMap.find(name.stationId());
 	if (t == fieldMap.end())
 		return;
 	else if (t.value().count() == 1) {
-		fieldMap.remove(name.station());
+		fieldMap.remove(name.stationId());
 	}
 	else {
 		QList<StationName>& lst = t.value();
@@ -1213,7 +1213,7 @@ void Railway::setMapInfo()
 
 	for (const auto& p : _stations) {
 		nameMap.insert(p->name, p);
-		fieldMap[p->name.station()].append(p->name);
+		fieldMap[p->name.stationId()].append(p->name);
 	}
 }
 
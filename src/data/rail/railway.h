@@ -60,7 +60,7 @@ class Railway:
     RailInfoNote _notes;
 
     QHash<StationName, std::shared_ptr<RailStation>> nameMap;
-    QHash<QString, QList<StationName>> fieldMap;
+    QHash<quint32, QList<StationName>> fieldMap;    // 2026.10起以站名驻留编号(StationName::stationId)为键
     QHash<StationName, int> numberMap;
     bool numberMapEnabled = false;
 
@@ -4,7 +4,7 @@
 #include "rulernode.h"
 #include "railintervaldata.hpp"
 #include "data/diagram/trainadapter.h"
-#include "util/utilfunc.h"
+#include "data/common/timeutil.h"
 #include "data/train/trainstation.h"
 #include <QDebug>
 #include <QJsonArray>
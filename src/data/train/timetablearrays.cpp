@@ -0,0 +1,45 @@
+﻿#include "timetablearrays.h"
+#include "trainstation.h"
+
+#include <algorithm>
+
+TimetableArrays::TimetableArrays(const std::list<TrainStation>& table)
+{
+    const auto n = table.size();
+    _nodes.reserve(n);
+    _arrive.reserve(n);
+    _depart.reserve(n);
+    _arriveElapsed.reserve(n);
+    _departElapsed.reserve(n);
+    _flags.reserve(n);
+    _nameIds.reserve(n);
+
+    int elapsed = 0;
+    for (auto p = table.cbegin(); p != table.cend(); ++p) {
+        int arr = p->arrive.msecsSinceStartOfDay() / 1000;
+        int dep = p->depart.msecsSinceStartOfDay() / 1000;
+        if (!_nodes.empty()) {
+            elapsed += secsTo(_depart.back(), arr);
+        }
+        _nodes.push_back(p);
+        _arrive.push_back(arr);
+        _depart.push_back(dep);
+        _arriveElapsed.push_back(elapsed);
+        elapsed += secsTo(arr, dep);
+        _departElapsed.push_back(elapsed);
+
+        quint8 f = NoFlag;
+        if (p->isStopped())
+            f |= Stopped;
+        if (p->business)
+            f |= Business;
+        _flags.push_back(f);
+        _nameIds.push_back(p->name.id());
+    }
+}
+
+int TimetableArrays::indexOfName(quint32 nameId) const
+{
+    auto itr = std::find(_nameIds.begin(), _nameIds.end(), nameId);
+    return itr == _nameIds.end() ? -1 : static_cast<int>(itr - _nameIds.begin());
+}
@@ -0,0 +1,87 @@
+﻿#pragma once
+
+#include <list>
+#include <vector>
+#include <QtGlobal>
+
+class TrainStation;
+
+/**
+ * 2026.10  时刻表的连续存储（structure of arrays）副本
+ * Train::_timetable为std::list，其结点迭代器作为稳定句柄被AdapterStation, RoutingNode等使用，
+ * 因此保留链表作为数据的所有者；本类按站序将热点计算需要的数据平铺到连续数组中，
+ * 供运行线、事件计算等按下标访问，避免逐结点追踪链表。
+ *
+ * 由Train::timetableArrays()按需构建，随Train::invalidateTempData()失效；只读。
+ * 下标即站序，与AdapterStation::index一致。
+ */
+class TimetableArrays
+{
+public:
+    using ConstStationPtr = std::list<TrainStation>::const_iterator;
+
+    /**
+     * 与TrainStation::Flag中对应位取值相同
+     */
+    enum Flag : quint8 {
+        NoFlag = 0,
+        Stopped = 0b00001,
+        Business = 0b01000,
+    };
+
+private:
+    std::vector<ConstStationPtr> _nodes;
+    std::vector<int> _arrive, _depart;                  // 当日秒数
+    std::vector<int> _arriveElapsed, _departElapsed;    // 自首站到达起按PBC累计的秒数
+    std::vector<quint8> _flags;
+    std::vector<quint32> _nameIds;                      // 站名驻留编号 StationName::id()
+
+public:
+    explicit TimetableArrays(const std::list<TrainStation>& table);
+
+    inline int size()const { return static_cast<int>(_nodes.size()); }
+    inline bool empty()const { return _nodes.empty(); }
+
+    /**
+     * 原时刻表中的结点（稳定句柄）
+     */
+    inline ConstStationPtr node(int i)const { return _nodes[i]; }
+
+    inline int arrive(int i)const { return _arrive[i]; }
+    inline int depart(int i)const { return _depart[i]; }
+    inline quint8 flags(int i)const { return _flags[i]; }
+    inline bool isStopped(int i)const { return _flags[i] & Stopped; }
+    inline bool isBusiness(int i)const { return _flags[i] & Business; }
+    inline quint32 nameId(int i)const { return _nameIds[i]; }
+
+    /**
+     * 站名编号为nameId的第一个站的下标，不存在返回-1
+     */
+    int indexOfName(quint32 nameId)const;
+
+    inline int arriveElapsed(int i)const { return _arriveElapsed[i]; }
+    inline int departElapsed(int i)const { return _departElapsed[i]; }
+
+    /**
+     * 第i站停站秒数（考虑PBC）
+     */
+    inline int stopSecs(int i)const { return _departElapsed[i] - _arriveElapsed[i]; }
+
+    /**
+     * 第i站出发至第j站到达的秒数 (i<=j)，按逐站PBC累计，因此可以超过24小时
+     */
+    inline int secsBetween(int i, int j)const { return _arriveElapsed[j] - _departElapsed[i]; }
+
+    /**
+     * 首站到达至末站出发的总秒数；空时刻表返回0
+     */
+    inline int totalSecs()const { return empty() ? 0 : _departElapsed.back(); }
+
+    /**
+     * 两个当日秒数之间的秒数，考虑PBC。与qeutil::secsTo一致
+     */
+    static inline int secsTo(int s1, int s2) {
+        int secs = s2 - s1;
+        return secs < 0 ? secs + 24 * 3600 : secs;
+    }
+};
@@ -6,10 +6,12 @@
 #include "data/diagram/trainadapter.h"
 #include "data/train/traintype.h"
 #include "routing.h"
-#include "util/utilfunc.h"
+#include "data/common/timeutil.h"
 #include "typemanager.h"
+#include "timetablearrays.h"
 #include <QFile>
 #include <QTextStream>
+#include <unordered_map>
 
 Train::Train(const TrainName &trainName,
              const StationName &starting,
@@ -161,6 +163,7 @@ void Train::appendStation(const StationName &name,
                           bool business, const QString &track, const QString &note)
 {
     _timetable.emplace_back(name, arrive, depart, business, track, note);
+    invalidateTempData();
 }
 
 void Train::setPen(const QPen& pen)
@@ -178,6 +181,7 @@ void Train::prependStation(const StationName& name,
     bool business, const QString& track, const QString& note)
 {
     _timetable.emplace_front(name, arrive, depart, business, track, note);
+    invalidateTempData();
 }
 
 typename Train::StationPtr
@@ -270,8 +274,7 @@ std::shared_ptr<TrainAdapter> Train::updateBoundRailway(std::shared_ptr<Railway>
     //2021.06.24  基于Adapter新的实现
     //2021.07.04  TrainLine里面有Adapter的引用。不要move assign，直接删了重来好了
     unbindToRailway(railway);
-    bindToRailway(railway, config);
-    return nullptr;
+    return bindToRailway(railway, config);
 }
 
 void Train::unbindToRailway(std::shared_ptr<const Railway> railway)
@@ -301,6 +304,12 @@ void Train::clearBoundRailways()
     invalidateTempData();
 }
 
+void Train::setBoundRailways(QVector<std::shared_ptr<TrainAdapter>>&& adapters)
+{
+    _adapters = std::move(adapters);
+    invalidateTempData();
+}
+
 
 #if 0
 void Train::bindToRailway(std::shared_ptr<Railway> railway)
@@ -467,6 +476,7 @@ void Train::adjustTimetable(int startIndex, int endIndex, bool includeFirst,
             p->depart = p->depart.addSecs(secs);
         }
     }
+    invalidateTempData();
 }
 
 #if 0
@@ -543,6 +553,7 @@ void Train::jointTrain(Train&& train, bool former)
             _timetable.push_back(std::move(st));
         }
     }
+    invalidateTempData();
 }
 
 bool Train::isStartingStation(const AdapterStation* st)const
@@ -589,6 +600,8 @@ void Train::intervalExchange(Train& train2, StationPtr start1, StationPtr end1,
     tmp.splice(tmp.begin(), _timetable, start1, end1);
     _timetable.splice(end1, table2, start2, end2);
     table2.splice(end2, tmp);
+    invalidateTempData();
+    train2.invalidateTempData();
 }
 
 void Train::setRouting(std::weak_ptr<Routing> rout, std::list<RoutingNode>::iterator node)
@@ -765,6 +778,35 @@ void Train::invalidateTempData()
     _locMile = std::nullopt;
     _locRunSecs = std::nullopt;
     _locStaySecs = std::nullopt;
+    std::atomic_store(&_arrays, std::shared_ptr<const TimetableArrays>());
+}
+
+std::shared_ptr<const TimetableArrays> Train::timetableArrays() const
+{
+    auto res = std::atomic_load(&_arrays);
+    if (!res) {
+        // 多个线程同时构建时，结果相同，保留任意一个即可
+        res = std::make_shared<const TimetableArrays>(_timetable);
+        std::atomic_store(&_arrays, res);
+    }
+    return res;
+}
+
+void Train::refreshStationIndexes()
+{
+    std::unordered_map<const TrainStation*, int> indexes;
+    int i = 0;
+    for (const auto& st : _timetable) {
+        indexes.emplace(&st, i++);
+    }
+    foreach(auto adp, _adapters) {
+        foreach(auto line, adp->lines()) {
+            for (auto& st : line->stations()) {
+                st.index = indexes.at(&*st.trainStation);
+            }
+        }
+    }
+    invalidateTempData();
 }
 
 bool Train::timetableSame(const Train& other)const
@@ -785,6 +827,7 @@ void Train::swapTimetable(Train& other)
 {
     std::swap(_timetable, other._timetable);
     invalidateTempData();
+    other.invalidateTempData();
 }
 
 #define SWAP(_key) std::swap(_key,other._key)
@@ -945,6 +988,8 @@ bool Train::autoBusiness()
             flag=(flag||a);
         }
     }
+    if (flag)
+        invalidateTempData();   // 营业标志在SoA副本中
     return flag;
 }
 
@@ -979,6 +1024,7 @@ bool Train::isLocalTrain(const RailCategory& cat)const
 void Train::clear()
 {
     _timetable.clear();
+    invalidateTempData();
     _starting = StationName();
     _terminal = StationName();
 }
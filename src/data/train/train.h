@@ -28,6 +28,7 @@ class TrainType;
 class TypeManager;
 class Routing;
 class RoutingNode;
+class TimetableArrays;
 struct AdapterStation;
 
 
@@ -85,6 +86,12 @@ class Train:
     std::optional<double> _locMile;
     std::optional<int> _locRunSecs, _locStaySecs;
 
+    /**
+     * 2026.10  时刻表的连续存储副本，按需构建。
+     * 可能在并行计算的工作线程中构建，因此以std::atomic_load/atomic_store访问
+     */
+    mutable std::shared_ptr<const TimetableArrays> _arrays;
+
 public:
     using StationPtr=std::list<TrainStation>::iterator;
     using ConstStationPtr=std::list<TrainStation>::const_iterator;
@@ -166,6 +173,11 @@ public:
     inline bool isNullStation(ConstStationPtr st)const { return st == _timetable.end(); }
 
     const std::list<TrainStation>& timetable()const{return _timetable;}
+
+    /**
+     * 2026.10  通过此接口（或保存的StationPtr）原地修改时刻表后，
+     * 若不重新绑定，须调用invalidateTempData()，否则timetableArrays()等仍是旧数据。
+     */
     std::list<TrainStation>& timetable(){return _timetable;}
 
     auto& adapters() { return _adapters; }
@@ -224,9 +236,16 @@ public:
      */
     void clearBoundRailways();
 
+    /**
+     * 2026.10  用给定的绑定对象整体替换现有绑定。
+     * 用于并行绑定：工作线程中构造Adapter，完成后在主线程一次性写回。
+     */
+    void setBoundRailways(QVector<std::shared_ptr<TrainAdapter>>&& adapters);
+
     /**
      * 适用于线路可能发生变化时，
      * 即使已经绑定到同一条线路，也会撤销再重来 （转移构造）
+     * 返回新的绑定对象；不经过该线路时返回空
      */
     std::shared_ptr<TrainAdapter> updateBoundRailway(std::shared_ptr<Railway> railway, const Config& config);
 
@@ -433,6 +452,19 @@ public:
      */
     void invalidateTempData();
 
+    /**
+     * 2026.10  时刻表的连续存储（SoA）副本，下标为站序。
+     * 首次调用时构建，invalidateTempData()后失效；线程安全。
+     * 注意直接修改时刻表（timetable()）后，须经过invalidateTempData()（一般由重新绑定完成）。
+     */
+    std::shared_ptr<const TimetableArrays> timetableArrays()const;
+
+    /**
+     * 2026.10  在不重新绑定的情况下向时刻表插入车站后（如推定时刻），
+     * 重新标记所有AdapterStation的站序，并使临时数据失效
+     */
+    void refreshStationIndexes();
+
     inline QString startEndString()const {
         return _starting.toSingleLiteral() + "->" + _terminal.toSingleLiteral();
     }
@@ -2,11 +2,19 @@
 #include "routing.h"
 #include "train.h"
 #include "traintype.h"
+#include "data/common/jsonstreamreader.h"
+#include "data/diagram/binaryformat.h"
 
 #include <QJsonArray>
 #include <QFile>
 #include <QJsonObject>
 #include <QJsonDocument>
+#include <QVector>
+#include <QtConcurrent>
+#include <QSet>
+#include <algorithm>
+#include <limits>
+#include <atomic>
 
 TrainCollection::TrainCollection(const QJsonObject& obj, const TypeManager& defaultManager)
 {
@@ -28,13 +36,72 @@ void TrainCollection::fromJson(const QJsonObject& obj, const TypeManager& defaul
 	resetMapInfo();
 
 	//注意Routing的读取依赖车次查找
+	routingsFromJson(obj);
+}
+
+bool TrainCollection::fromJson(const QJsonObject& obj, const QByteArray& rawTrains,
+	const TypeManager& defaultManager)
+{
+	_trains.clear();
+	_manager.readForDiagram(obj.value("config").toObject(), defaultManager);
+	_routings.clear();
+
+	//每次只有一个车次的DOM
+	if (!rawTrains.isEmpty()) {
+		JsonStreamReader reader(rawTrains);
+		if (reader.enterArray()) {
+			while (reader.nextElement()) {
+				const QJsonValue& t = JsonStreamReader::parseValue(reader.skipValue());
+				if (!t.isObject()) {
+					qDebug() << "TrainCollection::fromJson: ERROR: malformed train at index "
+						<< _trains.size() << Qt::endl;
+					_trains.clear();
+					return false;
+				}
+				_trains.append(std::make_shared<Train>(t.toObject(), _manager));
+			}
+		}
+		if (reader.hasError()) {
+			qDebug() << "TrainCollection::fromJson: ERROR: malformed trains array after "
+				<< _trains.size() << " trains" << Qt::endl;
+			_trains.clear();
+			return false;
+		}
+	}
+
+	resetMapInfo();
+	routingsFromJson(obj);
+	return true;
+}
+
+bool TrainCollection::fromBinary(const QJsonObject& obj, const QByteArray& data,
+	const TypeManager& defaultManager)
+{
+	_trains.clear();
+	_manager.readForDiagram(obj.value("config").toObject(), defaultManager);
+	_routings.clear();
+
+	bool ok = false;
+	_trains = qebinary::decodeTrains(data, _manager, &ok);
+	if (!ok) {
+		qDebug() << "TrainCollection::fromBinary: ERROR: malformed trains" << Qt::endl;
+		_trains.clear();
+		return false;
+	}
+
+	resetMapInfo();
+	routingsFromJson(obj);
+	return true;
+}
+
+void TrainCollection::routingsFromJson(const QJsonObject& obj)
+{
 	const QJsonArray& arrouting = obj.value("circuits").toArray();
 	for (auto p = arrouting.cbegin(); p != arrouting.cend(); ++p) {
 		auto r = std::make_shared<Routing>();
 		r->fromJson(p->toObject(), *this);
 		_routings.append(r);
 	}
-    
 }
 
 bool TrainCollection::fromJson(const QString& filename, const TypeManager& defaultManager)
@@ -46,8 +113,28 @@ bool TrainCollection::fromJson(const QString& filename, const TypeManager& defau
 			<< " failed." << Qt::endl;
 		return false;
 	}
-	QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-	fromJson(doc.object(), defaultManager);
+	//2026.10  流式读取，车次逐个解析
+	const QByteArray& contents = JsonStreamReader::mapFile(file);
+	if (qebinary::isBinaryDiagram(contents)) {
+		//二进制格式：只解码需要的段，车次直接构造
+		bool ok = false;
+		const QJsonObject& obj = qebinary::decode(contents, &ok, { "config","circuits" });
+		if (!ok || !fromBinary(obj, contents, defaultManager)) {
+			qDebug() << "TrainCollection::fromJson: ERROR: corrupt binary file " << filename << Qt::endl;
+			file.close();
+			return false;
+		}
+	}
+	else {
+		QByteArray rawTrains;
+		bool ok = false;
+		const QJsonObject& obj = JsonStreamReader::readObjectExcept(contents, "trains", rawTrains, &ok);
+		if (!ok || !fromJson(obj, rawTrains, defaultManager)) {
+			qDebug() << "TrainCollection::fromJson: ERROR: invalid file " << filename << Qt::endl;
+			file.close();
+			return false;
+		}
+	}
 	file.close();
 	return true;
 }
@@ -135,11 +222,43 @@ std::shared_ptr<Train> TrainCollection::findFirstSingleName(const QString& name)
 
 QList<std::shared_ptr<Train>> TrainCollection::multiSearchTrain(const QString& name)
 {
-	QList<std::shared_ptr<Train>> res;
-	foreach (auto t , _trains) {
-		if (t->trainName().contains(name))
-			res.append(t);
+	if (name.isEmpty())
+		return _trains;
+
+	struct Hit {
+		int pos;
+		std::shared_ptr<Train> train;
+	};
+	std::vector<Hit> hits;
+	QSet<Train*> visited;
+	foreach(const auto & n, _nameIndex.search(name)) {
+		for (const auto& t : singleNameMap.value(n)) {
+			if (visited.contains(t.get()))
+				continue;
+			visited.insert(t.get());
+			// 车次可能经几个字面匹配，取最靠前的位置
+			const auto& tn = t->trainName();
+			int pos = std::numeric_limits<int>::max();
+			for (const QString* s : { &tn.full(), &tn.down(), &tn.up() }) {
+				if (int p = s->indexOf(name); p >= 0)
+					pos = std::min(pos, p);
+			}
+			hits.push_back({ pos, t });
+		}
 	}
+	std::sort(hits.begin(), hits.end(), [](const Hit& h1, const Hit& h2) {
+		if (h1.pos != h2.pos)
+			return h1.pos < h2.pos;
+		const auto& f1 = h1.train->trainName().full(), & f2 = h2.train->trainName().full();
+		if (f1.size() != f2.size())
+			return f1.size() < f2.size();
+		return f1 < f2;
+		});
+
+	QList<std::shared_ptr<Train>> res;
+	res.reserve(static_cast<int>(hits.size()));
+	for (auto& h : hits)
+		res.append(std::move(h.train));
 	return res;
 }
 
@@ -149,6 +268,8 @@ void TrainCollection::clear(const TypeManager& defaultManager)
 	_routings.clear();
 	fullNameMap.clear();
 	singleNameMap.clear();
+	_nameIndex.clear();
+	_stationIndex.clear();
 	_manager = defaultManager;
 }
 
@@ -165,6 +286,8 @@ void TrainCollection::clearTrainsAndRoutings()
 	_routings.clear();
 	fullNameMap.clear();
 	singleNameMap.clear();
+	_nameIndex.clear();
+	_stationIndex.clear();
 }
 
 std::shared_ptr<Train> TrainCollection::takeTrainAt(int i)
@@ -301,9 +424,10 @@ void TrainCollection::updateTrainInfo(std::shared_ptr<Train> train, std::shared_
 		fullNameMap.remove(n2.full());
 		fullNameMap.insert(n1.full(), train);
 	}
-	updateSingleNameMapItem(train, n1.full(), n2.full());
-	updateSingleNameMapItem(train, n1.down(), n2.down());
-	updateSingleNameMapItem(train, n1.up(), n2.up());
+	// n2为旧车次，n1为新车次
+	updateSingleNameMapItem(train, n2.full(), n1.full());
+	updateSingleNameMapItem(train, n2.down(), n1.down());
+	updateSingleNameMapItem(train, n2.up(), n1.up());
 	//类型
 	if (train->type() != info->type()) {
 		--_typeCount[info->type()];
@@ -330,9 +454,15 @@ QList<QString> TrainCollection::typeNames() const
 	return res;
 }
 
-diagram_diff_t TrainCollection::diffWith(const TrainCollection& other)
+diagram_diff_t TrainCollection::diffWith(const TrainCollection& other, const TaskContext& ctx)const
 {
 	diagram_diff_t res{};
+	res.reserve(_trains.size() + other._trains.size());
+	struct DiffPair {
+		size_t index;
+		std::shared_ptr<const Train> train1, train2;
+	};
+	QVector<DiffPair> pairs;
 	auto anotherFullMap = other.fullNameMap;   // copy construct
 	foreach(auto train, _trains) {
 		const auto& name = train->trainName().full();
@@ -341,11 +471,25 @@ diagram_diff_t TrainCollection::diffWith(const TrainCollection& other)
                                  TrainDifference::Deleted, train));
 		}
 		else {
-            res.emplace_back(std::make_shared<TrainDifference>(train, itr.value()));  // 最慢
+			// 先占位，下面并行计算
+			pairs.append({ res.size(), train, itr.value() });
+			res.emplace_back();
 			anotherFullMap.erase(itr);
 		}
 	}
 
+	// 2026.10  逐车次的时刻表对比（最慢）相互独立，并行计算后放回原位
+	ctx.setProgressRange(0, pairs.size());
+	std::atomic_int done{ 0 };
+	QtConcurrent::blockingMap(pairs, [&res, &ctx, &done](const DiffPair& p) {
+		if (ctx.isCanceled())
+			return;
+		res[p.index] = std::make_shared<TrainDifference>(p.train1, p.train2);
+		ctx.setProgressValue(++done);
+		});
+	if (ctx.isCanceled())
+		return {};
+
 	for (auto itr = anotherFullMap.begin(); itr != anotherFullMap.end(); ++itr) {
         res.emplace_back(std::make_shared<TrainDifference>(
                              TrainDifference::NewAdded, itr.value()));
@@ -369,15 +513,9 @@ void TrainCollection::addMapInfo(const std::shared_ptr<Train>& t)
 {
 	fullNameMap.insert(t->trainName().full(), t);
 	const TrainName& n = t->trainName();
-	if (!n.full().isEmpty()) {
-		singleNameMap[n.full()].append(t);
-	}
-	if (!n.down().isEmpty()) {
-		singleNameMap[n.down()].append(t);
-	}
-	if (!n.up().isEmpty()) {
-		singleNameMap[n.up()].append(t);
-	}
+	addSingleName(n.full(), t);
+	addSingleName(n.down(), t);
+	addSingleName(n.up(), t);
 	if (!t->type()) {
 		t->setType(_manager.fromRegex(t->trainName()));
 	}
@@ -388,15 +526,9 @@ void TrainCollection::removeMapInfo(std::shared_ptr<Train> t)
 {
 	fullNameMap.remove(t->trainName().full());
 	const auto& n = t->trainName();
-	if (!n.full().isEmpty()) {
-		singleNameMap[n.full()].removeAll(t);
-	}
-	if (!n.down().isEmpty()) {
-		singleNameMap[n.down()].removeAll(t);
-	}
-	if (!n.up().isEmpty()) {
-		singleNameMap[n.up()].removeAll(t);
-	}
+	removeSingleName(n.full(), t);
+	removeSingleName(n.down(), t);
+	removeSingleName(n.up(), t);
 	--_typeCount[t->type()];
 }
 
@@ -404,12 +536,32 @@ void TrainCollection::updateSingleNameMapItem(std::shared_ptr<Train> train,
 	const QString& oldName, const QString& newName)
 {
 	if (oldName != newName) {
-		if (!oldName.isEmpty()) {
-			singleNameMap[oldName].removeAll(train);
-		}
-		if (!newName.isEmpty()) {
-			singleNameMap[newName].append(train);
-		}
+		removeSingleName(oldName, train);
+		addSingleName(newName, train);
+	}
+}
+
+void TrainCollection::addSingleName(const QString& name, const std::shared_ptr<Train>& train)
+{
+	if (name.isEmpty())
+		return;
+	auto& lst = singleNameMap[name];
+	if (lst.isEmpty())
+		_nameIndex.addName(name);
+	lst.append(train);
+}
+
+void TrainCollection::removeSingleName(const QString& name, const std::shared_ptr<Train>& train)
+{
+	if (name.isEmpty())
+		return;
+	auto itr = singleNameMap.find(name);
+	if (itr == singleNameMap.end())
+		return;
+	itr.value().removeOne(train);
+	if (itr.value().isEmpty()) {
+		singleNameMap.erase(itr);
+		_nameIndex.removeName(name);
 	}
 }
 
@@ -418,6 +570,7 @@ void TrainCollection::resetMapInfo()
 {
 	fullNameMap.clear();
 	singleNameMap.clear();
+	_nameIndex.clear();
 	for (const auto& p : _trains) {
 		addMapInfo(p);
 	}
@@ -8,6 +8,9 @@
 
 #include "data/train/typemanager.h"
 #include "data/diagram/diadiff.h"
+#include "data/train/trainnameindex.h"
+#include "data/train/trainstationindex.h"
+#include "data/common/backgroundtask.h"
 
 class Railway;
 class Train;
@@ -35,6 +38,16 @@ class TrainCollection
     QHash<QString, std::shared_ptr<Train>> fullNameMap;
     QHash<QString, QList<std::shared_ptr<Train>>> singleNameMap;
 
+    /**
+     * 2026.10  singleNameMap中非空键的n-gram索引，用于multiSearchTrain
+     */
+    TrainNameIndex _nameIndex;
+
+    /**
+     * 2026.10  车站 -> (车次, 站序) 索引，查询时与列车集合同步，见TrainStationIndex
+     */
+    mutable TrainStationIndex _stationIndex;
+
     TypeManager _manager;
     QMap<std::shared_ptr<TrainType>, int> _typeCount;
 
@@ -53,6 +66,22 @@ public:
 
     void fromJson(const QJsonObject& obj, const TypeManager& defaultManager);
 
+    /**
+     * 2026.10  流式读取版本。obj中的trains不使用，
+     * 而是从rawTrains（trains数组的JSON原文）逐个车次解析，不构建整个数组的DOM。
+     * 数组或其中任一车次格式错误时，清空车次并返回false，不读入残缺数据。
+     */
+    bool fromJson(const QJsonObject& obj, const QByteArray& rawTrains,
+        const TypeManager& defaultManager);
+
+    /**
+     * 2026.10  二进制格式版本。obj中的trains不使用（一般解码时已跳过），
+     * 车次由qebinary::decodeTrains从data（整个二进制文件）直接构造。
+     * 车次数据损坏时，清空车次并返回false。
+     */
+    bool fromBinary(const QJsonObject& obj, const QByteArray& data,
+        const TypeManager& defaultManager);
+
     /**
      * 读取Diagram文件，但只要TrainCollection的部分。
      * 这个版本用来处理导入列车。
@@ -128,6 +157,8 @@ public:
     /**
      * pyETRC.Graph.multiSearch()  模糊查找车次
      * 全车次或分方向车次包含目标串即可
+     * 2026.10  经车次索引查找；结果按匹配位置（越靠前越优先）、全车次长度、全车次排序。
+     * name为空时返回全部车次。
      */
     QList<std::shared_ptr<Train>>
         multiSearchTrain(const QString& name);
@@ -202,6 +233,11 @@ public:
 
     inline int trainCount()const { return _trains.size(); }
 
+    /**
+     * 2026.10  车站索引。查询（find, findRegex）时传入trains()，自动与当前列车集合同步。
+     */
+    inline TrainStationIndex& stationIndex()const { return _stationIndex; }
+
     /**
      * 返回指定列车下标；如果找不到，返回-1.
      * 线性查找
@@ -248,8 +284,9 @@ public:
      * 2022年2月8日
      * pyETRC.Graph.diffWith
      * 基于DP的运行图对比算法
+     * 2026.10  ctx: 后台任务上下文，按车次报告进度；取消时返回空
      */
-    diagram_diff_t diffWith(const TrainCollection& other);
+    diagram_diff_t diffWith(const TrainCollection& other, const TaskContext& ctx = {})const;
 
     /**
      * 绑定到指定线路的列车集合
@@ -276,10 +313,21 @@ private:
     void updateSingleNameMapItem(std::shared_ptr<Train> train,
         const QString& oldName, const QString& newName);
 
+    /**
+     * 2026.10  单车次映射表增、删一项，同时维护车次索引
+     */
+    void addSingleName(const QString& name, const std::shared_ptr<Train>& train);
+    void removeSingleName(const QString& name, const std::shared_ptr<Train>& train);
+
     /**
      * @brief resetMapInfo 重置所有映射表信息
      */
     void resetMapInfo();
+
+    /**
+     * 读取交路。依赖车次查找，须在读入车次并resetMapInfo()之后调用
+     */
+    void routingsFromJson(const QJsonObject& obj);
 };
 
 
@@ -1,4 +1,5 @@
 ﻿#include "trainfiltercore.h"
+#include "traincollection.h"
 
 
 TrainFilterCore::TrainFilterCore(Diagram& diagram_):
@@ -68,9 +69,26 @@ bool TrainFilterCore::checkShow(std::shared_ptr<const Train> train) const
 
 bool TrainFilterCore::check(std::shared_ptr<const Train> train) const
 {
+    if (_fixed)
+        return _fixed->contains(train.get());
     bool res = (checkType(train)
         && checkRouting(train) && checkPassenger(train) && checkShow(train)
         && !checkExclude(train)) || checkInclude(train);
     if (useInverse)return !res;
     return res;
 }
+
+std::shared_ptr<const TrainFilterCore> TrainFilterCore::snapshotFilter(
+    const TrainCollection& coll, const TrainCollection& snapColl) const
+{
+    auto accepted = std::make_shared<QSet<const Train*>>();
+    const auto& trains = coll.trains();
+    const auto& clones = snapColl.trains();
+    for (int i = 0; i < trains.size() && i < clones.size(); i++) {
+        if (check(trains.at(i)))
+            accepted->insert(clones.at(i).get());
+    }
+    auto res = std::make_shared<TrainFilterCore>(diagram);
+    res->_fixed = std::move(accepted);
+    return res;
+}
@@ -8,6 +8,7 @@
 
 class TrainFilter;
 class Diagram;
+class TrainCollection;
 
 /**
  * 列车筛选器中，不带任何图形界面和SIGLAL/SLOT的数据部分。
@@ -27,6 +28,11 @@ class TrainFilterCore
     QSet<std::shared_ptr<const Routing>> routings;
     bool selNullRouting=false;
 
+    /**
+     * 2026.10  预先判定的结果（见snapshotFilter()）。非空时只通过其中的车次，不再使用上面的条件。
+     */
+    std::shared_ptr<const QSet<const Train*>> _fixed;
+
 
 public:
 
@@ -42,6 +48,15 @@ public:
     TrainFilterCore& operator=(TrainFilterCore&&) = delete;
 
     bool check(std::shared_ptr<const Train> train)const;
+
+    /**
+     * 2026.10  供在Diagram::snapshot()上运行的后台任务使用。须在主线程调用。
+     * 按本筛选器判定coll中的车次，结果按顺序对应到快照的车次集合snapColl
+     * （快照中的车次不带交路，不能直接判定）。
+     * 返回的筛选器只认这一结果，与本筛选器此后的修改无关，可在任意线程使用。
+     */
+    std::shared_ptr<const TrainFilterCore> snapshotFilter(const TrainCollection& coll,
+        const TrainCollection& snapColl)const;
 private:
     bool checkType(std::shared_ptr<const Train> train)const;
     bool checkInclude(std::shared_ptr<const Train> train)const;
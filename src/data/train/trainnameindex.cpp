@@ -0,0 +1,65 @@
+﻿#include "trainnameindex.h"
+
+void TrainNameIndex::addName(const QString& name)
+{
+    if (name.isEmpty() || _names.contains(name))
+        return;
+    _names.insert(name);
+    foreach(const auto & g, gramsOf(name)) {
+        _byGram[g].insert(name);
+    }
+}
+
+void TrainNameIndex::removeName(const QString& name)
+{
+    if (!_names.remove(name))
+        return;
+    foreach(const auto & g, gramsOf(name)) {
+        auto itr = _byGram.find(g);
+        if (itr != _byGram.end()) {
+            itr.value().remove(name);
+            if (itr.value().isEmpty())
+                _byGram.erase(itr);
+        }
+    }
+}
+
+void TrainNameIndex::clear()
+{
+    _byGram.clear();
+    _names.clear();
+}
+
+QStringList TrainNameIndex::search(const QString& text) const
+{
+    if (text.isEmpty())
+        return {};
+    if (text.size() <= 2)
+        return _byGram.value(text).values();
+
+    const QSet<QString>* cand = nullptr;
+    for (int i = 0; i + 1 < text.size(); i++) {
+        auto itr = _byGram.constFind(text.mid(i, 2));
+        if (itr == _byGram.constEnd())
+            return {};
+        if (!cand || itr.value().size() < cand->size())
+            cand = &itr.value();
+    }
+    QStringList res;
+    for (const auto& n : *cand) {
+        if (n.contains(text))
+            res.append(n);
+    }
+    return res;
+}
+
+QStringList TrainNameIndex::gramsOf(const QString& s)
+{
+    QStringList res;
+    for (int i = 0; i < s.size(); i++) {
+        res.append(s.mid(i, 1));
+        if (i + 1 < s.size())
+            res.append(s.mid(i, 2));
+    }
+    return res;
+}
@@ -0,0 +1,42 @@
+﻿#pragma once
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief The TrainNameIndex class
+ * 2026.10  车次字面的n-gram倒排索引：单字、双字片段 -> 含有该片段的车次字面。
+ * 登记的是TrainCollection::singleNameMap中的键（全车次及上下行车次），
+ * 由TrainCollection在维护查找表时同步增删，用于模糊查找车次。
+ */
+class TrainNameIndex
+{
+    QHash<QString, QSet<QString>> _byGram;
+    QSet<QString> _names;
+
+public:
+    TrainNameIndex() = default;
+
+    void addName(const QString& name);
+
+    /**
+     * 不存在时不做任何事
+     */
+    void removeName(const QString& name);
+
+    void clear();
+
+    inline int size()const { return _names.size(); }
+
+    /**
+     * 包含text的所有车次字面，无序。
+     * 不超过2个字符时直接取片段的登记表；否则取各双字片段中最短的登记表逐个验证。
+     * text为空时返回空表。
+     */
+    QStringList search(const QString& text)const;
+
+private:
+    static QStringList gramsOf(const QString& s);
+};
@@ -1,5 +1,5 @@
 ﻿#include "trainstation.h"
-#include "util/utilfunc.h"
+#include "data/common/timeutil.h"
 
 #include <QJsonObject>
 
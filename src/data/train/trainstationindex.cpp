@@ -0,0 +1,150 @@
+﻿#include "trainstationindex.h"
+#include "train.h"
+#include "trainstation.h"
+#include "timetablearrays.h"
+
+#include <QMutexLocker>
+#include <algorithm>
+
+TrainStationIndex::TrainStationIndex(TrainStationIndex&& other) noexcept :
+    _trains(std::move(other._trains)), _postings(std::move(other._postings)),
+    _names(std::move(other._names))
+{
+}
+
+TrainStationIndex& TrainStationIndex::operator=(TrainStationIndex&& other) noexcept
+{
+    _trains = std::move(other._trains);
+    _postings = std::move(other._postings);
+    _names = std::move(other._names);
+    return *this;
+}
+
+TrainStationIndex::hits_t TrainStationIndex::find(const QList<std::shared_ptr<Train>>& trains,
+    const std::vector<StationName>& names)
+{
+    QMutexLocker locker(&_lock);
+    sync(trains);
+    QHash<quint32, QSet<quint32>> want;
+    for (const auto& n : names) {
+        if (n.isBare()) {
+            want[n.stationId()].clear();
+        }
+        else if (auto itr = want.find(n.stationId()); itr == want.end()) {
+            want.insert(n.stationId(), QSet<quint32>{ n.id() });
+        }
+        else if (!itr.value().isEmpty()) {
+            itr.value().insert(n.id());
+        }
+    }
+    return collect(want);
+}
+
+TrainStationIndex::hits_t TrainStationIndex::findRegex(const QList<std::shared_ptr<Train>>& trains,
+    const std::vector<QRegularExpression>& regs)
+{
+    QMutexLocker locker(&_lock);
+    sync(trains);
+    QHash<quint32, QSet<quint32>> want;
+    for (auto itr = _names.cbegin(); itr != _names.cend(); ++itr) {
+        const QString& literal = itr.value().toSingleLiteral();
+        if (std::any_of(regs.begin(), regs.end(),
+            [&literal](const QRegularExpression& r) {return r.match(literal).hasMatch(); })) {
+            want[itr.value().stationId()].insert(itr.key());
+        }
+    }
+    return collect(want);
+}
+
+void TrainStationIndex::clear()
+{
+    QMutexLocker locker(&_lock);
+    _trains.clear();
+    _postings.clear();
+    _names.clear();
+}
+
+void TrainStationIndex::sync(const QList<std::shared_ptr<Train>>& trains)
+{
+    // 需要重新登记的车次，及其登记项所在的站
+    QSet<const Train*> stale;
+    QSet<quint32> staleStations;
+    auto markStale = [&](const Train* t, const TrainEntry& entry) {
+        stale.insert(t);
+        for (int i = 0; i < entry.arrays->size(); i++) {
+            staleStations.insert(_names.value(entry.arrays->nameId(i)).stationId());
+        }
+    };
+
+    QSet<const Train*> current;
+    current.reserve(trains.size());
+    std::vector<std::pair<const Train*, std::shared_ptr<const TimetableArrays>>> fresh;
+    for (const auto& train : trains) {
+        const Train* t = train.get();
+        current.insert(t);
+        auto arrays = train->timetableArrays();
+        auto itr = _trains.find(t);
+        if (itr != _trains.end()) {
+            if (itr.value().arrays == arrays && itr.value().train.lock() == train)
+                continue;
+            markStale(t, itr.value());
+        }
+        fresh.emplace_back(t, arrays);
+        _trains.insert(t, TrainEntry{ train, arrays });
+    }
+    for (auto itr = _trains.begin(); itr != _trains.end();) {
+        if (!current.contains(itr.key())) {
+            markStale(itr.key(), itr.value());
+            itr = _trains.erase(itr);
+        }
+        else {
+            ++itr;
+        }
+    }
+
+    if (!stale.isEmpty()) {
+        for (quint32 sid : staleStations) {
+            auto itr = _postings.find(sid);
+            if (itr == _postings.end())
+                continue;
+            auto& lst = itr.value();
+            lst.erase(std::remove_if(lst.begin(), lst.end(),
+                [&stale](const Posting& p) {return stale.contains(p.train); }), lst.end());
+            if (lst.empty())
+                _postings.erase(itr);
+        }
+    }
+    for (const auto& [t, arrays] : fresh) {
+        addPostings(t, *arrays);
+    }
+}
+
+void TrainStationIndex::addPostings(const Train* train, const TimetableArrays& arrays)
+{
+    for (int i = 0; i < arrays.size(); i++) {
+        const StationName& name = arrays.node(i)->name;
+        if (!_names.contains(name.id()))
+            _names.insert(name.id(), name);
+        _postings[name.stationId()].push_back(Posting{ train, i, name.id() });
+    }
+}
+
+TrainStationIndex::hits_t TrainStationIndex::collect(const QHash<quint32, QSet<quint32>>& want) const
+{
+    hits_t res;
+    for (auto itr = want.cbegin(); itr != want.cend(); ++itr) {
+        const auto& ids = itr.value();
+        auto lst = _postings.constFind(itr.key());
+        if (lst == _postings.cend())
+            continue;
+        for (const auto& p : lst.value()) {
+            if (ids.isEmpty() || ids.contains(p.nameId))
+                res[p.train].push_back(p.pos);
+        }
+    }
+    for (auto& positions : res) {
+        std::sort(positions.begin(), positions.end());
+        positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+    }
+    return res;
+}
@@ -0,0 +1,88 @@
+﻿#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QRegularExpression>
+#include <memory>
+#include <vector>
+
+#include "data/common/stationname.h"
+
+class Train;
+class TimetableArrays;
+
+/**
+ * @brief The TrainStationIndex class
+ * 2026.10  车站 -> (车次, 站序) 的倒排索引，用于全局（按站名）的区间车次表。
+ * 以站名部分（不含场名，StationName::stationId()）为键，查询时再按场名筛选，
+ * 与StationName::equalOrBelongsTo()的判定一致；正则查询对每个不同的站名只匹配一次。
+ *
+ * 索引按车次记录建立时所用的时刻表副本（Train::timetableArrays()），
+ * 每次查询前与列车集合比对：增删的车次、副本已失效（时刻表修改后invalidateTempData）的车次
+ * 重新登记，其余不动。由TrainCollection持有；查询加锁，可在后台任务中调用。
+ */
+class TrainStationIndex
+{
+public:
+    /**
+     * 车次 -> 匹配的站序，递增
+     */
+    using hits_t = QHash<const Train*, std::vector<int>>;
+
+private:
+    struct Posting {
+        const Train* train;
+        int pos;
+        quint32 nameId;
+    };
+
+    struct TrainEntry {
+        std::weak_ptr<const Train> train;
+        std::shared_ptr<const TimetableArrays> arrays;
+    };
+
+    QHash<const Train*, TrainEntry> _trains;
+    QHash<quint32, std::vector<Posting>> _postings;     // 站名部分编号 -> 登记项
+    QHash<quint32, StationName> _names;                 // 完整站名编号 -> 站名
+
+    mutable QMutex _lock;
+
+public:
+    TrainStationIndex() = default;
+
+    /**
+     * 不复制锁；移动时也不加锁，调用方保证此时没有查询
+     */
+    TrainStationIndex(TrainStationIndex&& other)noexcept;
+    TrainStationIndex& operator=(TrainStationIndex&& other)noexcept;
+
+    /**
+     * 时刻表中有站名与names之一相同或属于之（names中的无场名站名包含各场）的车次及站序。
+     */
+    hits_t find(const QList<std::shared_ptr<Train>>& trains,
+        const std::vector<StationName>& names);
+
+    /**
+     * 站名（单字面形式）与regs之一匹配的车次及站序。
+     */
+    hits_t findRegex(const QList<std::shared_ptr<Train>>& trains,
+        const std::vector<QRegularExpression>& regs);
+
+    void clear();
+
+private:
+    /**
+     * 与列车集合同步，须已加锁
+     */
+    void sync(const QList<std::shared_ptr<Train>>& trains);
+
+    void addPostings(const Train* train, const TimetableArrays& arrays);
+
+    /**
+     * 查询的公共部分：want为站名部分编号 -> 所要的完整站名编号，空集表示该站的所有场。
+     * 各登记项按车次分组，站序排序、去重。
+     */
+    hits_t collect(const QHash<quint32, QSet<quint32>>& want)const;
+};
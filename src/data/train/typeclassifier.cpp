@@ -0,0 +1,323 @@
+﻿#include "typeclassifier.h"
+
+#include <QMutexLocker>
+#include <algorithm>
+
+bool TypeClassifier::CharSet::contains(QChar ch) const
+{
+    if (any)
+        return true;
+    const ushort u = ch.unicode();
+    bool in = false;
+    for (const auto& r : ranges) {
+        if (u >= r.first && u <= r.second) {
+            in = true;
+            break;
+        }
+    }
+    if (!in && classes) {
+        in = ((classes & Digit) && ch.isDigit()) ||
+            ((classes & Space) && ch.isSpace()) ||
+            ((classes & Word) && (ch.isLetterOrNumber() || ch.isMark() || ch == '_'));
+    }
+    if (!in && negClasses) {
+        in = ((negClasses & Digit) && !ch.isDigit()) ||
+            ((negClasses & Space) && !ch.isSpace()) ||
+            ((negClasses & Word) && !(ch.isLetterOrNumber() || ch.isMark() || ch == '_'));
+    }
+    return negate ? !in : in;
+}
+
+bool TypeClassifier::CharSet::mayContainNonAscii() const
+{
+    if (any || negate || classes || negClasses)
+        return true;
+    for (const auto& r : ranges) {
+        if (r.second >= 128)
+            return true;
+    }
+    return false;
+}
+
+bool TypeClassifier::Rule::match(const QString& name) const
+{
+    if (!compiled) {
+        QRegExp rx(fallback);   // indexIn会修改捕获状态，用副本
+        return rx.indexIn(name) == 0;
+    }
+
+    // 位k表示下一个待匹配的项为第k项；位n表示全部项已匹配
+    const int n = static_cast<int>(items.size());
+    const quint64 accept = quint64(1) << n;
+    auto closure = [this, n](quint64 s) {
+        for (int k = 0; k < n; k++) {
+            if ((s >> k & 1) && items[k].kind != Item::One)
+                s |= quint64(1) << (k + 1);
+        }
+        return s;
+    };
+
+    quint64 s = closure(1);
+    for (const QChar& ch : name) {
+        if (!anchoredEnd && (s & accept))
+            return true;
+        quint64 next = 0;
+        for (int k = 0; k < n; k++) {
+            if ((s >> k & 1) && items[k].set.contains(ch))
+                next |= quint64(1) << (items[k].kind == Item::Star ? k : k + 1);
+        }
+        if (!next)
+            return false;
+        s = closure(next);
+    }
+    return s & accept;
+}
+
+TypeClassifier::TypeClassifier(const regex_list_t& regs)
+{
+    _rules.resize(regs.size());
+    for (int i = 0; i < regs.size(); i++) {
+        Rule& rule = _rules[i];
+        const QRegExp& rx = regs.at(i).first;
+        bool ok = rx.isValid() && rx.caseSensitivity() == Qt::CaseSensitive &&
+            (rx.patternSyntax() == QRegExp::RegExp || rx.patternSyntax() == QRegExp::RegExp2) &&
+            compile(rx.pattern(), rule);
+        if (!ok) {
+            rule = Rule{};
+            rule.fallback = rx;
+        }
+        rule.compiled = ok;
+
+        // 可以为空匹配的规则或无法分析的规则，对任意车次都要尝试
+        bool nullable = std::all_of(rule.items.begin(), rule.items.end(),
+            [](const Item& it) {return it.kind != Item::One; });
+        if (!ok || nullable) {
+            for (auto& lst : _byFirst)
+                lst.push_back(i);
+            _others.push_back(i);
+            _empty.push_back(i);
+            continue;
+        }
+
+        // 首字符可能匹配的项：直到第一个必须匹配的项为止
+        std::vector<const CharSet*> firsts;
+        for (const auto& it : rule.items) {
+            firsts.push_back(&it.set);
+            if (it.kind == Item::One)
+                break;
+        }
+        for (ushort c = 0; c < 128; c++) {
+            if (std::any_of(firsts.begin(), firsts.end(),
+                [c](const CharSet* st) {return st->contains(QChar(c)); }))
+                _byFirst[c].push_back(i);
+        }
+        if (std::any_of(firsts.begin(), firsts.end(),
+            [](const CharSet* st) {return st->mayContainNonAscii(); }))
+            _others.push_back(i);
+    }
+}
+
+int TypeClassifier::classify(const QString& name) const
+{
+    {
+        QMutexLocker locker(&_memoLock);
+        if (auto itr = _memo.constFind(name); itr != _memo.constEnd())
+            return itr.value();
+    }
+    int res = classifyNoMemo(name);
+    QMutexLocker locker(&_memoLock);
+    if (_memo.size() >= MAX_MEMO)
+        _memo.clear();
+    _memo.insert(name, res);
+    return res;
+}
+
+int TypeClassifier::compiledCount() const
+{
+    return static_cast<int>(std::count_if(_rules.begin(), _rules.end(),
+        [](const Rule& r) {return r.compiled; }));
+}
+
+int TypeClassifier::classifyNoMemo(const QString& name) const
+{
+    const std::vector<int>* cand;
+    if (name.isEmpty())
+        cand = &_empty;
+    else {
+        ushort u = name.at(0).unicode();
+        cand = u < 128 ? &_byFirst[u] : &_others;
+    }
+    for (int i : *cand) {
+        if (_rules[i].match(name))
+            return i;
+    }
+    return -1;
+}
+
+bool TypeClassifier::compile(const QString& pattern, Rule& rule)
+{
+    int pos = 0;
+    const int len = pattern.size();
+    if (len > 0 && pattern.at(0) == '^')
+        pos++;
+    while (pos < len) {
+        if (pattern.at(pos) == '$') {
+            if (pos != len - 1)
+                return false;
+            rule.anchoredEnd = true;
+            break;
+        }
+        CharSet set;
+        int min, max;
+        if (!parseAtom(pattern, pos, set) || !parseQuantifier(pattern, pos, min, max))
+            return false;
+        if ((max != -1 && max < min) || min > MAX_ITEMS || max > MAX_ITEMS)
+            return false;
+        for (int k = 0; k < min; k++)
+            rule.items.push_back({ set, Item::One });
+        if (max == -1)
+            rule.items.push_back({ set, Item::Star });
+        else {
+            for (int k = min; k < max; k++)
+                rule.items.push_back({ set, Item::Optional });
+        }
+        if (rule.items.size() > MAX_ITEMS)
+            return false;
+    }
+    return true;
+}
+
+bool TypeClassifier::parseAtom(const QString& pattern, int& pos, CharSet& set)
+{
+    const int len = pattern.size();
+    const QChar ch = pattern.at(pos);
+    switch (ch.unicode()) {
+    case '(': case ')': case '|': case '*': case '+': case '?':
+    case '{': case '}': case '^': case '$': case ']':
+        return false;
+    case '.':
+        set.any = true;
+        pos++;
+        return true;
+    case '\\':
+        if (pos + 1 >= len || !parseEscape(pattern.at(pos + 1), set))
+            return false;
+        pos += 2;
+        return true;
+    case '[':
+        break;
+    default:
+        set.ranges.append(qMakePair(ch.unicode(), ch.unicode()));
+        pos++;
+        return true;
+    }
+
+    // 字符类
+    pos++;
+    if (pos < len && pattern.at(pos) == '^') {
+        set.negate = true;
+        pos++;
+    }
+    bool first = true;
+    while (true) {
+        if (pos >= len)
+            return false;
+        QChar c = pattern.at(pos);
+        if (c == ']') {
+            if (first)
+                return false;
+            pos++;
+            return true;
+        }
+        first = false;
+        QChar lo;
+        if (c == '\\') {
+            if (pos + 1 >= len)
+                return false;
+            QChar e = pattern.at(pos + 1);
+            pos += 2;
+            if (QString("dDsSwW").contains(e)) {
+                parseEscape(e, set);
+                continue;
+            }
+            if (e.isLetterOrNumber())
+                return false;
+            lo = e;
+        }
+        else if (c == '[') {
+            return false;   // [:digit:]等
+        }
+        else {
+            lo = c;
+            pos++;
+        }
+        QChar hi = lo;
+        if (pos + 1 < len && pattern.at(pos) == '-' && pattern.at(pos + 1) != ']') {
+            hi = pattern.at(pos + 1);
+            if (hi == '\\' || hi == '[' || hi < lo)
+                return false;
+            pos += 2;
+        }
+        set.ranges.append(qMakePair(lo.unicode(), hi.unicode()));
+    }
+}
+
+bool TypeClassifier::parseEscape(QChar ch, CharSet& set)
+{
+    switch (ch.unicode()) {
+    case 'd': set.classes |= CharSet::Digit; return true;
+    case 'D': set.negClasses |= CharSet::Digit; return true;
+    case 's': set.classes |= CharSet::Space; return true;
+    case 'S': set.negClasses |= CharSet::Space; return true;
+    case 'w': set.classes |= CharSet::Word; return true;
+    case 'W': set.negClasses |= CharSet::Word; return true;
+    case 'n': set.ranges.append(qMakePair(ushort('\n'), ushort('\n'))); return true;
+    case 't': set.ranges.append(qMakePair(ushort('\t'), ushort('\t'))); return true;
+    default:
+        // \b、反向引用、\x等不支持；其余为转义的普通字符
+        if (ch.isLetterOrNumber())
+            return false;
+        set.ranges.append(qMakePair(ch.unicode(), ch.unicode()));
+        return true;
+    }
+}
+
+bool TypeClassifier::parseQuantifier(const QString& pattern, int& pos, int& min, int& max)
+{
+    const int len = pattern.size();
+    min = max = 1;
+    if (pos >= len)
+        return true;
+    switch (pattern.at(pos).unicode()) {
+    case '*': min = 0; max = -1; pos++; break;
+    case '+': min = 1; max = -1; pos++; break;
+    case '?': min = 0; max = 1; pos++; break;
+    case '{': {
+        int end = pattern.indexOf('}', pos);
+        if (end == -1)
+            return false;
+        const QString& body = pattern.mid(pos + 1, end - pos - 1);
+        int comma = body.indexOf(',');
+        bool ok1 = true, ok2 = true;
+        if (comma == -1) {
+            min = max = body.toInt(&ok1);
+        }
+        else {
+            min = body.left(comma).toInt(&ok1);
+            const QString& right = body.mid(comma + 1);
+            max = right.isEmpty() ? -1 : right.toInt(&ok2);
+            if (!right.isEmpty() && max < 0)
+                return false;
+        }
+        if (!ok1 || !ok2 || min < 0)
+            return false;
+        pos = end + 1;
+    }break;
+    default:
+        return true;
+    }
+    // 不支持叠加的量词
+    if (pos < len && QString("*+?{").contains(pattern.at(pos)))
+        return false;
+    return true;
+}
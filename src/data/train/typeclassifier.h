@@ -0,0 +1,118 @@
+﻿#pragma once
+
+#include <QString>
+#include <QRegExp>
+#include <QVector>
+#include <QPair>
+#include <QHash>
+#include <QMutex>
+#include <array>
+#include <vector>
+#include <memory>
+
+class TrainType;
+
+/**
+ * 2026.10  由TypeManager::_regs编译得到的车次类型判定器，只读（查询缓存除外）。
+ * 语义与逐个尝试QRegExp::indexIn(name)==0一致：返回第一个在车次开头匹配的规则。
+ *
+ * 车次类型的正则绝大多数形如 G\d+、[1-5]\d{3}$、0[GDCZTKY]\d+，
+ * 只由单字符、字符类及其重复构成。这类规则展开为不超过63项的序列，
+ * 以位集模拟NFA逐字符匹配，没有回溯；其余规则（分组、选择等）退回QRegExp。
+ * 按车次首字符预先分好候选规则表（保持原顺序），只尝试首字符可能匹配的规则。
+ * 另按全车次缓存结果：同一车次反复判定（导入、自动类型等）时直接返回。
+ *
+ * 规则表变化后，应由TypeManager重新构造。
+ */
+class TypeClassifier
+{
+public:
+    using regex_list_t = QVector<QPair<QRegExp, std::shared_ptr<TrainType>>>;
+
+private:
+    /**
+     * 字符集合：若干区间及\d \s \w类，可取反
+     */
+    struct CharSet {
+        enum Class : quint8 {
+            NoClass = 0,
+            Digit = 0b001,
+            Space = 0b010,
+            Word = 0b100,
+        };
+        QVector<QPair<ushort, ushort>> ranges;
+        quint8 classes = NoClass, negClasses = NoClass;   // negClasses: \D \S \W
+        bool negate = false;
+        bool any = false;
+
+        bool contains(QChar ch)const;
+
+        /**
+         * 是否可能包含非ASCII字符（保守判断）
+         */
+        bool mayContainNonAscii()const;
+    };
+
+    struct Item {
+        enum Kind : quint8 {
+            One,        // 恰好一次
+            Optional,   // 零或一次
+            Star,       // 任意次
+        };
+        CharSet set;
+        Kind kind;
+    };
+
+    struct Rule {
+        bool compiled = false;
+        bool anchoredEnd = false;     // 以$结尾
+        std::vector<Item> items;
+        QRegExp fallback;
+
+        bool match(const QString& name)const;
+    };
+
+    std::vector<Rule> _rules;
+
+    /**
+     * ASCII首字符的候选规则表；非ASCII首字符用_others，空车次用_empty
+     */
+    std::array<std::vector<int>, 128> _byFirst;
+    std::vector<int> _others, _empty;
+
+    mutable QMutex _memoLock;
+    mutable QHash<QString, int> _memo;
+
+    static constexpr int MAX_ITEMS = 63;
+    static constexpr int MAX_MEMO = 1 << 16;
+
+public:
+    explicit TypeClassifier(const regex_list_t& regs);
+
+    /**
+     * 第一个匹配的规则在规则表中的下标；都不匹配返回-1
+     */
+    int classify(const QString& name)const;
+
+    /**
+     * 可编译的规则数，其余退回QRegExp
+     */
+    int compiledCount()const;
+
+private:
+    static bool compile(const QString& pattern, Rule& rule);
+
+    /**
+     * 从pattern[pos]开始读入一个原子（单字符、转义或字符类），pos移到其后
+     */
+    static bool parseAtom(const QString& pattern, int& pos, CharSet& set);
+
+    static bool parseEscape(QChar ch, CharSet& set);
+
+    /**
+     * 读入量词，没有量词时min=max=1；max为-1表示无上界
+     */
+    static bool parseQuantifier(const QString& pattern, int& pos, int& min, int& max);
+
+    int classifyNoMemo(const QString& name)const;
+};
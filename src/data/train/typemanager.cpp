@@ -1,6 +1,7 @@
 ﻿#include "typemanager.h"
 #include "traintype.h"
 #include "trainname.h"
+#include "typeclassifier.h"
 
 #include <QJsonObject>
 
@@ -14,6 +15,7 @@ TypeManager& TypeManager::operator=(const TypeManager& another)
 {
     _types.clear();
     _regs.clear();
+    invalidateClassifier();
     for (auto p=another._types.begin();p!=another._types.end();++p) {
         _types.insert(p.key(), std::make_shared<TrainType>(*(p.value())));
     }
@@ -37,6 +39,7 @@ void TypeManager::readForDiagram(const QJsonObject& obj, const TypeManager& defa
 {
     _types.clear();
     _regs.clear();
+    invalidateClassifier();
     if (!obj.contains("type_regex")) {
         //没有regex的旧版图，先应用默认的，再在上面修改
         operator=(defaultManager);
@@ -59,22 +62,21 @@ std::shared_ptr<TrainType> TypeManager::addType(const QString& name, const QPen&
 void TypeManager::appendRegex(const QRegExp& reg, const QString& name)
 {
     _regs.append(qMakePair(reg, findOrCreate(name)));
+    invalidateClassifier();
 }
 
 std::shared_ptr<TrainType> TypeManager::appendRegex(const QRegExp& reg, const QString& name, bool passenger)
 {
     auto t = findOrCreate(name, passenger);
     _regs.append(qMakePair(reg, t));
+    invalidateClassifier();
     return t;
 }
 
 std::shared_ptr<TrainType> TypeManager::fromRegex(const TrainName& name) const
 {
-    for (const auto& p : _regs) {
-        if (p.first.indexIn(name.full()) == 0)
-            return p.second;
-    }
-    return defaultType;
+    int idx = classifier()->classify(name.full());
+    return idx >= 0 ? _regs.at(idx).second : defaultType;
 }
 
 std::shared_ptr<TrainType> TypeManager::findOrCreate(const QString& name)
@@ -118,6 +120,23 @@ void TypeManager::swapForRegex(TypeManager& other)
 {
     std::swap(_types, other._types);
     std::swap(_regs, other._regs);
+    invalidateClassifier();
+    other.invalidateClassifier();
+}
+
+std::shared_ptr<const TypeClassifier> TypeManager::classifier() const
+{
+    auto res = std::atomic_load(&_classifier);
+    if (!res) {
+        res = std::make_shared<const TypeClassifier>(_regs);
+        std::atomic_store(&_classifier, res);
+    }
+    return res;
+}
+
+void TypeManager::invalidateClassifier()
+{
+    std::atomic_store(&_classifier, std::shared_ptr<const TypeClassifier>{});
 }
 
 //TypeManager::~TypeManager() noexcept
@@ -4,6 +4,7 @@
 
 class TrainName;
 class TrainType;
+class TypeClassifier;
 #pragma once
 
 
@@ -28,6 +29,11 @@ class TypeManager{
      */
     QVector<QPair<QRegExp, std::shared_ptr<TrainType>>> _regs;
 
+    /**
+     * 2026.10  由_regs编译的判定器，fromRegex()时按需构造；_regs变化时置空
+     */
+    mutable std::shared_ptr<const TypeClassifier> _classifier;
+
     /**
      * 默认的版本。注意这个不应该是static，因为系统Config和默认Config指定的默认颜色可能不同。
      * 2021.08.13  增加一个默认客车用的pen。如果能确定是客车，就先用这个
@@ -81,6 +87,10 @@ public:
      */
     std::shared_ptr<TrainType> appendRegex(const QRegExp& reg, const QString& name, bool passenger);
 
+    /**
+     * 第一个在车次开头匹配的正则所对应的类型；都不匹配返回默认类型。
+     * 2026.10  经编译的TypeClassifier判定，结果与逐个QRegExp::indexIn一致
+     */
     std::shared_ptr<TrainType> fromRegex(const TrainName& name)const;
 
     /**
@@ -115,7 +125,10 @@ public:
 
     auto& regex()const { return _regs; }
 
-    auto& regexRef() { return _regs; }
+    /**
+     * 返回可修改的引用，因此同时使编译的判定器失效
+     */
+    auto& regexRef() { invalidateClassifier(); return _regs; }
 
     /**
      * 交换_types和_regs；都是浅拷贝。
@@ -125,6 +138,10 @@ public:
     // ~TypeManager()noexcept;
 
 private:
+    std::shared_ptr<const TypeClassifier> classifier()const;
+
+    void invalidateClassifier();
+
     /**
      * 输入格式是pyETRC的config.json或者graph中config对象
      * 返回是否成功
@@ -537,11 +537,13 @@ qecmd::ChangePageConfig::ChangePageConfig(Config& cfg_, const Config& newcfg_, b
 void qecmd::ChangePageConfig::undo()
 {
     std::swap(cfg, newcfg);
+    page->markConfigChanged(newcfg, cfg);
     cat->commitPageConfigChange(page, repaint);
 }
 void qecmd::ChangePageConfig::redo()
 {
     std::swap(cfg, newcfg);
+    page->markConfigChanged(newcfg, cfg);
     cat->commitPageConfigChange(page, repaint);
 }
 #endif
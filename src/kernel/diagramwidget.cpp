@@ -8,6 +8,7 @@
 #include <QGraphicsScene>
 #include <QScrollBar>
 #include <QList>
+#include <QSet>
 #include <QPair>
 #include <QMouseEvent>
 #include <cmath>
@@ -68,6 +69,38 @@ void DiagramWidget::paintGraph()
     _selectedTrain = nullptr;
     emit showNewStatus(QString("正在铺画运行图"));
 
+    paintGrid();
+
+    //todo: 绘制提示进度条
+    for (auto p : _diagram.trainCollection().trains()) {
+        paintTrain(p);
+    }
+
+    showAllForbids();
+    
+    connect(verticalScrollBar(), SIGNAL(valueChanged(int)),
+        this, SLOT(updateTimeAxis()));
+    connect(horizontalScrollBar(), SIGNAL(valueChanged(int)),
+        this, SLOT(updateDistanceAxis()));
+
+    updating = false;
+
+    updateTimeAxis();
+    updateDistanceAxis();
+    auto clock_end = std::chrono::system_clock::now();
+    emit showNewStatus(QObject::tr("运行图 [%1] 铺画完毕  用时%2毫秒").arg(_page->name())
+        .arg((clock_end - clock_start) / std::chrono::milliseconds(1)));
+}
+
+void DiagramWidget::paintGrid()
+{
+    // 记下已有的顶层图元，新增的即为底图图元
+    QSet<QGraphicsItem*> existing;
+    foreach(auto* it, scene()->items()) {
+        if (!it->parentItem())
+            existing.insert(it);
+    }
+
     const Config& cfg = config();
     const auto& margins = cfg.margins;
     int hstart = cfg.start_hour, hend = cfg.end_hour;
@@ -115,31 +148,74 @@ void DiagramWidget::paintGraph()
     marginItems.left->setZValue(15);
     marginItems.right = scene()->createItemGroup(rightItems);
     marginItems.right->setZValue(15);
-    
-    //todo: 绘制提示进度条
-    for (auto p : _diagram.trainCollection().trains()) {
-        paintTrain(p);
+
+    gridItems.clear();
+    foreach(auto* it, scene()->items()) {
+        if (!it->parentItem() && !existing.contains(it))
+            gridItems.append(it);
     }
+}
 
-    showAllForbids();
-    
-    connect(verticalScrollBar(), SIGNAL(valueChanged(int)),
-        this, SLOT(updateTimeAxis()));
-    connect(horizontalScrollBar(), SIGNAL(valueChanged(int)),
-        this, SLOT(updateDistanceAxis()));
+void DiagramWidget::clearGrid()
+{
+    foreach(auto* it, gridItems) {
+        scene()->removeItem(it);
+        delete it;
+    }
+    gridItems.clear();
+    marginItems = {};
+    nowItem = nullptr;
+}
 
+void DiagramWidget::updateGraph()
+{
+    auto flags = _page->dirty();
+    if (flags.testFlag(DiagramPage::DirtyLayout)) {
+        paintGraph();
+        return;
+    }
+    if (!_page->isDirty())
+        return;
+    auto clock_start = std::chrono::system_clock::now();
+    updating = true;
+    if (flags.testFlag(DiagramPage::DirtyGrid)) {
+        clearGrid();
+        paintGrid();
+        if (_selectedTrain)
+            nowItem->setText(_selectedTrain->trainName().full());
+    }
+    if (flags.testFlag(DiagramPage::DirtyTrains)) {
+        auto sel = _selectedTrain;
+        for (auto p : _diagram.trainCollection().trains()) {
+            removeTrain(*p);
+        }
+        for (auto p : _diagram.trainCollection().trains()) {
+            paintTrain(p);
+        }
+        if (sel) {
+            _selectedTrain = sel;
+            highlightTrain(sel);
+        }
+    }
+    else {
+        foreach(auto train, _page->dirtyTrains()) {
+            repaintTrain(train);
+        }
+    }
+    _page->clearDirty();
     updating = false;
 
     updateTimeAxis();
     updateDistanceAxis();
     auto clock_end = std::chrono::system_clock::now();
-    emit showNewStatus(QObject::tr("运行图 [%1] 铺画完毕  用时%2毫秒").arg(_page->name())
+    emit showNewStatus(QObject::tr("运行图 [%1] 更新完毕  用时%2毫秒").arg(_page->name())
         .arg((clock_end - clock_start) / std::chrono::milliseconds(1)));
 }
 
 void DiagramWidget::clearGraph()
 {
     weakItem = nullptr;
+    gridItems.clear();
     _page->clearGraphics();
     scene()->clear();
 }
@@ -1089,7 +1165,8 @@ void DiagramWidget::selectTrain(TrainItem* item)
 
     emit railFocussedIn(item->trainLine()->railway());
     _selectedTrain = item->train();
-    _page->highlightTrainItems(*_selectedTrain);
+    for (auto* item : _page->trainItems(*_selectedTrain))
+        item->highlight();
 
     nowItem->setText(_selectedTrain->trainName().full());
 
@@ -1104,7 +1181,8 @@ void DiagramWidget::unselectTrain()
     if (updating)
         return;
     if (_selectedTrain) {
-        _page->unhighlightTrainItems(*_selectedTrain);
+        for (auto* item : _page->trainItems(*_selectedTrain))
+            item->unhighlight();
         _selectedTrain = nullptr;
         nowItem->setText(" ");
     }
@@ -1371,7 +1449,8 @@ void DiagramWidget::highlightTrain(std::shared_ptr<Train> train)
     _selectedTrain = train;
 
     setTrainShow(train, true);
-    _page->highlightTrainItems(*_selectedTrain);
+    for (auto* item : _page->trainItems(*_selectedTrain))
+        item->highlight();
 
     nowItem->setText(_selectedTrain->trainName().full());
     showWeakenItem();
@@ -1382,7 +1461,8 @@ void DiagramWidget::highlightRouting(std::shared_ptr<Routing> routing)
     for (auto& p : routing->order()) {
         if (p.isVirtual())
             continue;
-        _page->highlightTrainItemsWithLink(*(p.train()));
+        for (auto* item : _page->trainItems(*(p.train())))
+            item->highlightWithLink();
     }
     showWeakenItem();
 }
@@ -1392,7 +1472,8 @@ void DiagramWidget::unhighlightRouting(std::shared_ptr<Routing> routing)
     for (auto& p : routing->order()) {
         if (p.isVirtual())
             continue;
-        _page->unhighlightTrainItemsWithLink(*(p.train()));
+        for (auto* item : _page->trainItems(*(p.train())))
+            item->unhighlightWithLink();
     }
     hideWeakenItem();
 }
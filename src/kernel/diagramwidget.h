@@ -63,6 +63,11 @@ class DiagramWidget : public QGraphicsView
         QGraphicsItemGroup* left, * right, * top, * bottom;
     } marginItems;
     //显示当前车次的Item
+    /**
+     * 2026.10  底图（网格、站名、表头）的顶层图元，用于单独重建底图
+     */
+    QList<QGraphicsItem*> gridItems;
+
     QGraphicsSimpleTextItem* nowItem;
     QGraphicsRectItem* weakItem = nullptr;
     qeutil::QEBalloonTip* posTip = nullptr;
@@ -98,6 +103,13 @@ public:
      */
     void paintGraph();
 
+    /**
+     * 2026.10
+     * 按DiagramPage的脏标记增量更新：只重建受影响的图元。
+     * DirtyLayout时退化为paintGraph()；没有标记则不做任何事。完成后清除标记。
+     */
+    void updateGraph();
+
     /**
      * 暴力清空图元、所有映射关系。用在重新铺画之前。
      * 主要原因：如果发生了重新绑定，则TrainLine数据失效，原有的映射失效，
@@ -177,6 +189,17 @@ protected:
     virtual void contextMenuEvent(QContextMenuEvent* e)override;
 
 private:
+    /**
+     * 2026.10  从paintGraph()拆出：绘制底图并计算各线路起始纵坐标，
+     * 新增的顶层图元记入gridItems
+     */
+    void paintGrid();
+
+    /**
+     * 删除gridItems中的底图图元
+     */
+    void clearGrid();
+
 
     /**
      * @brief pyETRC.GraphicsWidget._initHLines()
@@ -16,6 +16,9 @@
 #include <SARibbonCustomizeDialog.h>
 #include <QXmlStreamWriter>
 #include <QMimeData>
+#include <QProgressDialog>
+#include <QFutureWatcher>
+#include <QEventLoop>
 
 #include "model/train/trainlistmodel.h"
 #include "editors/trainlistwidget.h"
@@ -199,6 +202,16 @@ void MainWindow::updatePageDiagram(std::shared_ptr<DiagramPage> pg)
 	}
 }
 
+void MainWindow::refreshPageDiagram(std::shared_ptr<DiagramPage> pg)
+{
+	foreach(auto w, diagramWidgets) {
+		if (w->page() == pg) {
+			w->updateGraph();
+			break;
+		}
+	}
+}
+
 void MainWindow::onTrainsImported()
 {
 	updateAllDiagrams();
@@ -1472,9 +1485,13 @@ bool MainWindow::openGraph(const QString& filename)
 
 	Diagram dia;
 	dia.readDefaultConfigs();   //暂定这里读取一次默认配置，防止move时丢失数据
-	bool flag = dia.fromJson(filename);
+	bool flag = dia.fromJson(filename, false);
 
 	if (flag && !dia.isNull()) {
+		if (!bindTrainsWithProgress(dia)) {
+			showStatus(tr("已取消打开运行图 %1").arg(filename));
+			return false;
+		}
 		beforeResetGraph();
 		_diagram = std::move(dia);   //move assign
 		endResetGraph();
@@ -1487,6 +1504,30 @@ bool MainWindow::openGraph(const QString& filename)
 	}
 }
 
+bool MainWindow::bindTrainsWithProgress(Diagram& dia)
+{
+	QFutureWatcher<Diagram::TrainAdapterList> watcher;
+	QProgressDialog progress(tr("正在绑定车次与线路..."),
+		tr("取消"), 0, dia.trainCollection().trainCount(), this);
+	progress.setWindowTitle(tr("绑定车次"));
+	progress.setWindowModality(Qt::ApplicationModal);
+	// 立即显示：嵌套的事件循环期间不得再操作主窗口（如打开另一运行图）
+	progress.setMinimumDuration(0);
+	progress.show();
+
+	QEventLoop loop;
+	connect(&watcher, &QFutureWatcher<Diagram::TrainAdapterList>::progressValueChanged,
+		&progress, &QProgressDialog::setValue);
+	connect(&watcher, &QFutureWatcher<Diagram::TrainAdapterList>::finished,
+		&loop, &QEventLoop::quit);
+	connect(&progress, &QProgressDialog::canceled,
+		&watcher, &QFutureWatcher<Diagram::TrainAdapterList>::cancel);
+	watcher.setFuture(dia.bindAllTrainsAsync());
+	if (!watcher.isFinished())
+		loop.exec();
+	return dia.commitBinding(watcher.future());
+}
+
 void MainWindow::addTrainLine(Train& train)
 {
 	for (auto p : diagramWidgets)
@@ -1813,6 +1854,7 @@ void MainWindow::actOpenRailStationWidget(std::shared_ptr<Railway> rail)
 void MainWindow::commitPassedStationChange(int n)
 {
 	_diagram.config().max_passed_stations = n;
+	// 在撤销命令中调用，同步绑定（与refreshAll一致），不进入嵌套的事件循环
 	_diagram.rebindAllTrains();
 	trainListWidget->getModel()->updateAllMileSpeed();
 	updateAllDiagrams();
@@ -1882,7 +1924,7 @@ void MainWindow::actOpenGraph()
 	if (changed && !saveQuestion())
 		return;
 	QString res = QFileDialog::getOpenFileName(this, QObject::tr("打开"), QString(),
-		QObject::tr("pyETRC运行图文件(*.pyetgr;*.json)\nETRC运行图文件(*.trc)\n所有文件(*.*)"));
+		QObject::tr("pyETRC运行图文件(*.pyetgr;*.json)\nqETRC二进制运行图文件(*.qetgrb)\nETRC运行图文件(*.trc)\n所有文件(*.*)"));
 	if (res.isNull())
 		return;
 	auto start = std::chrono::system_clock::now();
@@ -1922,7 +1964,7 @@ void MainWindow::actSaveGraph()
 void MainWindow::actSaveGraphAs()
 {
 	QString res = QFileDialog::getSaveFileName(this, QObject::tr("另存为"), "",
-		tr("pyETRC运行图文件(*.pyetgr;*.json)\nETRC运行图文件(*.trc)\n所有文件(*.*)"));
+		tr("pyETRC运行图文件(*.pyetgr;*.json)\nqETRC二进制运行图文件(*.qetgrb)\nETRC运行图文件(*.trc)\n所有文件(*.*)"));
 	if (res.isNull())
 		return;
 	auto start = std::chrono::system_clock::now();
@@ -2069,6 +2111,8 @@ void MainWindow::removePageAt(int index)
 
 void MainWindow::markChanged()
 {
+	// 任何修改操作都经过这里（undoStack::indexChanged），统一使缓存失效
+	_diagram.invalidateTempData();
 	if (!changed) {
 		changed = true;
 		updateWindowTitle();
@@ -2148,16 +2192,21 @@ void MainWindow::focusOutRouting()
 
 void MainWindow::repaintRoutingTrainLines(std::shared_ptr<Routing> routing)
 {
+	QSet<std::shared_ptr<Train>> trains;
 	for (const auto& p : routing->order()) {
 		if (!p.isVirtual()) {
-			repaintTrainLines(p.train());
+			trains.insert(p.train());
 		}
 	}
+	repaintTrainLines(trains);
 }
 void MainWindow::repaintTrainLines(const QSet<std::shared_ptr<Train>> trains)
 {
-	foreach(auto p, trains) {
-		repaintTrainLines(p);
+	for (auto p : diagramWidgets) {
+		foreach(auto train, trains) {
+			p->page()->markTrainDirty(train);
+		}
+		p->updateGraph();
 	}
 }
 
@@ -198,6 +198,13 @@ private:
      */
     bool openGraph(const QString& filename);
 
+    /**
+     * 2026.10  在后台线程中绑定所给运行图的所有车次与线路，显示（立即显示的、模态的）进度对话框。
+     * 返回绑定是否完成并已写回；取消时不修改运行图。
+     * 内部运行嵌套的事件循环，不得在撤销命令中调用；撤销命令中用Diagram::rebindAllTrains()。
+     */
+    bool bindTrainsWithProgress(Diagram& dia);
+
     
 
     void updateWindowTitle();
@@ -287,6 +294,11 @@ private slots:
 
     void updatePageDiagram(std::shared_ptr<DiagramPage> pg);
 
+    /**
+     * 2026.10  按页面的脏标记增量更新运行图，见DiagramWidget::updateGraph()
+     */
+    void refreshPageDiagram(std::shared_ptr<DiagramPage> pg);
+
     /**
      * 导入车次。刷新相关面板，重新铺画运行图。
      */
@@ -477,6 +489,7 @@ public slots:
 
     /**
      * 重绘一组车次的运行线。主要也是交路变更时使用。
+     * 2026.10：先在各页面标记，再统一增量更新；每个车次在每个页面只重绘一次。
      */
     void repaintTrainLines(const QSet<std::shared_ptr<Train>> trains);
 
@@ -422,6 +422,9 @@ void TrainContext::commitTimetableChange(std::shared_ptr<Train> train, std::shar
 
 void TrainContext::onTrainStationTimeChanged(std::shared_ptr<Train> train, bool repaint)
 {
+	//2026.10  时刻原地修改，运行线不变，车站事件表缓存、运行线索引须另行清除
+	diagram.invalidateEventAxisForTrain(*train);
+	diagram.invalidateTempData();
 	updateTrainWidget(train);
 	if(repaint)
 		mw->repaintTrainLines(train);
@@ -478,12 +481,14 @@ void TrainContext::actBatchAutoTrainType(qecmd::AutoTrainType::data_t& data)
 void TrainContext::commitAutoStartingTerminal(qecmd::StartingTerminalData& data)
 {
 	data.commit();
+	QSet<std::shared_ptr<Train>> trains;
 	for (auto& p : data.startings) {
-		mw->repaintTrainLines(p.first);
+		trains.insert(p.first);
 	}
 	for (auto& p : data.terminals) {
-		mw->repaintTrainLines(p.first);
+		trains.insert(p.first);
 	}
+	mw->repaintTrainLines(trains);
 	mw->trainListWidget->getModel()->updateAllTrainStartingTerminal();
 	refreshCurrentTrainWidgets();
 }
@@ -493,9 +498,11 @@ void TrainContext::commitAutoType(std::deque<std::pair<std::shared_ptr<Train>, s
 	for (auto& p : data) {
 		std::swap(p.first->typeRef(), p.second);
 	}
+	QSet<std::shared_ptr<Train>> trains;
 	for (const auto& p : data) {
-		mw->repaintTrainLines(p.first);
+		trains.insert(p.first);
 	}
+	mw->repaintTrainLines(trains);
 	mw->trainListWidget->getModel()->updateAllTrainTypes();
 	diagram.trainCollection().refreshTypeCount();
 	refreshCurrentTrainWidgets();
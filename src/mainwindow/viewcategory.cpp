@@ -474,7 +474,8 @@ void ViewCategory::commitConfigChange(Config& cfg, bool repaint)
 void ViewCategory::commitPageConfigChange(std::shared_ptr<DiagramPage> page, bool repaint)
 {
     Q_UNUSED(repaint)
-    mw->updatePageDiagram(page);
+    // 2026.10：脏标记由调用方（ChangePageConfig）设置，这里只重建受影响的图元
+    mw->refreshPageDiagram(page);
 }
 
 void ViewCategory::actChangeSingleTrainShow(std::shared_ptr<Train> train, bool show)
@@ -322,6 +322,8 @@ void TimetableQuickEditableModel::commitStationTimeChange(std::shared_ptr<Train>
         std::advance(p, row / 2);   // int div
         std::swap(*p, data);
     }
+    // 2026.10  原地修改，不经过重新绑定，须手动使SoA副本等临时数据失效
+    train->invalidateTempData();
     emit trainStationTimeUpdated(train, repaint);
 }
 
@@ -490,7 +490,7 @@ void NaviTree::actBatchAddTrains(const QVector<std::shared_ptr<Train>>& trains)
 void NaviTree::importRailways()
 {
     QString res = QFileDialog::getOpenFileName(this, tr("导入线路"), QString(),
-        QObject::tr("pyETRC运行图文件(*.pyetgr;*.json)\nETRC运行图文件(*.trc)\n所有文件(*.*)"));
+        QObject::tr("pyETRC运行图文件(*.pyetgr;*.json)\nqETRC二进制运行图文件(*.qetgrb)\nETRC运行图文件(*.trc)\n所有文件(*.*)"));
     if (res.isEmpty())
         return;
 
@@ -17,6 +17,8 @@ class ForbidNode;
 struct GraphForbidNode{
     QTime beginTime,endTime;
     GraphForbidNode(const ForbidNode& node);
+    GraphForbidNode(const QTime& beginTime, const QTime& endTime):
+        beginTime(beginTime),endTime(endTime){}
     void exportToNode(ForbidNode& node)const;
 };
 
@@ -24,6 +26,8 @@ struct GraphRulerNode{
     QString name;
     int interval,start,stop;
     GraphRulerNode(const RulerNode& node);
+    GraphRulerNode(const QString& name, int interval, int start, int stop):
+        name(name),interval(interval),start(start),stop(stop){}
     void exportToNode(RulerNode& node)const;
 };
 
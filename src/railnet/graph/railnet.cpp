@@ -3,6 +3,11 @@
 #include "data/rail/railcategory.h"
 #include "data/rail/forbid.h"
 #include "railnet/path/pathoperation.h"
+#include "data/common/jsonstreamreader.h"
+
+#include <QFile>
+#include <QDataStream>
+#include <cstring>
 
 void RailNet::fromRailCategory(const RailCategory* cat)
 {
@@ -14,6 +19,151 @@ void RailNet::fromRailCategory(const RailCategory* cat)
 	}
 }
 
+void RailNet::clear()
+{
+	di_graph::clear();
+	std::atomic_store(&_csr, std::shared_ptr<const csr_t>{});
+}
+
+std::shared_ptr<const RailNet::csr_t> RailNet::csr() const
+{
+	auto res = std::atomic_load(&_csr);
+	if (!res) {
+		res = std::make_shared<const csr_t>(*this, &GraphInterval::getMile);
+		std::atomic_store(&_csr, res);
+	}
+	return res;
+}
+
+namespace {
+    constexpr char CACHE_MAGIC[] = "QETRCNET";
+    constexpr int CACHE_MAGIC_SIZE = 8;
+    constexpr quint32 CACHE_VERSION = 1;
+}
+
+QString RailNet::cacheFileName(const QString& dbFile)
+{
+	return dbFile + ".netcache";
+}
+
+bool RailNet::saveCache(const QString& filename, const QByteArray& contentHash) const
+{
+	QFile file(filename);
+	if (!file.open(QFile::WriteOnly)) {
+		qDebug() << "RailNet::saveCache: WARNING: open file " << filename << " failed.";
+		return false;
+	}
+	QDataStream s(&file);
+	s.setVersion(QDataStream::Qt_5_6);
+	s.writeRawData(CACHE_MAGIC, CACHE_MAGIC_SIZE);
+	s << CACHE_VERSION << contentHash;
+
+	std::unordered_map<const vertex*, quint32> ids;
+	ids.reserve(size());
+	s << static_cast<quint32>(size());
+	for (const auto& [key, v] : vertices()) {
+		ids.emplace(v.get(), static_cast<quint32>(ids.size()));
+		const auto& st = v->data;
+		s << key.toSingleLiteral() << st.name.toSingleLiteral() << static_cast<qint32>(st.level)
+			<< st.passenger << st.freight << st.tracks;
+	}
+
+	// 读入时逐条插入到出边链表头部，因此每个结点的出边倒序写出，以恢复原有顺序
+	std::vector<std::shared_ptr<const edge>> edges, outs;
+	for (const auto& [key, v] : vertices()) {
+		outs.clear();
+		for (auto e = v->out_edge; e; e = e->next_out)
+			outs.emplace_back(e);
+		edges.insert(edges.end(), outs.rbegin(), outs.rend());
+	}
+	s << static_cast<quint32>(edges.size());
+	for (const auto& e : edges) {
+		const auto& d = e->data;
+		s << ids.at(e->from.lock().get()) << ids.at(e->to.lock().get())
+			<< d.railName << static_cast<qint8>(d.dir) << d.mile;
+		s << static_cast<quint32>(d.forbidNodes.size());
+		for (const auto& n : d.forbidNodes)
+			s << n.beginTime << n.endTime;
+		s << static_cast<quint32>(d.rulerNodes.size());
+		for (const auto& n : d.rulerNodes)
+			s << n.name << static_cast<qint32>(n.interval) << static_cast<qint32>(n.start)
+			<< static_cast<qint32>(n.stop);
+	}
+	return s.status() == QDataStream::Ok;
+}
+
+bool RailNet::loadCache(const QString& filename, const QByteArray& contentHash)
+{
+	clear();
+	QFile file(filename);
+	if (!file.open(QFile::ReadOnly))
+		return false;
+	const QByteArray& data = JsonStreamReader::mapFile(file);
+	if (data.size() < CACHE_MAGIC_SIZE || std::memcmp(data.constData(), CACHE_MAGIC, CACHE_MAGIC_SIZE))
+		return false;
+
+	QDataStream s(data);
+	s.setVersion(QDataStream::Qt_5_6);
+	s.skipRawData(CACHE_MAGIC_SIZE);
+	quint32 version;
+	QByteArray hash;
+	s >> version >> hash;
+	if (s.status() != QDataStream::Ok || version != CACHE_VERSION || hash != contentHash)
+		return false;
+
+	quint32 nv;
+	s >> nv;
+	if (s.status() != QDataStream::Ok || nv > static_cast<quint32>(data.size()))
+		return false;
+	std::vector<std::shared_ptr<vertex>> verts;
+	verts.reserve(nv);
+	for (quint32 i = 0; i < nv && s.status() == QDataStream::Ok; i++) {
+		QString key, name;
+		qint32 level;
+		GraphStation st;
+		s >> key >> name >> level >> st.passenger >> st.freight >> st.tracks;
+		st.name = StationName::fromSingleLiteral(name);
+		st.level = level;
+		verts.emplace_back(emplace_vertex(StationName::fromSingleLiteral(key), std::move(st)));
+	}
+
+	quint32 ne = 0;
+	s >> ne;
+	bool edgesOk = true;
+	for (quint32 i = 0; i < ne && s.status() == QDataStream::Ok; i++) {
+		quint32 from, to, nf, nr;
+		qint8 dir;
+		GraphInterval d;
+		s >> from >> to >> d.railName >> dir >> d.mile;
+		d.dir = static_cast<Direction>(dir);
+		s >> nf;
+		for (quint32 j = 0; j < nf && s.status() == QDataStream::Ok; j++) {
+			QTime tm1, tm2;
+			s >> tm1 >> tm2;
+			d.forbidNodes.push_back({ tm1, tm2 });
+		}
+		s >> nr;
+		for (quint32 j = 0; j < nr && s.status() == QDataStream::Ok; j++) {
+			QString name;
+			qint32 interval, start, stop;
+			s >> name >> interval >> start >> stop;
+			d.rulerNodes.push_back({ name, interval, start, stop });
+		}
+		if (s.status() != QDataStream::Ok || from >= verts.size() || to >= verts.size()) {
+			edgesOk = false;
+			break;
+		}
+		emplace_edge(verts.at(from), verts.at(to), std::move(d));
+	}
+
+	if (!edgesOk || s.status() != QDataStream::Ok || size() != nv) {
+		qDebug() << "RailNet::loadCache: WARNING: corrupted cache file " << filename;
+		clear();
+		return false;
+	}
+	return true;
+}
+
 const RailNet::rail_ret_t RailNet::rail_ret_t::null{};
 
 RailNet::rail_ret_t RailNet::sliceBySinglePath(QVector<QString> points,
@@ -147,8 +297,8 @@ RailNet::path_t RailNet::shortestPath(
         report->append(QObject::tr("出发站和到达站相同"));
         return {};
     }
-    auto ret=sssp(from, &GraphInterval::getMile);
-    auto t=dump_path(from,vert,ret);
+    auto g=csr();
+    auto t=g->shortest_path(g->id_of(from),g->id_of(vert));
     if (t.empty()){
         report->append(QObject::tr("目标站不可达"));
         return {};
@@ -213,44 +363,52 @@ RailNet::path_t RailNet::railPathTo(const std::shared_ptr<const vertex> &start,
     }
 }
 
-std::pair<std::shared_ptr<Railway>, RailNet::path_t>
-RailNet::singleRailFromPath(const QVector<QString>& points,
-	bool withRuler,
-	QString* report)const
+RailNet::path_t RailNet::keyPointsPath(const QVector<QString>& points, QString* report) const
 {
 	if (points.size() <= 1) {
 		report->append(QObject::tr("至少需给出两个关键点"));
-		return std::make_pair(nullptr, path_t{});
+		return {};
 	}
 	path_t path;
 
-	QMap<QString, int> rulerMap;
-
 	auto prev = points.begin();
 	auto prst = find_vertex(*prev);
 	if (!prst) {
 		report->append(QObject::tr("径路首站%1不在图中").arg(*prev));
-		return { nullptr,{} };
+		return {};
 	}
 
+	// 2026.10：每段用点对点查询，到达本段终点即停止，不再对每个关键点求单源最短路
+	auto g = csr();
 	for (auto p = std::next(prev); p != points.end(); prev = p, ++p) {
 		auto curst = find_vertex(*p);
 		if (!curst) {
 			report->append(QObject::tr("径路中间站%1不在图中").arg(*p));
-			return { nullptr,{} };
+			return {};
 		}
-		auto ret = sssp(prst, &GraphInterval::getMile);
-		auto subpath = dump_path(prst, curst, ret);
+		auto subpath = g->shortest_path(g->id_of(prst), g->id_of(curst));
 		path.insert(path.end(), subpath.begin(), subpath.end());
 
 		if (subpath.empty()) {
 			report->append(QObject::tr("区间[%1->%2]不可达").arg(
 				*prev, *p));
-			return { nullptr,{} };
+			return {};
 		}
 
 		prst = curst;
 	}
+	return path;
+}
+
+std::pair<std::shared_ptr<Railway>, RailNet::path_t>
+RailNet::singleRailFromPath(const QVector<QString>& points,
+	bool withRuler,
+	QString* report)const
+{
+	auto path = keyPointsPath(points, report);
+	if (path.empty()) {
+		return { nullptr,{} };
+	}
 
     auto res=singleRailFromPath(path,withRuler);
 
@@ -342,6 +500,7 @@ QString RailNet::intervalPathToString(std::shared_ptr<const vertex> pre,
 
 void RailNet::addRailway(const Railway* railway)
 {
+	std::atomic_store(&_csr, std::shared_ptr<const csr_t>{});
 	std::shared_ptr<vertex> pre{};
 	for (auto p = railway->firstDownInterval(); p; p = railway->nextIntervalCirc(p)) {
 		if (!pre) {
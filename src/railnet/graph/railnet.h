@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include "xtl_graph.hpp"
+#include "xtl_csr.hpp"
 
 #include <QString>
 #include <memory>
@@ -15,11 +16,18 @@ class RailNet: public xtl::di_graph<StationName, GraphStation, GraphInterval>
 {
     using di_graph::sssp;
     using di_graph::dump_path;
+
+    mutable std::shared_ptr<const xtl::csr_graph<RailNet, double>> _csr;
 public:
     RailNet()=default;
 
     using path_t=path_t;
 
+    /**
+     * 2026.10  以里程为权的CSR邻接表，最短路计算都在它上面进行
+     */
+    using csr_t = xtl::csr_graph<RailNet, double>;
+
     struct rail_ret_t{
         std::shared_ptr<Railway> railway;
         path_t downPath,upPath;
@@ -33,6 +41,34 @@ public:
      */
     void fromRailCategory(const RailCategory* cat);
 
+    /**
+     * 2026.10  有向图缓存
+     * 将整个图（结点、边及其标尺、天窗数据）写入缓存文件，contentHash为所据线路数据库的内容散列。
+     * 结点按键序编号，边以起止结点的编号表示。
+     */
+    bool saveCache(const QString& filename, const QByteArray& contentHash)const;
+
+    /**
+     * 从缓存文件读入（文件映射到内存后解析），替换现有数据。
+     * 文件不存在、格式不对或者contentHash不一致时返回false，此时图为空。
+     */
+    bool loadCache(const QString& filename, const QByteArray& contentHash);
+
+    /**
+     * 线路数据库文件所对应的缓存文件名
+     */
+    static QString cacheFileName(const QString& dbFile);
+
+    /**
+     * 2026.10  清空图数据，同时丢弃CSR邻接表
+     */
+    void clear();
+
+    /**
+     * 2026.10  CSR邻接表。第一次调用时构造，图数据变化（addRailway, clear）后失效。
+     */
+    std::shared_ptr<const csr_t> csr()const;
+
     /**
      * 采用关键点最短路径算法，获取径路切片。
      * 正反分别执行一次最短路算法，然后进行合并。
@@ -72,6 +108,12 @@ public:
                         const std::shared_ptr<const vertex> & to,
                         QString* report) const;
 
+    /**
+     * 2026.10  依次连接各关键点的最短径路（逐段点对点查询），不生成线路。
+     * 失败返回空，并在report中报告原因。可用于输入过程中的径路预览。
+     */
+    path_t keyPointsPath(const QVector<QString>& points, QString* report)const;
+
     /**
      * 计算径路的总长度，简单累加每段的里程。
      */
@@ -0,0 +1,304 @@
+﻿#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <deque>
+#include <queue>
+#include <memory>
+#include <limits>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <type_traits>
+
+namespace xtl
+{
+    /**
+     * 2026.10
+     * 由di_graph生成的压缩稀疏行（CSR）邻接表，只读，用于最短路计算。
+     * 结点按di_graph中的键序编为稠密的整数号，出边按号连续存放，
+     * 边权在构造时由func一次算好；每个结点的出边保持原出边链表的顺序。
+     * 不持有di_graph，但保存了结点、边的指针，因此原图结构变化后必须重新构造。
+     */
+    template <typename _Graph, typename _Val>
+    class csr_graph {
+        static_assert(std::is_arithmetic_v<_Val>, "weight type must be arithmetic");
+    public:
+        using graph_type = _Graph;
+        using vertex = typename _Graph::vertex;
+        using edge = typename _Graph::edge;
+        using value_type = _Val;
+        using id_type = std::uint32_t;
+        using path_t = std::deque<std::shared_ptr<const edge>>;
+
+        static constexpr id_type npos = std::numeric_limits<id_type>::max();
+        static constexpr _Val inf = std::numeric_limits<_Val>::max();
+
+    private:
+        std::vector<std::shared_ptr<const vertex>> _vertices;   // 号->结点
+        std::unordered_map<const vertex*, id_type> _ids;        // 结点->号
+        std::vector<id_type> _offsets;                          // 第i个结点的出边为[_offsets[i], _offsets[i+1])
+        std::vector<id_type> _targets;
+        std::vector<_Val> _weights;
+        std::vector<std::shared_ptr<const edge>> _edges;
+        std::vector<id_type> _rev_offsets;                      // 反向邻接：第i个结点的入边为_rev_edges[_rev_offsets[i]...]
+        std::vector<id_type> _rev_edges;                        // 入边的边号
+
+    public:
+        /**
+         * 单源最短路结果，按结点号存放。distance为inf表示不可达；
+         * pred为到达该点的最短路上最后一条边的号，源点及不可达点为npos。
+         */
+        struct sssp_ret_t {
+            id_type source = npos;
+            std::vector<_Val> distance;
+            std::vector<id_type> pred;
+
+            bool reachable(id_type v)const { return v < distance.size() && distance[v] != inf; }
+        };
+
+        csr_graph() = default;
+
+        template <typename _Func>
+        csr_graph(const _Graph& graph, _Func func);
+
+        size_t size()const { return _vertices.size(); }
+        size_t edge_count()const { return _edges.size(); }
+
+        /**
+         * 结点的号；不在图中返回npos
+         */
+        id_type id_of(const vertex* v)const {
+            if (auto itr = _ids.find(v); itr != _ids.end())
+                return itr->second;
+            return npos;
+        }
+        id_type id_of(const std::shared_ptr<const vertex>& v)const { return id_of(v.get()); }
+
+        const std::shared_ptr<const vertex>& vertex_at(id_type i)const { return _vertices[i]; }
+        const std::shared_ptr<const edge>& edge_at(id_type e)const { return _edges[e]; }
+
+        id_type out_begin(id_type v)const { return _offsets[v]; }
+        id_type out_end(id_type v)const { return _offsets[v + 1]; }
+        id_type target(id_type e)const { return _targets[e]; }
+        _Val weight(id_type e)const { return _weights[e]; }
+
+        /**
+         * 二叉堆Dijkstra，O((V+E)logV)。边权须非负。
+         */
+        sssp_ret_t sssp(id_type source)const;
+
+        /**
+         * 由sssp结果给出source至target的路径，以边的序列表示。
+         * 与di_graph::dump_path一致：不可达或者source, target一样，返回空
+         */
+        path_t dump_path(id_type target, const sssp_ret_t& res)const;
+
+        /**
+         * 点对点最短路：双向Dijkstra，正向沿出边、反向沿入边交替扩展，
+         * 两侧堆顶之和不小于已知最短路长时即停止，不必求出全部结点的距离。
+         * 返回边的序列；不可达或者source, target一样，返回空。
+         * 若distance非空，可达时写入最短路长度。
+         */
+        path_t shortest_path(id_type source, id_type target, _Val* distance = nullptr)const;
+
+        /**
+         * 号为e的边的起点的号
+         */
+        id_type edge_from(id_type e)const;
+    };
+
+    template <typename _Graph, typename _Val>
+    template <typename _Func>
+    csr_graph<_Graph, _Val>::csr_graph(const _Graph& graph, _Func func)
+    {
+        const auto& verts = graph.vertices();
+        _vertices.reserve(verts.size());
+        _ids.reserve(verts.size());
+        for (const auto& [key, v] : verts) {
+            _ids.emplace(v.get(), static_cast<id_type>(_vertices.size()));
+            _vertices.emplace_back(v);
+        }
+        _offsets.reserve(_vertices.size() + 1);
+        _offsets.push_back(0);
+        for (const auto& v : _vertices) {
+            for (auto e = v->out_edge; e; e = e->next_out) {
+                auto to = e->to.lock();
+                if (!to)
+                    continue;
+                if (auto itr = _ids.find(to.get()); itr != _ids.end()) {
+                    _targets.push_back(itr->second);
+                    _weights.push_back(std::invoke(func, e->data));
+                    _edges.emplace_back(e);
+                }
+            }
+            _offsets.push_back(static_cast<id_type>(_targets.size()));
+        }
+
+        // 按终点计数排序，得到反向邻接
+        _rev_offsets.assign(_vertices.size() + 1, 0);
+        for (id_type t : _targets)
+            _rev_offsets[t + 1]++;
+        for (size_t i = 0; i < _vertices.size(); i++)
+            _rev_offsets[i + 1] += _rev_offsets[i];
+        _rev_edges.resize(_targets.size());
+        std::vector<id_type> pos(_rev_offsets.begin(), _rev_offsets.end() - 1);
+        for (id_type e = 0; e < _targets.size(); e++)
+            _rev_edges[pos[_targets[e]]++] = e;
+    }
+
+    template <typename _Graph, typename _Val>
+    typename csr_graph<_Graph, _Val>::sssp_ret_t
+        csr_graph<_Graph, _Val>::sssp(id_type source) const
+    {
+        sssp_ret_t ret;
+        ret.source = source;
+        ret.distance.assign(size(), inf);
+        ret.pred.assign(size(), npos);
+        if (source >= size())
+            return ret;
+
+        using item_t = std::pair<_Val, id_type>;
+        std::priority_queue<item_t, std::vector<item_t>, std::greater<item_t>> heap;
+        std::vector<bool> settled(size(), false);
+
+        ret.distance[source] = 0;
+        heap.emplace(0, source);
+        while (!heap.empty()) {
+            auto [d, u] = heap.top();
+            heap.pop();
+            if (settled[u])
+                continue;   // 过期的堆项
+            settled[u] = true;
+            for (id_type e = _offsets[u]; e < _offsets[u + 1]; e++) {
+                id_type v = _targets[e];
+                _Val dnew = d + _weights[e];
+                if (dnew < ret.distance[v]) {
+                    ret.distance[v] = dnew;
+                    ret.pred[v] = e;
+                    heap.emplace(dnew, v);
+                }
+            }
+        }
+        return ret;
+    }
+
+    template <typename _Graph, typename _Val>
+    typename csr_graph<_Graph, _Val>::id_type
+        csr_graph<_Graph, _Val>::edge_from(id_type e) const
+    {
+        // 出边按起点连续存放，二分查找起点
+        auto itr = std::upper_bound(_offsets.begin(), _offsets.end(), e);
+        return static_cast<id_type>(itr - _offsets.begin()) - 1;
+    }
+
+    template <typename _Graph, typename _Val>
+    typename csr_graph<_Graph, _Val>::path_t
+        csr_graph<_Graph, _Val>::dump_path(id_type target, const sssp_ret_t& res) const
+    {
+        if (!res.reachable(target))
+            return {};
+        path_t path;
+        id_type cur = target;
+        while (cur != res.source) {
+            id_type e = res.pred[cur];
+            if (e == npos)
+                return {};
+            path.emplace_front(_edges[e]);
+            cur = edge_from(e);
+        }
+        return path;
+    }
+
+    template <typename _Graph, typename _Val>
+    typename csr_graph<_Graph, _Val>::path_t
+        csr_graph<_Graph, _Val>::shortest_path(id_type source, id_type target, _Val* distance) const
+    {
+        if (source >= size() || target >= size() || source == target)
+            return {};
+
+        using item_t = std::pair<_Val, id_type>;
+        using heap_t = std::priority_queue<item_t, std::vector<item_t>, std::greater<item_t>>;
+
+        // 下标0为正向，1为反向
+        std::vector<_Val> dist[2]{ std::vector<_Val>(size(), inf), std::vector<_Val>(size(), inf) };
+        std::vector<id_type> pred[2]{ std::vector<id_type>(size(), npos), std::vector<id_type>(size(), npos) };
+        std::vector<bool> settled[2]{ std::vector<bool>(size(), false), std::vector<bool>(size(), false) };
+        heap_t heap[2];
+
+        dist[0][source] = 0;
+        dist[1][target] = 0;
+        heap[0].emplace(0, source);
+        heap[1].emplace(0, target);
+
+        _Val best = inf;
+        id_type meet = npos;
+
+        auto top = [&heap](int side) {
+            return heap[side].empty() ? inf : heap[side].top().first;
+        };
+
+        while (true) {
+            _Val t0 = top(0), t1 = top(1);
+            // 一侧已扩展完毕：该侧可达的结点都已确定，若有最短路则已经在best中
+            if (t0 == inf || t1 == inf)
+                break;
+            if (best != inf && t0 + t1 >= best)
+                break;
+            int side = t0 <= t1 ? 0 : 1;
+            // 结构化绑定不能被lambda捕获（C++17），取出到普通变量
+            const _Val d = heap[side].top().first;
+            const id_type u = heap[side].top().second;
+            heap[side].pop();
+            if (settled[side][u])
+                continue;
+            settled[side][u] = true;
+
+            auto relax = [&](id_type e, id_type v) {
+                _Val dnew = d + _weights[e];
+                if (dnew < dist[side][v]) {
+                    dist[side][v] = dnew;
+                    pred[side][v] = e;
+                    heap[side].emplace(dnew, v);
+                }
+                if (dist[1 - side][v] != inf && dist[side][v] + dist[1 - side][v] < best) {
+                    best = dist[side][v] + dist[1 - side][v];
+                    meet = v;
+                }
+            };
+
+            if (side == 0) {
+                for (id_type e = _offsets[u]; e < _offsets[u + 1]; e++)
+                    relax(e, _targets[e]);
+            }
+            else {
+                for (id_type i = _rev_offsets[u]; i < _rev_offsets[u + 1]; i++) {
+                    id_type e = _rev_edges[i];
+                    relax(e, edge_from(e));
+                }
+            }
+        }
+
+        if (meet == npos)
+            return {};
+
+        path_t path;
+        for (id_type cur = meet; cur != source; ) {
+            id_type e = pred[0][cur];
+            if (e == npos)
+                return {};
+            path.emplace_front(_edges[e]);
+            cur = edge_from(e);
+        }
+        for (id_type cur = meet; cur != target; ) {
+            id_type e = pred[1][cur];
+            if (e == npos)
+                return {};
+            path.emplace_back(_edges[e]);
+            cur = _targets[e];
+        }
+        if (distance)
+            *distance = best;
+        return path;
+    }
+}
@@ -79,6 +79,14 @@ void QuickPathSelector::initUI()
 
     vlay->addLayout(hlay);
 
+    labPreview=new QLabel;
+    labPreview->setWordWrap(true);
+    vlay->addWidget(labPreview);
+    connect(mdDown,&QAbstractItemModel::dataChanged,this,&QuickPathSelector::updatePreview);
+    connect(mdDown,&QAbstractItemModel::rowsInserted,this,&QuickPathSelector::updatePreview);
+    connect(mdDown,&QAbstractItemModel::rowsRemoved,this,&QuickPathSelector::updatePreview);
+    connect(mdDown,&QAbstractItemModel::rowsMoved,this,&QuickPathSelector::updatePreview);
+
     auto* g=new ButtonGroup<2>({"预览","强制生成"});
     vlay->addLayout(g);
     g->connectAll(SIGNAL(clicked()),this,{SLOT(actGenerate()),SLOT(actForce())});
@@ -166,3 +174,20 @@ void QuickPathSelector::onUpModeChanged()
 {
     ctbUp->setEnabled(gpUp->get(1)->isChecked());
 }
+
+void QuickPathSelector::updatePreview()
+{
+    auto downPath=pathFromModel(mdDown);
+    if (downPath.size()<2){
+        labPreview->clear();
+        return;
+    }
+    QString report;
+    auto path=net.keyPointsPath(downPath,&report);
+    if (path.empty()){
+        labPreview->setText(tr("正向径路：%1").arg(report));
+    }else{
+        labPreview->setText(tr("正向径路：%1 km  经由 %2").arg(
+            QString::number(RailNet::pathMile(path),'f',3), net.pathToStringSimple(path)));
+    }
+}
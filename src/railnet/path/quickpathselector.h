@@ -11,6 +11,7 @@ class QCheckBox;
 class QEControlledTable;
 class QEMoveableModel;
 class QTableView;
+class QLabel;
 
 /**
  * @brief The QuickPathSelected class
@@ -27,6 +28,7 @@ class QuickPathSelector : public QWidget
     QCheckBox* ckRuler;
     RadioButtonGroup<3>* gpUp;
     QSpinBox* spRuler;
+    QLabel* labPreview;
     bool informForce = true;
 public:
     explicit QuickPathSelector(RailNet& net, QWidget *parent = nullptr);
@@ -42,5 +44,10 @@ private slots:
     void actGenerate();
     void actForce();
     void onUpModeChanged();
+
+    /**
+     * 2026.10  正向关键点表变化时，即时显示最短径路的里程和经由
+     */
+    void updatePreview();
 };
 
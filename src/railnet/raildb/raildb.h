@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include "data/rail/railcategory.h"
+#include "raildbindex.h"
 
 /**
  * @brief The RailDB class
@@ -9,6 +10,14 @@
 class RailDB : public RailCategory
 {
     QString _filename;
+
+    /**
+     * 2026.10  最近一次读入或保存的文件内容散列，用于校验有向图缓存；
+     * 非由文件读入时为空
+     */
+    mutable QByteArray _contentHash;
+
+    RailDBIndex _index;
 public:
     using RailCategory::RailCategory;
     RailDB(RailCategory&& other);   // move construct
@@ -30,7 +39,13 @@ public:
     bool saveAs(const QString& filename);
 
     const  auto& filename()const{return _filename;}
+    const auto& contentHash()const{return _contentHash;}
 
     void clear();
+
+    /**
+     * 2026.10  车站倒排索引。第一次调用时建立；此后由RailDBModel在增删、修改线路时维护。
+     */
+    RailDBIndex& stationIndex();
 };
 
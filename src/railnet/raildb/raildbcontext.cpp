@@ -273,9 +273,21 @@ void RailDBContext::loadNet()
     using namespace std::chrono_literals;
     auto start = std::chrono::system_clock::now();
     net.clear();
-    net.fromRailCategory(_raildb.get());
+
+    // 2026.10：数据库与文件一致时，优先读取文件旁的有向图缓存；缓存无效则重建并写回
+    const auto& hash = _raildb->contentHash();
+    bool useCache = !_raildb->filename().isEmpty() && !hash.isEmpty() &&
+        !window->getNavi()->isChanged();
+    QString cacheFile = RailNet::cacheFileName(_raildb->filename());
+    bool fromCache = useCache && net.loadCache(cacheFile, hash);
+    if (!fromCache) {
+        net.fromRailCategory(_raildb.get());
+        if (useCache)
+            net.saveCache(cacheFile, hash);
+    }
     auto end = std::chrono::system_clock::now();
-    mw->showStatus(tr("线网有向图加载完毕  共%1站 用时%2毫秒").arg(net.size())
+    mw->showStatus(tr("线网有向图加载完毕%1  共%2站 用时%3毫秒")
+        .arg(fromCache ? tr("（缓存）") : QString()).arg(net.size())
         .arg((end - start) / 1ms));
 }
 
@@ -0,0 +1,172 @@
+﻿#include "raildbindex.h"
+
+#include "data/rail/railway.h"
+#include "data/rail/railcategory.h"
+
+void RailDBIndex::invalidate()
+{
+    _byName.clear();
+    _byBareName.clear();
+    _byGram.clear();
+    _keys.clear();
+    _valid = false;
+}
+
+void RailDBIndex::build(const RailCategory& root)
+{
+    invalidate();
+    _valid = true;
+    addCategory(root);
+}
+
+void RailDBIndex::addRailway(const Railway& railway)
+{
+    if (!_valid || _keys.contains(&railway))
+        return;
+    RailKeys keys;
+    QSet<QString> grams;
+    for (const auto& st : railway.stations()) {
+        const auto& name = st->name;
+        keys.ids.append(name.id());
+        if (name.isBare())
+            keys.bareIds.append(name.stationId());
+        QString lit = name.toSingleLiteral();
+        foreach(const auto & g, gramsOf(lit)) {
+            grams.insert(g);
+        }
+        keys.names.append(std::move(lit));
+    }
+    keys.grams = grams.values();
+
+    const Railway* r = &railway;
+    for (auto id : keys.ids)
+        _byName[id].insert(r);
+    for (auto id : keys.bareIds)
+        _byBareName[id].insert(r);
+    foreach(const auto & g, keys.grams) {
+        _byGram[g].insert(r);
+    }
+    _keys.insert(r, std::move(keys));
+}
+
+void RailDBIndex::removeRailway(const Railway& railway)
+{
+    if (!_valid)
+        return;
+    auto itr = _keys.find(&railway);
+    if (itr == _keys.end())
+        return;
+    const Railway* r = &railway;
+    auto removeFrom = [r](auto& map, const auto& key) {
+        auto p = map.find(key);
+        if (p != map.end()) {
+            p->remove(r);
+            if (p->isEmpty())
+                map.erase(p);
+        }
+    };
+    for (auto id : itr->ids)
+        removeFrom(_byName, id);
+    for (auto id : itr->bareIds)
+        removeFrom(_byBareName, id);
+    foreach(const auto & g, itr->grams) {
+        removeFrom(_byGram, g);
+    }
+    _keys.erase(itr);
+}
+
+void RailDBIndex::updateRailway(const Railway& railway)
+{
+    removeRailway(railway);
+    addRailway(railway);
+}
+
+void RailDBIndex::addCategory(const RailCategory& cat)
+{
+    if (!_valid)
+        return;
+    foreach(const auto & sub, cat.subCategories()) {
+        addCategory(*sub);
+    }
+    foreach(const auto & rail, cat.railways()) {
+        addRailway(*rail);
+    }
+}
+
+void RailDBIndex::removeCategory(const RailCategory& cat)
+{
+    if (!_valid)
+        return;
+    foreach(const auto & sub, cat.subCategories()) {
+        removeCategory(*sub);
+    }
+    foreach(const auto & rail, cat.railways()) {
+        removeRailway(*rail);
+    }
+}
+
+RailDBIndex::rail_set_t RailDBIndex::searchFullName(const StationName& name) const
+{
+    return _byName.value(name.id());
+}
+
+RailDBIndex::rail_set_t RailDBIndex::searchGeneralName(const StationName& name) const
+{
+    auto res = _byName.value(name.id());
+    res.unite(_byBareName.value(name.stationId()));
+    return res;
+}
+
+RailDBIndex::rail_set_t RailDBIndex::searchNamePart(const QString& text) const
+{
+    if (text.isEmpty())
+        return {};
+    const auto& grams = gramsOf(text);
+    // 双字片段比单字选择性强；text只有一个字时只能用单字
+    rail_set_t cand;
+    bool first = true;
+    foreach(const auto & g, grams) {
+        if (text.size() > 1 && g.size() == 1)
+            continue;
+        auto itr = _byGram.find(g);
+        if (itr == _byGram.end())
+            return {};
+        if (first) {
+            cand = itr.value();
+            first = false;
+        }
+        else {
+            cand.intersect(itr.value());
+        }
+        if (cand.isEmpty())
+            return {};
+    }
+    if (text.size() <= 2)
+        return cand;
+
+    // 各片段都出现不代表整体出现，逐个验证
+    rail_set_t res;
+    foreach(auto r, cand) {
+        auto k = _keys.constFind(r);
+        if (k == _keys.cend())
+            continue;
+        foreach(const auto & n, k->names) {
+            if (n.contains(text)) {
+                res.insert(r);
+                break;
+            }
+        }
+    }
+    return res;
+}
+
+QStringList RailDBIndex::gramsOf(const QString& s)
+{
+    QStringList res;
+    for (int i = 0; i < s.size(); i++) {
+        res.append(s.mid(i, 1));
+        if (i + 1 < s.size())
+            res.append(s.mid(i, 2));
+    }
+    return res;
+}
@@ -0,0 +1,79 @@
+﻿#pragma once
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class Railway;
+class RailCategory;
+class StationName;
+
+/**
+ * @brief The RailDBIndex class
+ * 2026.10  线路数据库的车站倒排索引：站名 -> 含有该站的线路。
+ * 包含三种键：完整站名（驻留编号）、不带场名的站名（仅登记无场名的车站），
+ * 以及站名字面的单字、双字片段（用于子串搜索）。
+ *
+ * 只登记线路指针，不登记线路在树中的路径（路径随插入、删除而变化），
+ * 路径由调用方按线路查出（见RailDBModel::pathsOfRailways）。
+ * 未建立时(isValid()==false)，增删操作都忽略，第一次查询前由build()整体建立。
+ */
+class RailDBIndex
+{
+public:
+    using rail_set_t = QSet<const Railway*>;
+
+private:
+    /**
+     * 每条线路登记时所用的键，用于删除（线路数据可能已经变化）
+     */
+    struct RailKeys {
+        QVector<quint32> ids, bareIds;
+        QStringList grams;
+        QStringList names;    // 各站站名字面，子串搜索的验证用
+    };
+
+    QHash<quint32, rail_set_t> _byName, _byBareName;
+    QHash<QString, rail_set_t> _byGram;
+    QHash<const Railway*, RailKeys> _keys;
+    bool _valid = false;
+
+public:
+    RailDBIndex() = default;
+
+    bool isValid()const { return _valid; }
+    void invalidate();
+
+    void build(const RailCategory& root);
+
+    void addRailway(const Railway& railway);
+    void removeRailway(const Railway& railway);
+
+    /**
+     * 线路的车站表变化后重新登记
+     */
+    void updateRailway(const Railway& railway);
+
+    void addCategory(const RailCategory& cat);
+    void removeCategory(const RailCategory& cat);
+
+    /**
+     * 含有完整站名name的线路。与Railway::stationByName一致
+     */
+    rail_set_t searchFullName(const StationName& name)const;
+
+    /**
+     * 与Railway::stationByGeneralName一致：完整站名相同，或者含有同名的无场名车站
+     */
+    rail_set_t searchGeneralName(const StationName& name)const;
+
+    /**
+     * 站名字面（含场名）包含text的线路
+     */
+    rail_set_t searchNamePart(const QString& text)const;
+
+private:
+    static QStringList gramsOf(const QString& s);
+};
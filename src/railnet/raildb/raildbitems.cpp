@@ -140,6 +140,16 @@ std::deque<navi::path_t> navi::RailCategoryItem::searchBy(
     return res;
 }
 
+void navi::RailCategoryItem::collectRailways(QHash<const Railway*, RailwayItemDB*>& res)
+{
+    for (const auto& subcat : _subcats) {
+        subcat->collectRailways(res);
+    }
+    for (const auto& rail : _railways) {
+        res.insert(rail->railway().get(), rail.get());
+    }
+}
+
 
 navi::RailwayItemDB::RailwayItemDB(std::shared_ptr<Railway> rail,
                                    int row, RailCategoryItem *parent):
@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "model/diagram/componentitems.h"
+#include <QHash>
 
 class RailCategory;
 
@@ -63,6 +64,11 @@ namespace navi {
          * 从当前对象开始搜索。
          */
         std::deque<navi::path_t> searchBy(std::function<bool(const Railway& )> pred);
+
+        /**
+         * 2026.10  本节点（含子分类）下所有线路及其Item，加入res
+         */
+        void collectRailways(QHash<const Railway*, RailwayItemDB*>& res);
     };
 
 
@@ -2,6 +2,8 @@
 #include "raildb.h"
 #include "data/rail/railway.h"
 
+#include <algorithm>
+
 RailDBModel::RailDBModel(std::shared_ptr<RailDB> raildb, QObject *parent) :
     QAbstractItemModel(parent), _raildb(raildb),
     _root(std::make_unique<navi::RailCategoryItem>(raildb,0,nullptr))
@@ -119,18 +121,13 @@ QModelIndex RailDBModel::categoryIndexBrute(std::shared_ptr<RailCategory> catego
 
 std::deque<navi::path_t> RailDBModel::searchFullName(const QString &name)
 {
-    auto func=[&name](const Railway& rail)->bool{
-        return bool(rail.stationByName(name));
-    };
-    return _root->searchBy(func);
+    // 2026.10：由倒排索引得到线路集合，再直接取各线路的路径
+    return pathsOfRailways(_raildb->stationIndex().searchFullName(name));
 }
 
 std::deque<navi::path_t> RailDBModel::searchPartName(const QString &name)
 {
-    auto func=[&name](const Railway& rail)->bool{
-        return bool(rail.stationByGeneralName(name));
-    };
-    return _root->searchBy(func);
+    return pathsOfRailways(_raildb->stationIndex().searchGeneralName(name));
 }
 
 std::deque<navi::path_t> RailDBModel::searchRailName(const QString &name)
@@ -141,6 +138,27 @@ std::deque<navi::path_t> RailDBModel::searchRailName(const QString &name)
     return _root->searchBy(func);
 }
 
+std::deque<navi::path_t> RailDBModel::searchNamePart(const QString &name)
+{
+    return pathsOfRailways(_raildb->stationIndex().searchNamePart(name));
+}
+
+std::deque<navi::path_t> RailDBModel::pathsOfRailways(const QSet<const Railway*>& rails)
+{
+    if (rails.isEmpty()) return {};
+    if (_railItems.isEmpty())
+        _root->collectRailways(_railItems);
+    std::deque<navi::path_t> res;
+    foreach(auto rail, rails) {
+        if (auto* it = _railItems.value(rail)) {
+            res.emplace_back(it->path());
+        }
+    }
+    // 子分类的行在线路之前，按路径的字典序即为先序
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
 std::shared_ptr<Railway> RailDBModel::railwayByPath(const navi::path_t &path)
 {
     auto it=_root->itemByPath(path);
@@ -228,6 +246,7 @@ void RailDBModel::onRailInfoChanged(std::shared_ptr<Railway> railway, const std:
             railway->name() << ", will use brute-force alg. " << Qt::endl;
         idx = railIndexBrute(railway);
     }
+    _raildb->stationIndex().updateRailway(*railway);
     emit dataChanged(idx, index(idx.row(), ACI::DBColMAX - 1, idx.parent()), 
         { Qt::EditRole });
 }
@@ -259,6 +278,8 @@ void RailDBModel::commitRemoveRailwayAt(std::shared_ptr<Railway> railway,
     auto* par_it = static_cast<navi::RailCategoryItem*>(par.internalPointer());
     par_it->removeRailwayAt(path.back());
     endRemoveRows();
+    _railItems.clear();
+    _raildb->stationIndex().removeRailway(*railway);
 }
 
 void RailDBModel::commitInsertRailwayAt(std::shared_ptr<Railway> railway, const std::deque<int>& path)
@@ -270,6 +291,8 @@ void RailDBModel::commitInsertRailwayAt(std::shared_ptr<Railway> railway, const
     auto* par_it = static_cast<navi::RailCategoryItem*>(getParentItem(par));
     par_it->insertRailwayAt(railway, path.back());
     endInsertRows();
+    _railItems.clear();
+    _raildb->stationIndex().addRailway(*railway);
 }
 
 void RailDBModel::commitInsertRailwaysAt(const QList<std::shared_ptr<Railway>>& rails,
@@ -280,6 +303,10 @@ void RailDBModel::commitInsertRailwaysAt(const QList<std::shared_ptr<Railway>>&
     auto* par_it = static_cast<navi::RailCategoryItem*>(par.internalPointer());
     par_it->insertRailwaysAt(rails, path.back());
     endInsertRows();
+    _railItems.clear();
+    foreach(const auto& rail, rails) {
+        _raildb->stationIndex().addRailway(*rail);
+    }
 }
 
 void RailDBModel::commitRemoveRailwaysAt(const QList<std::shared_ptr<Railway>>& rails, const std::deque<int>& path)
@@ -297,6 +324,10 @@ void RailDBModel::commitRemoveRailwaysAt(const QList<std::shared_ptr<Railway>>&
     auto* par_it = static_cast<navi::RailCategoryItem*>(par.internalPointer());
     par_it->removeRailwaysAt(path.back(), rails.size());
     endRemoveRows();
+    _railItems.clear();
+    foreach(const auto& rail, rails) {
+        _raildb->stationIndex().removeRailway(*rail);
+    }
 }
 
 void RailDBModel::commitInsertCategoryAt(std::shared_ptr<RailCategory> cat,
@@ -308,6 +339,8 @@ void RailDBModel::commitInsertCategoryAt(std::shared_ptr<RailCategory> cat,
     auto* it = static_cast<navi::RailCategoryItem*>(getParentItem(par));
     it->insertCategoryAt(cat, path.back());
     endInsertRows();
+    _railItems.clear();
+    _raildb->stationIndex().addCategory(*cat);
 }
 
 void RailDBModel::commitRemoveCategoryAt(std::shared_ptr<RailCategory> cat, 
@@ -326,11 +359,15 @@ void RailDBModel::commitRemoveCategoryAt(std::shared_ptr<RailCategory> cat,
     beginRemoveRows(par, path.back(), path.back());
     par_it->removeCategoryAt(path.back());
     endRemoveRows();
+    _railItems.clear();
+    _raildb->stationIndex().removeCategory(*cat);
 }
 
 void RailDBModel::resetModel()
 {
     beginResetModel();
+    _raildb->stationIndex().invalidate();
     _root=std::make_unique<navi::RailCategoryItem>(_raildb,0,nullptr);
+    _railItems.clear();
     endResetModel();
 }
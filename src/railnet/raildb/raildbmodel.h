@@ -2,6 +2,8 @@
 
 #include <QAbstractItemModel>
 #include <memory>
+#include <QHash>
+#include <QSet>
 
 #include "raildbitems.h"
 class RailDB;
@@ -12,6 +14,13 @@ class RailDBModel : public QAbstractItemModel
     std::shared_ptr<RailDB> _raildb;
     std::unique_ptr<navi::RailCategoryItem> _root;
 
+    /**
+     * 2026.10  线路 -> 树中的Item，由站名索引的结果直接得到路径，不必遍历树。
+     * 首次查询时建立；增删线路、分类或重置时清空，下次查询重新建立。
+     * 行号变化不影响：路径由Item的当前位置给出。
+     */
+    QHash<const Railway*, navi::RailwayItemDB*> _railItems;
+
     using ACI=navi::AbstractComponentItem;
     using pACI=ACI*;
 
@@ -46,9 +55,19 @@ public:
     std::deque<navi::path_t> searchPartName(const QString& name);
     std::deque<navi::path_t> searchRailName(const QString& name);
 
+    /**
+     * 2026.10  站名字面中含有name的线路
+     */
+    std::deque<navi::path_t> searchNamePart(const QString& name);
+
     std::shared_ptr<Railway> railwayByPath(const navi::path_t& path);
 
 private:
+    /**
+     * 2026.10  索引给出的线路集合在树中的路径，按树的先序（与searchBy相同）排列
+     */
+    std::deque<navi::path_t> pathsOfRailways(const QSet<const Railway*>& rails);
+
     /**
      * @brief getParentItem
      * @param parent
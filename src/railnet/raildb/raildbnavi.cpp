@@ -59,12 +59,12 @@ void RailDBNavi::initUI()
     auto* hlay=new QHBoxLayout;
     edSearch=new QLineEdit;
     hlay->addWidget(edSearch);
-    auto* g=new ButtonGroup<3>({"搜索全站名","搜索部分站名","搜索线名"});
+    auto* g=new ButtonGroup<4>({"搜索全站名","搜索部分站名","搜索站名片段","搜索线名"});
     hlay->addLayout(g);
     vlay->addLayout(hlay);
     g->connectAll(SIGNAL(clicked()),this,
                   {SLOT(searchFullName()),SLOT(searchPartName()),
-                  SLOT(searchRailName())});
+                  SLOT(searchNamePart()),SLOT(searchRailName())});
 
     tree=new QTreeView;
     tree->setModel(model);
@@ -603,6 +603,11 @@ void RailDBNavi::searchPartName()
     searchResult(model->searchPartName(edSearch->text()));
 }
 
+void RailDBNavi::searchNamePart()
+{
+    searchResult(model->searchNamePart(edSearch->text()));
+}
+
 void RailDBNavi::searchRailName()
 {
     searchResult(model->searchRailName(edSearch->text()));
@@ -60,6 +60,11 @@ public:
      */
     bool deactiveOnClose();
 
+    /**
+     * 2026.10  是否有未保存的修改
+     */
+    bool isChanged()const { return _changed; }
+
 private:
     void initUI();
     void initContext();
@@ -114,6 +119,7 @@ private slots:
 
     void searchFullName();
     void searchPartName();
+    void searchNamePart();
     void searchRailName();
     void searchResult(const std::deque<std::deque<int>>& paths);
 
@@ -18,6 +18,7 @@
 #include <data/diagram/diagram.h>
 #include <viewers/traintimetableplane.h>
 #include <util/dialogadapter.h>
+#include <util/utilfunc.h>
 
 #include "traincomparedialog.h"
 
@@ -93,8 +94,11 @@ void DiagramCompareModel::resetData(diagram_diff_t &&diff)
 }
 
 DiagramCompareDialog::DiagramCompareDialog(Diagram& diagram, QWidget *parent):
-    QDialog(parent), diagram(diagram), model(new DiagramCompareModel(this))
+    QDialog(parent), diagram(diagram), model(new DiagramCompareModel(this)),
+    watcher(new QFutureWatcher<diagram_diff_t>(this))
 {
+    connect(watcher, &QFutureWatcher<diagram_diff_t>::finished,
+        this, &DiagramCompareDialog::onDiffFinished);
     setAttribute(Qt::WA_DeleteOnClose);
     setWindowTitle(tr("运行图对比"));
     initUI();
@@ -157,23 +161,53 @@ void DiagramCompareDialog::initUI()
 
 bool DiagramCompareDialog::loadFile(const QString &filename)
 {
-    Diagram dia;
-    bool flag=dia.fromJson(filename);
+    if (watcher->isRunning())
+        return false;
+    auto dia = std::make_shared<Diagram>();
+    bool flag=dia->fromJson(filename);
     if (!flag){
         QMessageBox::warning(this,tr("错误"),tr("运行图文件错误或为空，无法读取。"));
         return false;
     }
+    // 2026.10  后台计算；本图的快照和dia由任务持有，计算期间可以继续编辑本图
+    startTime = std::chrono::system_clock::now();
+    auto snap = diagram.snapshot();
+    taskSnapshot = snap;
+    taskDiagram = dia;
+    taskSources.clear();
+    const auto& sources = diagram.trainCollection().trains();
+    const auto& clones = snap->trainCollection().trains();
+    for (int i = 0; i < clones.size(); i++) {
+        taskSources.insert(clones.at(i).get(), sources.at(i));
+    }
+    qeutil::showTaskProgress(watcher, tr("运行图对比"), tr("正在对比车次..."), this, Qt::NonModal);
+    watcher->setFuture(qetask::run<diagram_diff_t>([snap, dia](const TaskContext& ctx) {
+        return snap->trainCollection().diffWith(dia->trainCollection(), ctx);
+        }));
+    return true;
+}
+
+void DiagramCompareDialog::onDiffFinished()
+{
+    if (watcher->isCanceled() || watcher->future().resultCount() == 0) {
+        taskSnapshot.reset();
+        taskDiagram.reset();
+        taskSources.clear();
+        emit showStatus(tr("运行图对比  已取消"));
+        return;
+    }
     using namespace std::chrono_literals;
-    auto c_start = std::chrono::system_clock::now();
-    auto t=diagram.trainCollection().diffWith(dia.trainCollection());
     auto c_end = std::chrono::system_clock::now();
-    model->resetData(std::move(t));
+    // 结果中的车次、车站引用快照和所对比运行图的数据，与结果一同保留
+    resultSnapshot = std::move(taskSnapshot);
+    resultDiagram = std::move(taskDiagram);
+    snapshotSources = std::move(taskSources);
+    model->resetData(watcher->result());
     auto c_end2 = std::chrono::system_clock::now();
     table->resizeColumnsToContents();
     auto c_end3 = std::chrono::system_clock::now();
-    emit showStatus(tr("运行图对比  计算用时 %1 毫秒  整理用时 %2 毫秒  调整用时 %3 毫秒").arg((c_end - c_start) / 1ms)
+    emit showStatus(tr("运行图对比  计算用时 %1 毫秒  整理用时 %2 毫秒  调整用时 %3 毫秒").arg((c_end - startTime) / 1ms)
         .arg((c_end2 - c_end) / 1ms).arg((c_end3-c_end2)/1ms));
-    return true;
 }
 
 void DiagramCompareDialog::viewFile()
@@ -263,9 +297,12 @@ void DiagramCompareDialog::resetRowShow()
             // 仅变化车次
             if (ckChanged->isChecked() && t->type == TrainDifference::Unchanged)
                 break;
-            // 列车筛选器
-            if (t->train1 && !filter->check(t->train1))
-                break;
+            // 列车筛选器：按本图中的原车次判定（快照中的车次不带交路）；原车次已删除的按副本判定
+            if (t->train1) {
+                auto src = snapshotSources.value(t->train1.get()).lock();
+                if (!filter->check(src ? std::shared_ptr<const Train>(src) : t->train1))
+                    break;
+            }
             flag = true;
         } while (false);
 
@@ -1,6 +1,9 @@
 ﻿#pragma once
 #include <QDialog>
 #include <QStandardItemModel>
+#include <QFutureWatcher>
+#include <QHash>
+#include <chrono>
 #include <data/diagram/diadiff.h>
 
 class Diagram;
@@ -50,6 +53,22 @@ class DiagramCompareDialog : public QDialog
     TrainFilter* filter;
 
     QTableView* table;
+
+    /**
+     * 2026.10  对比在后台计算
+     */
+    QFutureWatcher<diagram_diff_t>* const watcher;
+    std::chrono::system_clock::time_point startTime;
+
+    /**
+     * 2026.10  对比在本图的快照上进行，结果中的train1是快照中的车次副本，与各站的对比数据一致。
+     * 显示结果期间持有快照及所对比的运行图，保证其中的车次、时刻表有效。
+     * snapshotSources: 快照中的车次 -> 本图中的原车次，只用于按车次筛选器判定。
+     * task*为正在计算的任务所用的数据，完成后转为结果。
+     */
+    std::shared_ptr<const Diagram> resultSnapshot, taskSnapshot;
+    std::shared_ptr<const Diagram> resultDiagram, taskDiagram;
+    QHash<const Train*, std::weak_ptr<Train>> snapshotSources, taskSources;
 public:
     DiagramCompareDialog(Diagram& diagram, QWidget* parent=nullptr);
 private:
@@ -69,5 +88,6 @@ private slots:
     void resetRowShow();
     void actTrainDiff();
     void actTrainTimetable();
+    void onDiffFinished();
 };
 
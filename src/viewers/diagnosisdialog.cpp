@@ -11,6 +11,8 @@
 #include <QGroupBox>
 #include <QHeaderView>
 #include <QMessageBox>
+#include <QProgressDialog>
+#include <QPushButton>
 #include <QTableView>
 #include <chrono>
 #include <QScroller>
@@ -73,10 +75,17 @@ void DiagnosisModel::setupForAll(bool withIntMeet,
     setupModel();
 }
 
+void DiagnosisModel::setupForList(DiagnosisList&& list)
+{
+    lst = std::move(list);
+    setupModel();
+}
+
 
 
 DiagnosisDialog::DiagnosisDialog(Diagram& diagram_, QWidget *parent):
-    QDialog(parent), diagram(diagram_),model(new DiagnosisModel(diagram_,this))
+    QDialog(parent), diagram(diagram_),model(new DiagnosisModel(diagram_,this)),
+    watcher(new QFutureWatcher<DiagnosisList>(this))
 {
     setWindowTitle(tr("时刻诊断"));
     resize(800, 800);
@@ -86,7 +95,8 @@ DiagnosisDialog::DiagnosisDialog(Diagram& diagram_, QWidget *parent):
 
 DiagnosisDialog::DiagnosisDialog(Diagram& diagram_, std::shared_ptr<Train> train,
     QWidget* parent) :
-    QDialog(parent), diagram(diagram_), model(new DiagnosisModel(diagram_, this))
+    QDialog(parent), diagram(diagram_), model(new DiagnosisModel(diagram_, this)),
+    watcher(new QFutureWatcher<DiagnosisList>(this))
 {
     setWindowTitle(tr("时刻诊断"));
     resize(800, 800);
@@ -137,11 +147,13 @@ void DiagnosisDialog::initUI()
 
     hlay->addLayout(flay);
     auto* cv = new QVBoxLayout;
-    auto* btn = new QPushButton(tr("确定"));
-    cv->addWidget(btn);
-    connect(btn, &QPushButton::clicked, this, &DiagnosisDialog::actApply);
+    btnApply = new QPushButton(tr("确定"));
+    cv->addWidget(btnApply);
+    connect(btnApply, &QPushButton::clicked, this, &DiagnosisDialog::actApply);
+    connect(watcher, &QFutureWatcher<DiagnosisList>::finished,
+        this, &DiagnosisDialog::onAllFinished);
 
-    btn = new QPushButton(tr("说明"));
+    auto* btn = new QPushButton(tr("说明"));
     connect(btn, &QPushButton::clicked, this, &DiagnosisDialog::actHelp);
     cv->addWidget(btn);
     hlay->addLayout(cv);
@@ -178,8 +190,9 @@ std::pair<std::shared_ptr<RailStation>, std::shared_ptr<RailStation> > Diagnosis
 
 void DiagnosisDialog::actApply()
 {
-    using namespace std::chrono_literals;
-    auto start = std::chrono::system_clock::now();
+    if (watcher->isRunning())
+        return;
+    startTime = std::chrono::system_clock::now();
     auto [sst,est]=getFilterRange();
     if (rdSingle->isChecked()) {
         auto train = cbTrain->train();
@@ -189,12 +202,44 @@ void DiagnosisDialog::actApply()
         }
         model->setupForTrain(train, ckIntMeet->isChecked(),
                              getFilterRailway(),sst,est);
+        reportResult();
     }
     else {
-        model->setupForAll(ckIntMeet->isChecked(),getFilterRailway(),sst,est);
+        // 全部车次：后台并行计算。计算期间以模态进度框阻止对运行图的修改。
+        auto* progress = new QProgressDialog(tr("正在诊断所有车次..."), tr("取消"),
+            0, diagram.trainCollection().trainCount(), this);
+        progress->setWindowTitle(tr("时刻诊断"));
+        progress->setWindowModality(Qt::ApplicationModal);
+        progress->setMinimumDuration(0);
+        connect(watcher, &QFutureWatcher<DiagnosisList>::progressValueChanged,
+            progress, &QProgressDialog::setValue);
+        connect(watcher, &QFutureWatcher<DiagnosisList>::finished,
+            progress, &QProgressDialog::deleteLater);
+        connect(progress, &QProgressDialog::canceled,
+            watcher, &QFutureWatcher<DiagnosisList>::cancel);
+        btnApply->setEnabled(false);
+        progress->show();
+        watcher->setFuture(diagram.diagnoseAllTrainsAsync(ckIntMeet->isChecked(),
+            getFilterRailway(), sst, est));
+    }
+}
+
+void DiagnosisDialog::onAllFinished()
+{
+    btnApply->setEnabled(true);
+    if (watcher->isCanceled()) {
+        emit showStatus(tr("时刻诊断  已取消"));
+        return;
     }
+    model->setupForList(Diagram::mergeDiagnosis(watcher->future()));
+    reportResult();
+}
+
+void DiagnosisDialog::reportResult()
+{
+    using namespace std::chrono_literals;
     auto end = std::chrono::system_clock::now();
-    emit showStatus(tr("时刻诊断  用时%1毫秒").arg((end - start) / 1ms));
+    emit showStatus(tr("时刻诊断  用时%1毫秒").arg((end - startTime) / 1ms));
 
     if (model->rowCount() == 0)
         QMessageBox::information(this, tr("提示"), tr("当前所选范围内未发现问题。"));
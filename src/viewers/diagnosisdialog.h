@@ -2,6 +2,8 @@
 
 #include <QDialog>
 #include <QStandardItemModel>
+#include <QFutureWatcher>
+#include <chrono>
 
 #include "data/diagram/trainevents.h"
 
@@ -11,6 +13,7 @@ class SelectRailwayCombo;
 class QTableView;
 class QCheckBox;
 class QRadioButton;
+class QPushButton;
 
 class Diagram;
 
@@ -45,6 +48,11 @@ public slots:
                      std::shared_ptr<Railway> railway,
                      std::shared_ptr<RailStation> start,
                      std::shared_ptr<RailStation> end);
+
+    /**
+     * 直接使用已经计算好的结果，用于异步诊断
+     */
+    void setupForList(DiagnosisList&& list);
 };
 
 class SelectTrainCombo;
@@ -67,6 +75,13 @@ class DiagnosisDialog : public QDialog
     SelectRailwayCombo* cbRail;
     RailRangeCombo* cbRange;
     QCheckBox* ckFiltRail,*ckFiltRange;
+    QPushButton* btnApply;
+
+    /**
+     * 全部车次诊断采用异步并行计算，用此对象监视进度。
+     */
+    QFutureWatcher<DiagnosisList>* const watcher;
+    std::chrono::system_clock::time_point startTime;
 public:
     DiagnosisDialog(Diagram& diagram_, QWidget* parent = nullptr);
     DiagnosisDialog(Diagram& diagram_, std::shared_ptr<Train> train, 
@@ -80,11 +95,21 @@ private:
     std::shared_ptr<Railway> getFilterRailway();
     std::pair<std::shared_ptr<RailStation>,std::shared_ptr<RailStation>>
         getFilterRange();
+
+    /**
+     * 计算完成后，报告用时和结果
+     */
+    void reportResult();
 signals:
     void showStatus(const QString&);
 private slots:
     void actApply();
     void onSingleToggled(bool on);
+
+    /**
+     * 异步诊断完成（或被取消）
+     */
+    void onAllFinished();
     void actHelp();
 
     void onFiltRailChanged(bool on);
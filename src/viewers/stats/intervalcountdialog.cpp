@@ -99,12 +99,24 @@ IntervalCountDialog::IntervalCountDialog(Diagram &diagram, QWidget *parent):
     QDialog(parent), diagram(diagram),
     filter(new TrainFilter(diagram,this)),
     counter(diagram.trainCollection(),filter->getCore()),
-    model(new IntervalCountModel(counter, this))
+    model(new IntervalCountModel(counter, this)),
+    watcher(new QFutureWatcher<RailIntervalCount>(this)),
+    matrixWatcher(new QFutureWatcher<RailIntervalMatrix>(this))
 {
     setAttribute(Qt::WA_DeleteOnClose);
+    connect(watcher, &QFutureWatcher<RailIntervalCount>::finished,
+        this, &IntervalCountDialog::onCountFinished);
+    connect(matrixWatcher, &QFutureWatcher<RailIntervalMatrix>::finished,
+        this, &IntervalCountDialog::onMatrixFinished);
     initUI();
 }
 
+IntervalCountDialog::~IntervalCountDialog() noexcept
+{
+    watcher->cancel();
+    matrixWatcher->cancel();
+}
+
 void IntervalCountDialog::initUI()
 {
     setWindowTitle(tr("区间对数表"));
@@ -154,7 +166,7 @@ void IntervalCountDialog::initUI()
     connect(ckStop,&QCheckBox::toggled,
             this,&IntervalCountDialog::refreshData);
     connect(filter,&TrainFilter::filterApplied,
-            this,&IntervalCountDialog::refreshData);
+            this,&IntervalCountDialog::onFilterApplied);
     connect(btn,&QPushButton::clicked,
             filter,&TrainFilter::show);
     flay->addRow(tr("车次筛选"),hlay);
@@ -176,9 +188,9 @@ void IntervalCountDialog::initUI()
 
     vlay->addWidget(table);
 
-    auto* g=new ButtonGroup<2>({"导出CSV","关闭"});
+    auto* g=new ButtonGroup<3>({"导出CSV","全线OD矩阵","关闭"});
     g->connectAll(SIGNAL(clicked()),this,
-                  {SLOT(toCsv()),SLOT(close())});
+                  {SLOT(toCsv()),SLOT(matrixToCsv()),SLOT(close())});
     vlay->addLayout(g);
 
     refreshData();
@@ -186,31 +198,72 @@ void IntervalCountDialog::initUI()
 
 void IntervalCountDialog::refreshData()
 {
+    if (watcher->isRunning()) {
+        refreshPending = true;
+        return;
+    }
+    refreshPending = false;
     counter.setBusinessOnly(ckBusiness->isChecked());
     counter.setStopOnly(ckStop->isChecked());
     counter.setPassengerOnly(ckPassenger->isChecked());
     counter.setFreightOnly(ckFreight->isChecked());
 
-    RailIntervalCount data;
-    if (rdStart->get(0)->isChecked()){
-        // 单源点
-        data=counter.getIntervalCountSource(cbStation->railway(),
-                                            cbStation->station());
-    }else{
-        data=counter.getIntervalCountDrain(cbStation->railway(),
-                                           cbStation->station());
+    auto rail = cbStation->railway();
+    auto station = cbStation->station();
+    taskIsSource = rdStart->get(0)->isChecked();
+    if (!rail)
+        return;
+
+    // 2026.10  在快照上统计，任务不读取本图数据，计算期间可以继续编辑运行图
+    auto snap = diagram.snapshot();
+    taskRailway = diagram.railwayInSnapshot(*snap, *rail);
+    if (!taskRailway)
+        return;
+    taskStation = taskRailway->stations().value(rail->stations().indexOf(station));
+    auto core = filter->getCore().snapshotFilter(diagram.trainCollection(), snap->trainCollection());
+    IntervalCounter snapCounter(counter, snap->trainCollection(), *core);
+
+    if (taskIsSource && matrix && snapCounter.isMatrixKeyCurrent(matrixKey, taskRailway)) {
+        // 全线矩阵仍有效（快照复用了同一线路副本），直接取该站的行
+        auto itr = matrix->find(taskStation);
+        model->resetData(itr == matrix->end() ? RailIntervalCount{} : RailIntervalCount(itr->second),
+            taskStation, taskIsSource, taskRailway);
+        refreshShow();
+        return;
+    }
+
+    qeutil::showTaskProgress(watcher, tr("区间对数表"), tr("正在统计区间对数..."), this,
+        Qt::NonModal);
+    watcher->setFuture(qetask::run<RailIntervalCount>(
+        [snap, core, counter = snapCounter,
+        rail = taskRailway, st = taskStation, source = taskIsSource]
+    (const TaskContext& ctx) {
+            if (source) {
+                // 单源点
+                return counter.getIntervalCountSource(rail, st, ctx);
+            }
+            else {
+                return counter.getIntervalCountDrain(rail, st, ctx);
+            }
+        }));
+}
+
+void IntervalCountDialog::onCountFinished()
+{
+    if (refreshPending) {
+        refreshData();
+        return;
     }
-    model->resetData(std::move(data), cbStation->station(),rdStart->get(0)->isChecked(),
-        cbStation->railway());
+    if (watcher->isCanceled() || watcher->future().resultCount() == 0)
+        return;
+    model->resetData(watcher->result(), taskStation, taskIsSource, taskRailway);
     refreshShow();
 }
 
 void IntervalCountDialog::refreshShow()
 {
-    auto rail = cbStation->railway();
-    if (!rail) return;
     for (int i = 0; i < model->rowCount(); i++) {
-        auto st = rail->stations().at(i);
+        auto st = model->stationForRow(i);
         table->setRowHidden(i, !counter.checkStation(st));
     }
 }
@@ -257,4 +310,82 @@ void IntervalCountDialog::toCsv()
         tr("%1区间对数表").arg(rail->name()));
 }
 
+void IntervalCountDialog::onFilterApplied()
+{
+    matrix.reset();
+    refreshData();
+}
 
+void IntervalCountDialog::matrixToCsv()
+{
+    if (matrixWatcher->isRunning())
+        return;
+    auto rail = cbStation->railway();
+    if (!rail)return;
+    counter.setBusinessOnly(ckBusiness->isChecked());
+    counter.setStopOnly(ckStop->isChecked());
+    counter.setPassengerOnly(ckPassenger->isChecked());
+    counter.setFreightOnly(ckFreight->isChecked());
+    auto snap = diagram.snapshot();
+    auto snapRail = diagram.railwayInSnapshot(*snap, *rail);
+    if (!snapRail)
+        return;
+    auto core = filter->getCore().snapshotFilter(diagram.trainCollection(), snap->trainCollection());
+    IntervalCounter snapCounter(counter, snap->trainCollection(), *core);
+    if (matrix && snapCounter.isMatrixKeyCurrent(matrixKey, snapRail)) {
+        exportMatrix();
+        return;
+    }
+
+    matrixTaskRailway = snapRail;
+    matrixTaskKey = snapCounter.matrixKey(snapRail);
+    qeutil::showTaskProgress(matrixWatcher, tr("全线OD矩阵"), tr("正在统计全线OD矩阵..."), this,
+        Qt::NonModal);
+    matrixWatcher->setFuture(qetask::run<RailIntervalMatrix>(
+        [snap, core, counter = snapCounter, rail = snapRail](const TaskContext& ctx) {
+            return counter.getIntervalCountMatrix(rail, ctx);
+        }));
+}
+
+void IntervalCountDialog::onMatrixFinished()
+{
+    if (matrixWatcher->isCanceled() || matrixWatcher->future().resultCount() == 0)
+        return;
+    matrix = std::make_shared<const RailIntervalMatrix>(matrixWatcher->result());
+    matrixKey = std::move(matrixTaskKey);
+    matrixRailway = std::move(matrixTaskRailway);
+    exportMatrix();
+}
+
+void IntervalCountDialog::exportMatrix()
+{
+    // 行为发站，列为到站，按当前车站筛选条件取舍
+    std::vector<std::shared_ptr<const RailStation>> stations;
+    foreach(auto st, matrixRailway->stations()) {
+        if (counter.checkStation(st))
+            stations.push_back(st);
+    }
+
+    QStandardItemModel mat;
+    mat.setColumnCount(static_cast<int>(stations.size()) + 1);
+    mat.setRowCount(static_cast<int>(stations.size()));
+    QStringList labels{ tr("发站/到站") };
+    for (const auto& st : stations)
+        labels.append(st->name.toSingleLiteral());
+    mat.setHorizontalHeaderLabels(labels);
+
+    for (int i = 0; i < static_cast<int>(stations.size()); i++) {
+        mat.setItem(i, 0, new QStandardItem(stations.at(i)->name.toSingleLiteral()));
+        auto row = matrix->find(stations.at(i));
+        for (int j = 0; j < static_cast<int>(stations.size()); j++) {
+            int n = 0;
+            if (row != matrix->end()) {
+                if (auto itr = row->second.find(stations.at(j)); itr != row->second.end())
+                    n = itr->second.count();
+            }
+            mat.setItem(i, j + 1, new QStandardItem(i == j ? "-" : QString::number(n)));
+        }
+    }
+    qeutil::exportTableToCsv(&mat, this,
+        tr("%1 OD矩阵").arg(matrixRailway->name()));
+}
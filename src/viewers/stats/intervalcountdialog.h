@@ -2,6 +2,7 @@
 
 #include <QDialog>
 #include <QStandardItemModel>
+#include <QFutureWatcher>
 #include <data/analysis/inttrains/intervalcounter.h>
 #include <util/buttongroup.hpp>
 
@@ -62,14 +63,49 @@ class IntervalCountDialog : public QDialog
     IntervalCounter counter;
     IntervalCountModel* const model;
 
+    /**
+     * 2026.10  统计在后台、在Diagram::snapshot()的数据上计算。计算期间再次要求刷新时，结束后重新计算。
+     * task*为正在计算的参数（快照中的线路、车站），供结果写入model。
+     */
+    QFutureWatcher<RailIntervalCount>* const watcher;
+    bool refreshPending = false;
+    std::shared_ptr<const Railway> taskRailway;
+    std::shared_ptr<const RailStation> taskStation;
+    bool taskIsSource = true;
+
+    /**
+     * 2026.10  全线OD矩阵，一次计算所有发站的统计。
+     * 缓存到运行图数据、筛选结果或统计条件变化为止（见IntervalCounter::MatrixKey，
+     * 以快照中的线路、车次为键），期间按发站查询直接取矩阵的行。
+     * matrixRailway为统计所用的快照中的线路，矩阵以其车站为键。
+     */
+    QFutureWatcher<RailIntervalMatrix>* const matrixWatcher;
+    std::shared_ptr<const RailIntervalMatrix> matrix;
+    IntervalCounter::MatrixKey matrixKey, matrixTaskKey;
+    std::shared_ptr<const Railway> matrixRailway, matrixTaskRailway;
+
 public:
     IntervalCountDialog(Diagram& diagram,QWidget* parent=nullptr);
+
+    /**
+     * 取消未完成的任务。任务只持有快照数据，不必等待
+     */
+    ~IntervalCountDialog()noexcept;
 private:
     void initUI();
 private slots:
     void refreshData();
+    void onCountFinished();
     void refreshShow();
     void onDoubleClicked();
     void toCsv();
+    void onFilterApplied();
+
+    /**
+     * 导出全线OD矩阵；缓存无效时先在后台计算
+     */
+    void matrixToCsv();
+    void onMatrixFinished();
+    void exportMatrix();
 };
 
@@ -22,19 +22,28 @@
 #include <data/calculation/greedypainter.h>
 #include <dialogs/trainfilter.h>
 #include <data/analysis/traingap/traingapana.h>
+#include <util/utilfunc.h>
 
 
 GreedyPaintPageConstraint::GreedyPaintPageConstraint(Diagram& diagram_, GreedyPainter &_painter,
                                                      QWidget *parent):
     QWidget(parent), diagram(diagram_), painter(_painter),
     _model(new GapConstraintModel(this)),
-    _mdForbid(new SelectForbidModel(this))
+    _mdForbid(new SelectForbidModel(this)),
+    gapWatcher(new QFutureWatcher<std::map<TrainGapTypePair, int>>(this))
 {
     setWindowTitle(tr("排图参数"));
+    connect(gapWatcher, &QFutureWatcher<std::map<TrainGapTypePair, int>>::finished,
+        this, &GreedyPaintPageConstraint::onGapFromCurrentFinished);
     initGapSets();
     initUI();
 }
 
+GreedyPaintPageConstraint::~GreedyPaintPageConstraint() noexcept
+{
+    gapWatcher->cancel();
+}
+
 void GreedyPaintPageConstraint::initUI()
 {
     auto* vlay=new QVBoxLayout(this);
@@ -186,11 +195,35 @@ void GreedyPaintPageConstraint::onGapSetToggled(int id, bool on)
 
 void GreedyPaintPageConstraint::onGetGapFromCurrent()
 {
-    TrainGapAna gapana(diagram, filter->getCore());
-    gapana.setSingleLine(ckSingle->isChecked());
-    gapana.setCutSecs(spMinGap->value());
-
-    auto res = gapana.globalMinimal(cbRuler->railway());
+    if (gapWatcher->isRunning())
+        return;
+    auto rail = cbRuler->railway();
+    if (!rail)
+        return;
+    // 2026.10  在快照上统计：事件表和筛选结果在此生成，任务不读取本图数据，
+    // 因此计算期间可以继续编辑运行图，进度窗口也不必模态
+    auto snap = diagram.snapshot();
+    auto snapRail = diagram.railwayInSnapshot(*snap, *rail);
+    if (!snapRail)
+        return;
+    auto axis = std::make_shared<const RailwayStationEventAxis>(
+        snap->stationEventAxisForRail(snapRail));
+    auto core = filter->getCore().snapshotFilter(diagram.trainCollection(), snap->trainCollection());
+    qeutil::showTaskProgress(gapWatcher, tr("读取间隔"), tr("正在统计现有运行图的列车间隔..."),
+        this, Qt::NonModal);
+    gapWatcher->setFuture(qetask::run<std::map<TrainGapTypePair, int>>(
+        [snap, axis, core, single = ckSingle->isChecked(),
+        cutSecs = spMinGap->value()](const TaskContext& ctx) {
+            TrainGapAna gapana(*snap, *core);
+            gapana.setSingleLine(single);
+            gapana.setCutSecs(cutSecs);
+            return gapana.globalMinimal(*axis, ctx);
+        }));
+}
 
-    _model->setConstrainFromCurrent(res, spMinGap->value(), spMaxGap->value());
+void GreedyPaintPageConstraint::onGapFromCurrentFinished()
+{
+    if (gapWatcher->isCanceled() || gapWatcher->future().resultCount() == 0)
+        return;
+    _model->setConstrainFromCurrent(gapWatcher->result(), spMinGap->value(), spMaxGap->value());
 }
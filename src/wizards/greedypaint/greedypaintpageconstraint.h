@@ -1,8 +1,11 @@
 ﻿#pragma once
 #include <QWidget>
+#include <QFutureWatcher>
+#include <map>
 #include <util/buttongroup.hpp>
 #include <array>
 #include <data/gapset/gapsetabstract.h>
+#include <data/diagram/traingap.h>
 
 class SelectForbidModel;
 class QListView;
@@ -37,11 +40,21 @@ class GreedyPaintPageConstraint : public QWidget
 
     TrainFilter* filter;
     QSpinBox* spMinGap, * spMaxGap;
+
+    /**
+     * 2026.10  从现有运行图读取间隔：在后台计算
+     */
+    QFutureWatcher<std::map<TrainGapTypePair, int>>* const gapWatcher;
 public:
     explicit GreedyPaintPageConstraint(
             Diagram& _diagram,
             GreedyPainter& _painter,
             QWidget *parent = nullptr);
+
+    /**
+     * 取消未完成的任务。任务只持有快照数据，不必等待
+     */
+    ~GreedyPaintPageConstraint()noexcept;
 private:
     void initUI();
     void initGapSets();
@@ -61,5 +74,6 @@ private slots:
     void onSingleLineChanged(bool on);
     void onGapSetToggled(int id, bool on);
     void onGetGapFromCurrent();
+    void onGapFromCurrentFinished();
 };
 
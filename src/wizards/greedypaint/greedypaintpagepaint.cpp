@@ -9,6 +9,12 @@
 #include <QMessageBox>
 #include <QLabel>
 #include <QTextBrowser>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QSpinBox>
+#include <QProgressDialog>
+#include <QRegularExpression>
+#include <QSet>
 
 #include <data/train/trainname.h>
 #include <data/common/qesystem.h>
@@ -22,6 +28,9 @@
 #include <data/calculation/greedypainter.h>
 #include <data/diagram/diagram.h>
 #include <data/train/train.h>
+#include <data/train/traincollection.h>
+#include <data/train/typemanager.h>
+#include <util/utilfunc.h>
 
 
 GreedyPaintConfigModel::GreedyPaintConfigModel(QWidget* parent):
@@ -387,8 +396,11 @@ GreedyPaintPagePaint::GreedyPaintPagePaint(Diagram &diagram_,
                                            GreedyPainter &painter_,
                                            QWidget *parent):
     QWidget(parent),diagram(diagram_),painter(painter_),
-    _model(new GreedyPaintConfigModel(this))
+    _model(new GreedyPaintConfigModel(this)),
+    batchWatcher(new QFutureWatcher<std::vector<GreedyPainter::BatchResult>>(this))
 {
+    connect(batchWatcher, &QFutureWatcher<std::vector<GreedyPainter::BatchResult>>::finished,
+        this, &GreedyPaintPagePaint::onBatchFinished);
     initUI();
     connect(_model, &GreedyPaintConfigModel::startStationChanged,
         this, &GreedyPaintPagePaint::onStartChanged);
@@ -501,6 +513,10 @@ void GreedyPaintPagePaint::initUI()
     hlay->addStretch(1);
     hlay->addWidget(btn);
     connect(btn,&QPushButton::clicked,this,&GreedyPaintPagePaint::onApply);
+    btn = new QPushButton(tr("批量铺画"));
+    btn->setToolTip(tr("按当前铺画设置，以固定间隔连续铺画一组车次并提交"));
+    hlay->addWidget(btn);
+    connect(btn, &QPushButton::clicked, this, &GreedyPaintPagePaint::onBatchPaint);
     btn = new QPushButton(tr("报告"));
     hlay->addWidget(btn);
     connect(btn, &QPushButton::clicked, txtOut, &QWidget::show);
@@ -662,6 +678,168 @@ void GreedyPaintPagePaint::onApply()
 
 }
 
+QString GreedyPaintPagePaint::batchTrainName(const QString& first, int i)
+{
+    static const QRegularExpression re(R"((\d+)$)");
+    auto mat = re.match(first);
+    if (!mat.hasMatch()) {
+        return i ? QString("%1-%2").arg(first).arg(i) : first;
+    }
+    const QString& digits = mat.captured(1);
+    return first.left(mat.capturedStart(1)) +
+        QString("%1").arg(digits.toLongLong() + i, digits.size(), 10, QChar('0'));
+}
+
+void GreedyPaintPagePaint::onBatchPaint()
+{
+    if (batchWatcher->isRunning())
+        return;
+    if (!painter.ruler()) {
+        QMessageBox::warning(this, tr("错误"), tr("无效标尺！"));
+        return;
+    }
+    if (_model->startRow() == _model->endRow()) {
+        return;
+    }
+
+    QDialog dlg(this);
+    dlg.setWindowTitle(tr("批量铺画"));
+    auto* flay = new QFormLayout(&dlg);
+    auto* lab = new QLabel(tr("以当前车次为第一个车次，按当前的铺画范围、停站和选项，"
+        "自锚点时刻起每隔指定时间铺画一个车次。先铺画的车次作为后铺画车次的约束。"
+        "某车次在锚点时刻铺画失败时，在容许推后的范围内逐分钟推后重试。"
+        "铺画成功的车次直接提交。"));
+    lab->setWordWrap(true);
+    flay->addRow(lab);
+    auto* spCount = new QSpinBox;
+    spCount->setRange(1, 1000);
+    spCount->setValue(10);
+    flay->addRow(tr("车次数"), spCount);
+    auto* spGap = new QSpinBox;
+    spGap->setRange(1, 24 * 60);
+    spGap->setValue(60);
+    spGap->setSuffix(tr(" 分钟"));
+    flay->addRow(tr("锚点时刻间隔"), spGap);
+    auto* spWindow = new QSpinBox;
+    spWindow->setRange(0, 24 * 60);
+    spWindow->setValue(10);
+    spWindow->setSuffix(tr(" 分钟"));
+    flay->addRow(tr("容许推后"), spWindow);
+    auto* box = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(box, &QDialogButtonBox::accepted, &dlg, &QDialog::accept);
+    connect(box, &QDialogButtonBox::rejected, &dlg, &QDialog::reject);
+    flay->addRow(box);
+    if (dlg.exec() != QDialog::Accepted)
+        return;
+
+    std::vector<GreedyPainter::BatchRequest> requests;
+    QSet<QString> names;
+    for (int i = 0; i < spCount->value(); i++) {
+        const QString& name = batchTrainName(edTrainName->text(), i);
+        TrainName tn(name);
+        if (names.contains(name) || !diagram.trainCollection().trainNameIsValid(tn, nullptr)) {
+            QMessageBox::warning(this, tr("错误"),
+                tr("批量铺画的第%1个车次[%2]非法：车次不能为空或与现有车次重复。").arg(i + 1).arg(name));
+            return;
+        }
+        names.insert(name);
+        GreedyPainter::BatchRequest req;
+        req.trainName = tn;
+        req.anchor = _model->anchorStation();
+        req.start = _model->startStation();
+        req.end = _model->endStation();
+        req.dir = DirFunc::fromIsDown(gpDir->get(0)->isChecked());
+        req.anchorTime = edAnchorTime->time().addSecs(i * spGap->value() * 60);
+        req.anchorAsArrive = gpAnchorRole->get(0)->isChecked();
+        req.localStarting = ckStarting->isChecked();
+        req.localTerminal = ckTerminal->isChecked();
+        req.settledStops = _model->stopSeconds();
+        req.windowSecs = spWindow->value() * 60;
+        requests.push_back(std::move(req));
+    }
+
+    onClearTmp();
+    // 2026.10  任务使用铺画器的副本和事件表的副本（在此生成），不修改本页的铺画器和运行图的缓存。
+    // 铺画仍读取本图的线路和现有运行线，因此进度框立即显示并模态，期间不能编辑运行图；
+    // 本页也禁用到结束为止（进度框因此以所在窗口为父对象，以免随本页禁用）。
+    auto axis = std::make_shared<RailwayStationEventAxis>(
+        *diagram.stationEventAxisCached(painter.railway()));
+    auto p = std::make_shared<GreedyPainter>(painter);
+    auto stop = std::make_shared<std::atomic_bool>(false);
+    batchStop = stop;
+    batchTotal = static_cast<int>(requests.size());
+    setEnabled(false);
+    auto* progress = qeutil::showTaskProgress(batchWatcher, tr("批量铺画"), tr("正在批量铺画..."),
+        window(), Qt::ApplicationModal, 0);
+    // 取消按钮只置停止标志：任务返回已完成的车次，照常提交；进度框保留到任务结束，期间仍模态
+    disconnect(progress, &QProgressDialog::canceled, batchWatcher, &QFutureWatcherBase::cancel);
+    progress->setAutoClose(false);
+    const QString& stoppingText = tr("正在停止，完成当前车次后结束...");
+    connect(progress, &QProgressDialog::canceled, progress, [progress, stop, stoppingText]() {
+        stop->store(true);
+        progress->setLabelText(stoppingText);
+        progress->setCancelButton(nullptr);
+        progress->show();
+    });
+    batchWatcher->setFuture(qetask::run<std::vector<GreedyPainter::BatchResult>>(
+        [p, axis, stop, requests = std::move(requests)](const TaskContext& ctx) {
+            return p->paintBatch(axis, requests, ctx, stop.get());
+        }));
+}
+
+void GreedyPaintPagePaint::onBatchFinished()
+{
+    setEnabled(true);
+    const bool stopped = batchStop && batchStop->load();
+    batchStop.reset();
+    if (batchWatcher->isCanceled() || batchWatcher->future().resultCount() == 0)
+        return;
+    const auto& results = batchWatcher->result();
+
+    QString report;
+    report.append(tr("已配置间隔约束：\n%1\n").arg(painter.constraints().toString()));
+    report.append(tr("\n--------------------------------------\n批量铺画结果：\n"));
+    if (stopped) {
+        report.append(tr("批量铺画已取消：共%1个车次，完成%2个，已完成的结果照常提交。\n")
+            .arg(batchTotal).arg(static_cast<int>(results.size())));
+    }
+    int success = 0;
+    for (const auto& r : results) {
+        const QString& name = r.train ? r.train->trainName().full() : QString();
+        if (r.success) {
+            success++;
+            report.append(tr("%1  成功  锚点时刻 %2  尝试 %3 次  回退 %4 次\n").arg(name,
+                r.anchorTime.toString("hh:mm:ss")).arg(r.attempts).arg(r.backoffCount));
+            r.train->setType(diagram.trainCollection().typeManager().fromRegex(r.train->trainName()));
+            diagram.updateTrain(r.train);
+            emit trainAdded(r.train);
+        }
+        else {
+            report.append(tr("%1  失败  最后尝试锚点时刻 %2  尝试 %3 次  回退 %4 次\n").arg(name,
+                r.anchorTime.toString("hh:mm:ss")).arg(r.attempts).arg(r.backoffCount));
+        }
+    }
+    for (const auto& r : results) {
+        if (r.success)
+            continue;
+        report.append(tr("\n--------------------------------------\n[%1] 最后一次尝试的运行记录：\n")
+            .arg(r.train ? r.train->trainName().full() : QString()));
+        int i = 0;
+        for (const auto& t : r.logs) {
+            report.append(tr("%1. %2\n").arg(++i).arg(t));
+        }
+    }
+    txtOut->setText(report);
+
+    emit showStatus(tr("批量铺画 成功 %1 个，失败 %2 个").arg(success)
+        .arg(static_cast<int>(results.size()) - success) +
+        (stopped ? tr("，已取消 %1 个").arg(batchTotal - static_cast<int>(results.size())) : QString()));
+    if (success < static_cast<int>(results.size())) {
+        QMessageBox::warning(this, tr("提示"), tr("批量铺画中有%1个车次铺画失败，详见[报告]。")
+            .arg(static_cast<int>(results.size()) - success));
+    }
+}
+
 void GreedyPaintPagePaint::onStartChanged(std::shared_ptr<const RailStation> st)
 {
     edStart->setText(st->name.toSingleLiteral());
@@ -2,15 +2,17 @@
 
 #include <QWidget>
 #include <QStandardItemModel>
+#include <QFutureWatcher>
+#include <atomic>
 #include <util/buttongroup.hpp>
 #include <data/common/direction.h>
+#include <data/calculation/greedypainter.h>
 
 class QTableView;
 class Train;
 class QTimeEdit;
 class QCheckBox;
 class QLineEdit;
-class GreedyPainter;
 class Diagram;
 class Ruler;
 class RailStation;
@@ -136,6 +138,17 @@ class GreedyPaintPagePaint : public QWidget
 
     QLineEdit* edStart, * edAnchor, * edEnd;
 
+    /**
+     * 2026.10  批量铺画在后台计算
+     */
+    QFutureWatcher<std::vector<GreedyPainter::BatchResult>>* const batchWatcher;
+
+    /**
+     * 2026.10  批量铺画的停止标志和车次总数。不经QFuture取消，以保留已完成的结果
+     */
+    std::shared_ptr<std::atomic_bool> batchStop;
+    int batchTotal = 0;
+
 public:
     explicit GreedyPaintPagePaint(Diagram& diagram_,
             GreedyPainter& painter_,
@@ -159,6 +172,12 @@ private:
      */
     void mergeTmpTrain();
 
+    /**
+     * 2026.10  批量铺画的车次：以first为第一个，末尾数字依次递增（保持位数）；
+     * 不以数字结尾的，在后面加序号。
+     */
+    static QString batchTrainName(const QString& first, int i);
+
 signals:
     void showStatus(const QString& );
     void trainAdded(std::shared_ptr<Train>);
@@ -180,6 +199,12 @@ private slots:
 
     void onApply();
 
+    /**
+     * 2026.10  按当前铺画设置，以给定间隔连续铺画一组车次
+     */
+    void onBatchPaint();
+    void onBatchFinished();
+
     void onStartChanged(std::shared_ptr<const RailStation>);
     void onEndChanged(std::shared_ptr<const RailStation>);
     void onAnchorChanged(std::shared_ptr<const RailStation>);
@@ -10,6 +10,8 @@
 #include <QHeaderView>
 #include <QVBoxLayout>
 #include <QAction>
+#include <QLabel>
+#include <QSpinBox>
 
 ReadRulerPreviewModel::ReadRulerPreviewModel(const ReadRulerReport& data_,
     const QVector<std::shared_ptr<RailInterval>>& intervals_, QObject* parent):
@@ -69,6 +71,18 @@ void ReadRulerPagePreview::setData(ReadRulerReport&& _report,
     table->resizeColumnsToContents();
 }
 
+void ReadRulerPagePreview::refreshResult(bool useAverage)
+{
+    this->useAverage = useAverage;
+    model->refreshData();
+    if (dlgDetail->isVisible() && detailInterval) {
+        mdDetail->setupModel(detailInterval, data.at(detailInterval), useAverage);
+    }
+    if (dlgSummary->isVisible() && summaryInterval) {
+        mdSummary->setupModel(data.at(summaryInterval));
+    }
+}
+
 void ReadRulerPagePreview::initUI()
 {
     setTitle(tr("预览"));
@@ -81,6 +95,20 @@ void ReadRulerPagePreview::initUI()
                            "严格满足标尺的数量。"
                            );
     auto* vlay=new QVBoxLayout(this);
+
+    auto* hlay = new QHBoxLayout;
+    spCutSec = new QSpinBox;
+    spCutSec->setRange(1, 100000);
+    spCutSec->setSuffix(tr(" 秒 (s)"));
+    spCutStd = new QSpinBox;
+    spCutStd->setRange(1, 100000);
+    spCutStd->setSuffix(tr(" 倍标准差"));
+    hlay->addWidget(new QLabel(tr("离群数据截断于")));
+    hlay->addWidget(spCutSec);
+    hlay->addWidget(spCutStd);
+    hlay->addStretch(1);
+    vlay->addLayout(hlay);
+
     table=new QTableView;
     table->setEditTriggers(QTableView::NoEditTriggers);
     table->verticalHeader()->setDefaultSectionSize(SystemJson::instance.table_row_height);
@@ -135,6 +163,7 @@ void ReadRulerPagePreview::actShowSummary()
     if (!idx.isValid())
         return;
     auto it = intervals.at(idx.row());
+    summaryInterval = it;
     dlgSummary->setWindowTitle(tr("类型数据 - [%1]").arg(it->toString()));
     mdSummary->setupModel(data.at(it));
     tbSummary->resizeColumnsToContents();
@@ -148,6 +177,7 @@ void ReadRulerPagePreview::onDoubleClicked(const QModelIndex& idx)
 {
     if (!idx.isValid())return;
     auto it = intervals.at(idx.row());
+    detailInterval = it;
     dlgDetail->setWindowTitle(tr("计算细节 - [%1]").arg(it->toString()));
     mdDetail->setupModel(it, data.at(it), useAverage);
     tbDetail->resizeColumnsToContents();
@@ -173,17 +203,18 @@ void ReadRulerDetailModel::setupModel(std::shared_ptr<RailInterval> railint,
     using SI = QStandardItem;
     setRowCount(static_cast<int>(itrep.raw.size()));
     int row = 0;
-    for (auto p = itrep.raw.begin(); p != itrep.raw.end(); ++p) {
-        TrainLine::IntervalAttachType tp = p->second.second;
-        setItem(row, ColTrainName, new SI(p->first->trainName().full()));
-        setItem(row, ColAttach, new SI(TrainLine::attachTypeString(p->second.second)));
-        int secstd = itrep.stdInterval(p->second.second);
+    for (const auto& sample : itrep.raw) {
+        TrainLine::IntervalAttachType tp = sample.attach;
+        setItem(row, ColTrainName, new SI(sample.train->trainName().full()));
+        setItem(row, ColAttach, new SI(TrainLine::attachTypeString(tp)));
+        int secstd = itrep.stdInterval(tp);
         setItem(row, ColStd, new SI(qeutil::secsDiffToString(secstd)));
-        int secreal = p->second.first;
+        int secreal = sample.secs;
         setItem(row, ColReal, new SI(qeutil::secsDiffToString(secreal)));
         int ds = secreal - secstd;
         setItem(row, ColDiff, new SI(QString::number(ds)));
         setItem(row, ColDiffAbs, new SI(QString::number(std::abs(ds))));
+        setItem(row, ColMark, new SI);
 
         if (useAverage) {
             // 均值模式，标记截断的数据
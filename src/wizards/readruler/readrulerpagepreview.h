@@ -12,6 +12,7 @@
 class RailInterval;
 class DialogAdapter;
 class QTableView;
+class QSpinBox;
 
 class ReadRulerPreviewModel: public QStandardItemModel
 {
@@ -88,6 +89,14 @@ class ReadRulerPagePreview : public QWizardPage
 	ReadRulerSummaryModel* mdSummary;
 	QTableView* tbDetail, * tbSummary;
 	DialogAdapter* dlgDetail, * dlgSummary;
+	std::shared_ptr<RailInterval> detailInterval, summaryInterval;
+
+	/**
+	 * 2026.10  均值模式的截断参数，与配置页同步（由Wizard连接），
+	 * 修改后由已采集的样本重新计算，不重新遍历运行线。
+	 */
+	QSpinBox* spCutSec, * spCutStd;
+	friend class ReadRulerWizard;
 
 public:
     ReadRulerPagePreview(QWidget* parent=nullptr);
@@ -96,6 +105,11 @@ public:
 		const QVector<std::shared_ptr<RailInterval>>& intervals,
 		bool useAverage);
 	auto& getData() { return data; }
+
+	/**
+	 * 2026.10  data中的计算结果已就地更新，刷新表格和已打开的细节窗口
+	 */
+	void refreshResult(bool useAverage);
 private:
     void initUI();
 
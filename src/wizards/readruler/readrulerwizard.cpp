@@ -4,6 +4,7 @@
 
 #include "data/diagram/diagram.h"
 #include "data/rail/rulernode.h"
+#include "util/utilfunc.h"
 
 #include <QInputDialog>
 #include <QLabel>
@@ -12,8 +13,11 @@
 #include <QComboBox>
 
 ReadRulerWizard::ReadRulerWizard(Diagram& diagram_, QWidget* parent) :
-    QWizard(parent), diagram(diagram_)
+    QWizard(parent), diagram(diagram_),
+    watcher(new QFutureWatcher<ReadRulerReport>(this))
 {
+    connect(watcher, &QFutureWatcher<ReadRulerReport>::finished,
+        this, &ReadRulerWizard::onCalculateFinished);
     setWindowTitle(tr("标尺综合"));
     setAttribute(Qt::WA_DeleteOnClose);
     resize(900, 800);
@@ -29,6 +33,9 @@ void ReadRulerWizard::initializePage(int id)
     else if (id == PageTrain) {
         pgTrain->refreshForRail(pgInterval->railway());
     }
+    else if (id == PageConfig) {
+        samplesValid = false;
+    }
 }
 
 void ReadRulerWizard::initUI()
@@ -45,6 +52,22 @@ void ReadRulerWizard::initUI()
     addPage(pgConfig);
     pgPreview = new ReadRulerPagePreview();
     addPage(pgPreview);
+
+    // 2026.10  预览页的截断参数与配置页同步
+    pgPreview->spCutSec->setValue(pgConfig->spCutSec->value());
+    pgPreview->spCutStd->setValue(pgConfig->spCutStd->value());
+    connect(pgPreview->spCutSec, qOverload<int>(&QSpinBox::valueChanged),
+        pgConfig->spCutSec, &QSpinBox::setValue);
+    connect(pgPreview->spCutStd, qOverload<int>(&QSpinBox::valueChanged),
+        pgConfig->spCutStd, &QSpinBox::setValue);
+    connect(pgConfig->spCutSec, qOverload<int>(&QSpinBox::valueChanged),
+        pgPreview->spCutSec, &QSpinBox::setValue);
+    connect(pgConfig->spCutStd, qOverload<int>(&QSpinBox::valueChanged),
+        pgPreview->spCutStd, &QSpinBox::setValue);
+    connect(pgConfig->spCutSec, qOverload<int>(&QSpinBox::valueChanged),
+        this, &ReadRulerWizard::onCutChanged);
+    connect(pgConfig->spCutStd, qOverload<int>(&QSpinBox::valueChanged),
+        this, &ReadRulerWizard::onCutChanged);
 }
 
 void ReadRulerWizard::initStartPage()
@@ -84,24 +107,99 @@ void ReadRulerWizard::initStartPage()
 
 void ReadRulerWizard::calculate()
 {
-    auto res = diagram.rulerFromMultiTrains(
-        pgInterval->railway(),
-        pgInterval->getIntervals(),
-        pgTrain->trains(),
-        pgConfig->gpMode->get(1)->isChecked(),
-        pgConfig->spStart->value(),
-        pgConfig->spStop->value(),
+    if (watcher->isRunning()) {
+        calculatePending = true;
+        return;
+    }
+    calculatePending = false;
+    bool useAverage = pgConfig->gpMode->get(1)->isChecked();
+    pgPreview->spCutSec->setEnabled(useAverage && pgConfig->gpFilt->button(1)->isChecked());
+    pgPreview->spCutStd->setEnabled(useAverage && pgConfig->gpFilt->button(2)->isChecked());
+    if (samplesValid) {
+        // 区间、车次未变，不必重新采集
+        synthesize();
+        return;
+    }
+    // 2026.10  后台计算；参数在此取出，线路、区间、车次换成快照中的副本，按值交给任务
+    auto railway = pgInterval->railway();
+    if (!railway)
+        return;
+    auto snap = diagram.snapshot();
+    auto snapRail = diagram.railwayInSnapshot(*snap, *railway);
+    if (!snapRail)
+        return;
+    QVector<std::shared_ptr<RailInterval>> intervals;
+    taskIntervals.clear();
+    foreach(auto it, pgInterval->getIntervals()) {
+        // 副本的车站、区间与原线路按站序一一对应
+        auto st = snapRail->stations().value(railway->stations().indexOf(it->fromStation()));
+        if (auto snapIt = st ? st->dirNextInterval(it->direction()) : nullptr) {
+            intervals.append(snapIt);
+            taskIntervals.emplace(snapIt, it);
+        }
+    }
+    qeutil::showTaskProgress(watcher, tr("标尺综合"), tr("正在综合标尺..."), this, Qt::NonModal);
+    watcher->setFuture(qetask::run<ReadRulerReport>(
+        [snap, railway = snapRail, intervals,
+        trains = diagram.trainsInSnapshot(*snap, pgTrain->trains()),
+        useAverage = pgConfig->gpMode->get(1)->isChecked(),
+        defaultStart = pgConfig->spStart->value(), defaultStop = pgConfig->spStop->value(),
+        cutStd = pgConfig->gpFilt->button(2)->isChecked() ? pgConfig->spCutStd->value() : 0,
+        cutSec = pgConfig->gpFilt->button(1)->isChecked() ? pgConfig->spCutSec->value() : 0,
+        prec = pgConfig->cbPrec->currentData(Qt::UserRole).toInt(),
+        cutCount = pgConfig->spCutCount->value()](const TaskContext& ctx) {
+            return snap->rulerFromMultiTrains(railway, intervals, trains, useAverage,
+                defaultStart, defaultStop, cutStd, cutSec, prec, cutCount, ctx);
+        }));
+}
+
+void ReadRulerWizard::onCalculateFinished()
+{
+    if (currentId() != PagePreview) {
+        // 计算期间离开了预览页，结果不再适用
+        return;
+    }
+    if (calculatePending) {
+        calculate();
+        return;
+    }
+    if (watcher->isCanceled() || watcher->future().resultCount() == 0) {
+        // 取消：回到上一页
+        back();
+        return;
+    }
+    ReadRulerReport report;
+    for (auto&& [it, rep] : watcher->result()) {
+        report.emplace(taskIntervals.at(it), std::move(rep));
+    }
+    pgPreview->setData(std::move(report), pgInterval->getIntervals(),
+        pgConfig->gpMode->get(1)->isChecked());
+    samplesValid = true;
+}
+
+void ReadRulerWizard::synthesize()
+{
+    bool useAverage = pgConfig->gpMode->get(1)->isChecked();
+    diagram.rulerFromSamples(pgPreview->getData(), useAverage,
+        pgConfig->spStart->value(), pgConfig->spStop->value(),
         pgConfig->gpFilt->button(2)->isChecked() ? pgConfig->spCutStd->value() : 0,
         pgConfig->gpFilt->button(1)->isChecked() ? pgConfig->spCutSec->value() : 0,
         pgConfig->cbPrec->currentData(Qt::UserRole).toInt(),
-        pgConfig->spCutCount->value()
-    );
-    pgPreview->setData(std::move(res), pgInterval->getIntervals(),
-        pgConfig->gpMode->get(1)->isChecked());
+        pgConfig->spCutCount->value());
+    pgPreview->refreshResult(useAverage);
+}
+
+void ReadRulerWizard::onCutChanged()
+{
+    if (samplesValid && currentId() == PagePreview && !watcher->isRunning()) {
+        synthesize();
+    }
 }
 
 void ReadRulerWizard::accept()
 {
+    if (watcher->isRunning())
+        return;
     auto ruler = pgInterval->ruler();
     if (!ruler) {
         //先创建一个标尺
@@ -3,6 +3,7 @@
 #ifndef QETRC_MOBILE_2
 
 #include <QWizard>
+#include <QFutureWatcher>
 
 #include "readrulerpageinterval.h"
 #include "readrulerpagetrain.h"
@@ -23,6 +24,22 @@ class ReadRulerWizard : public QWizard
     ReadRulerPageTrain* pgTrain;
     ReadRulerPageConfig* pgConfig;
     ReadRulerPagePreview* pgPreview;
+
+    /**
+     * 2026.10  标尺综合在后台、在Diagram::snapshot()的数据上计算，计算期间可以继续编辑运行图。
+     * 结果以快照中的区间为键，由taskIntervals换回本图的区间。
+     * 计算期间再次进入预览页时，结束后重新计算。
+     */
+    QFutureWatcher<ReadRulerReport>* const watcher;
+    std::map<std::shared_ptr<RailInterval>, std::shared_ptr<RailInterval>> taskIntervals;
+    bool calculatePending = false;
+
+    /**
+     * 2026.10  预览页的数据中已有当前区间、车次的样本。
+     * 此时调整计算参数只需由样本重新计算（Diagram::rulerFromSamples）；
+     * 进入参数配置页（即可能修改了区间、车次）时失效。
+     */
+    bool samplesValid = false;
 public:
     enum {
         PageStart = 0,
@@ -39,6 +56,18 @@ private :
     void initUI();
     void initStartPage();
     void calculate();
+
+    /**
+     * 由预览页数据中的样本，按当前参数重新计算标尺并刷新预览
+     */
+    void synthesize();
+private slots:
+    void onCalculateFinished();
+
+    /**
+     * 截断参数变化：在预览页时即时重新计算
+     */
+    void onCutChanged();
 signals:
     void rulerAdded(std::shared_ptr<Railway>, const QString& name);
     void rulerUpdated(std::shared_ptr<Ruler> ruler, std::shared_ptr<Railway> data);
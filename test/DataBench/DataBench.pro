@@ -0,0 +1,72 @@
+QT += core gui concurrent
+
+CONFIG += console warn_on c++17
+CONFIG -= app_bundle
+
+TEMPLATE = app
+TARGET = DataBench
+
+# 2026.10  数据层性能基准，仅包含数据层的源文件，不依赖widgets和界面代码
+# gui只用于QPen、QColor等值类型（车次、类型、Config中的颜色与线型），不创建QGuiApplication
+
+INCLUDEPATH += ../../src
+
+SOURCES += databench.cpp \
+    ../../src/data/algo/timetablecorrector.cpp \
+    ../../src/data/analysis/inttrains/intervalcounter.cpp \
+    ../../src/data/analysis/inttrains/intervaltraininfo.cpp \
+    ../../src/data/analysis/traingap/traingapana.cpp \
+    ../../src/data/calculation/calculationlog.cpp \
+    ../../src/data/calculation/gapconstraints.cpp \
+    ../../src/data/calculation/greedypainter.cpp \
+    ../../src/data/calculation/intervalconflictreport.cpp \
+    ../../src/data/calculation/railwaystationeventaxis.cpp \
+    ../../src/data/calculation/stationeventaxis.cpp \
+    ../../src/data/common/jsonstreamreader.cpp \
+    ../../src/data/common/qesystem.cpp \
+    ../../src/data/common/stationname.cpp \
+    ../../src/data/common/timeutil.cpp \
+    ../../src/data/diagram/binaryformat.cpp \
+    ../../src/data/diagram/config.cpp \
+    ../../src/data/diagram/diadiff.cpp \
+    ../../src/data/diagram/diagram.cpp \
+    ../../src/data/diagram/diagrampage.cpp \
+    ../../src/data/diagram/stationbinding.cpp \
+    ../../src/data/diagram/trainadapter.cpp \
+    ../../src/data/diagram/trainevents.cpp \
+    ../../src/data/diagram/traingap.cpp \
+    ../../src/data/diagram/trainline.cpp \
+    ../../src/data/diagram/trainlineindex.cpp \
+    ../../src/data/gapset/crgroups.cpp \
+    ../../src/data/gapset/crset.cpp \
+    ../../src/data/gapset/gapgroupabstract.cpp \
+    ../../src/data/gapset/gapsetabstract.cpp \
+    ../../src/data/gapset/transparentset.cpp \
+    ../../src/data/rail/forbid.cpp \
+    ../../src/data/rail/railcategory.cpp \
+    ../../src/data/rail/railinfonote.cpp \
+    ../../src/data/rail/railinterval.cpp \
+    ../../src/data/rail/railstation.cpp \
+    ../../src/data/rail/railtrack.cpp \
+    ../../src/data/rail/railway.cpp \
+    ../../src/data/rail/ruler.cpp \
+    ../../src/data/rail/rulernode.cpp \
+    ../../src/data/rail/trackdiagramdata.cpp \
+    ../../src/data/train/routing.cpp \
+    ../../src/data/train/timetablearrays.cpp \
+    ../../src/data/train/train.cpp \
+    ../../src/data/train/traincollection.cpp \
+    ../../src/data/train/trainfiltercore.cpp \
+    ../../src/data/train/trainname.cpp \
+    ../../src/data/train/trainnameindex.cpp \
+    ../../src/data/train/trainstation.cpp \
+    ../../src/data/train/trainstationindex.cpp \
+    ../../src/data/train/traintype.cpp \
+    ../../src/data/train/typeclassifier.cpp \
+    ../../src/data/train/typemanager.cpp \
+    ../../src/railnet/graph/graphinterval.cpp \
+    ../../src/railnet/graph/graphstation.cpp \
+    ../../src/railnet/graph/railnet.cpp \
+    ../../src/railnet/path/pathoperation.cpp
+
+msvc: QMAKE_CXXFLAGS += /utf-8
@@ -0,0 +1,405 @@
+﻿/**
+ * 2026.10  数据层性能基准
+ * 只使用数据层代码（不创建任何界面），对样例运行图以及按规模合成的运行图
+ * （单条线路，N个车次 × M个车站）逐项计时：
+ * JSON/二进制文件读写、车次绑定、事件表、车站事件表、全图诊断、运行图对比、
+ * 标尺综合、贪心推线、线网切片。
+ *
+ * 用法：
+ *   DataBench [--sample sample.pyetgr] [--scale 500x40 --scale 2000x80]
+ *             [--repeat 5] [--output databench.json]
+ * 每项重复repeat次（文件读入等准备数据的项目除外），记录最小、中位、平均用时（毫秒），
+ * 表格输出到标准输出，同时以JSON写入output，附版本号，用于比较不同版本间的性能变化。
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include "data/diagram/diagram.h"
+#include "data/diagram/diadiff.h"
+#include "data/diagram/binaryformat.h"
+#include "data/rail/rail.h"
+#include "data/train/train.h"
+#include "data/train/traincollection.h"
+#include "data/calculation/greedypainter.h"
+#include "data/gapset/crset.h"
+#include "railnet/graph/railnet.h"
+#include "mainwindow/version.h"
+
+namespace {
+
+    struct BenchResult {
+        QString dataset, op;
+        int trains, stations;
+        int repeat;
+        double minMs, medianMs, meanMs;
+
+        QJsonObject toJson()const {
+            return QJsonObject{
+                {"dataset", dataset}, {"op", op},
+                {"trains", trains}, {"stations", stations},
+                {"repeat", repeat},
+                {"min_ms", minMs}, {"median_ms", medianMs}, {"mean_ms", meanMs},
+            };
+        }
+    };
+
+    /**
+     * 防止被测的计算因结果未使用而被优化掉
+     */
+    volatile size_t sink = 0;
+
+    class Bench {
+        QVector<BenchResult> _results;
+        const int _repeat;
+        QTextStream _out;
+    public:
+        explicit Bench(int repeat) : _repeat(repeat), _out(stdout) {}
+
+        const auto& results()const { return _results; }
+
+        /**
+         * 对func计时repeat次。func返回任意可转为size_t的值，写入sink。
+         * repeat<=0时使用默认的重复次数。
+         */
+        template <typename Func>
+        void run(const QString& dataset, const Diagram& diagram, const QString& op,
+            Func&& func, int repeat = 0)
+        {
+            if (repeat <= 0)
+                repeat = _repeat;
+            std::vector<double> times;
+            times.reserve(repeat);
+            for (int i = 0; i < repeat; i++) {
+                QElapsedTimer timer;
+                timer.start();
+                sink = sink + static_cast<size_t>(func());
+                times.push_back(timer.nsecsElapsed() / 1e6);
+            }
+            std::sort(times.begin(), times.end());
+            BenchResult res{ dataset, op,
+                diagram.trainCollection().trainCount(), stationCount(diagram), repeat,
+                times.front(), times.at(times.size() / 2),
+                std::accumulate(times.begin(), times.end(), 0.0) / times.size() };
+            _out << QString("%1  %2  min %3 ms  median %4 ms  mean %5 ms")
+                .arg(dataset, -16).arg(op, -22)
+                .arg(res.minMs, 10, 'f', 3).arg(res.medianMs, 10, 'f', 3)
+                .arg(res.meanMs, 10, 'f', 3) << Qt::endl;
+            _results.append(res);
+        }
+
+        static int stationCount(const Diagram& diagram) {
+            int n = 0;
+            foreach(const auto & rail, diagram.railways()) {
+                n += rail->stationCount();
+            }
+            return n;
+        }
+    };
+
+    /**
+     * 合成运行图：一条nStations个车站的线路，站间距4~15 km，
+     * 标尺按120 km/h，起停附加2、3分钟；nTrains个车次上下行交替，
+     * 各自运行线路中的一段，随机始发时刻，约三成车站停车。
+     */
+    Diagram makeSynthetic(int nTrains, int nStations, quint32 seed)
+    {
+        Diagram diagram;
+        std::mt19937 gen(seed);
+
+        auto rail = std::make_shared<Railway>(QStringLiteral("合成线"));
+        std::uniform_int_distribution<int> gapDist(4, 15);
+        double mile = 0;
+        for (int i = 0; i < nStations; i++) {
+            rail->appendStation(StationName(QStringLiteral("站%1").arg(i)), mile);
+            mile += gapDist(gen);
+        }
+        auto ruler = rail->addEmptyRuler(QStringLiteral("合成标尺"), true);
+        for (auto p = rail->firstDownInterval(); p; p = p->nextInterval()) {
+            auto node = p->getRulerNode(ruler);
+            node->interval = qRound(std::abs(p->mile()) * 30);
+            node->start = 120;
+            node->stop = 180;
+        }
+        for (auto p = rail->firstUpInterval(); p; p = p->nextInterval()) {
+            auto node = p->getRulerNode(ruler);
+            node->interval = qRound(std::abs(p->mile()) * 30);
+            node->start = 120;
+            node->stop = 180;
+        }
+        rail->setOrdinate(ruler);
+        rail->calStationYCoeff();
+        diagram.addRailway(rail);
+
+        // 区间运行时分：down[i]为i->i+1，up[i]为i+1->i
+        std::vector<std::shared_ptr<const RulerNode>> down, up;
+        for (auto p = rail->firstDownInterval(); p; p = p->nextInterval())
+            down.push_back(p->getRulerNode(ruler));
+        for (auto p = rail->firstUpInterval(); p; p = p->nextInterval())
+            up.push_back(p->getRulerNode(ruler));
+        std::reverse(up.begin(), up.end());
+
+        const QStringList types{ QStringLiteral("快速"), QStringLiteral("普快"), QStringLiteral("货车") };
+        const QStringList prefixes{ "K", "", "X" };
+        std::uniform_int_distribution<int> timeDist(0, 24 * 3600 - 1);
+        std::uniform_int_distribution<int> headDist(0, std::max(0, nStations / 3 - 1));
+        std::bernoulli_distribution stopDist(0.3);
+        auto& coll = diagram.trainCollection();
+        for (int k = 0; k < nTrains; k++) {
+            const bool isDown = k % 2 == 0;
+            const int t = k % types.size();
+            auto train = std::make_shared<Train>(TrainName(
+                QString("%1%2").arg(prefixes.at(t)).arg(isDown ? 2 * k + 1 : 2 * k)));
+            train->setType(types.at(t), coll.typeManager());
+
+            // 站序号的区间[first, last]
+            int first = headDist(gen), last = nStations - 1 - headDist(gen);
+            std::vector<int> route;
+            for (int i = first; i <= last; i++)
+                route.push_back(i);
+            if (!isDown)
+                std::reverse(route.begin(), route.end());
+
+            std::vector<bool> stop(route.size());
+            for (size_t i = 0; i < route.size(); i++)
+                stop[i] = i == 0 || i + 1 == route.size() || stopDist(gen);
+
+            QTime tm = QTime(0, 0).addSecs(timeDist(gen));
+            for (size_t i = 0; i < route.size(); i++) {
+                QTime dep = (stop[i] && i != 0 && i + 1 != route.size()) ? tm.addSecs(120) : tm;
+                train->appendStation(StationName(QStringLiteral("站%1").arg(route[i])), tm, dep);
+                if (i + 1 == route.size())
+                    break;
+                const auto& node = isDown ? down.at(route[i]) : up.at(route[i + 1]);
+                int secs = node->interval;
+                if (stop[i]) secs += node->start;
+                if (stop[i + 1]) secs += node->stop;
+                tm = dep.addSecs(secs);
+            }
+            coll.appendTrain(train);
+        }
+        diagram.rebindAllTrains();
+        return diagram;
+    }
+
+    /**
+     * diffWith的对比对象：重新读入同一文件，每3个车次中有1个的全部时刻推迟1分钟
+     */
+    bool loadPerturbed(Diagram& other, const QString& filename)
+    {
+        if (!other.fromJson(filename))
+            return false;
+        const auto& trains = other.trainCollection().trains();
+        for (int i = 0; i < trains.size(); i += 3) {
+            for (auto& st : trains.at(i)->timetable()) {
+                st.arrive = st.arrive.addSecs(60);
+                st.depart = st.depart.addSecs(60);
+            }
+            trains.at(i)->invalidateTempData();
+        }
+        return true;
+    }
+
+    /**
+     * 对已读入（绑定）的运行图执行全部测试项。filename为其文件，用于读入测试。
+     */
+    void benchDiagram(Bench& bench, const QString& dataset, Diagram& diagram,
+        const QString& filename, const QString& tmpDir)
+    {
+        if (diagram.isNull()) {
+            qDebug() << "benchDiagram: WARNING: empty diagram " << dataset;
+            return;
+        }
+
+        bench.run(dataset, diagram, "json_load", [&filename]() {
+            Diagram d;
+            d.fromJson(filename);
+            return d.trainCollection().trainCount();
+            });
+        bench.run(dataset, diagram, "json_save", [&diagram]() {
+            return QJsonDocument(diagram.toJson()).toJson().size();
+            });
+        const QString binFile = tmpDir + "/" + dataset + "." + qebinary::fileSuffix;
+        {
+            QFile file(binFile);
+            if (file.open(QFile::WriteOnly))
+                file.write(qebinary::encode(diagram.toJson()));
+        }
+        bench.run(dataset, diagram, "binary_load", [&binFile]() {
+            Diagram d;
+            d.fromJson(binFile);
+            return d.trainCollection().trainCount();
+            });
+        bench.run(dataset, diagram, "binary_save", [&diagram]() {
+            return qebinary::encode(diagram.toJson()).size();
+            });
+
+        bench.run(dataset, diagram, "bind_all_trains", [&diagram]() {
+            diagram.rebindAllTrains();
+            return diagram.trainCollection().trainCount();
+            });
+
+        const auto& trains = diagram.trainCollection().trains();
+        bench.run(dataset, diagram, "list_train_events", [&diagram, &trains]() {
+            size_t n = 0;
+            for (int i = 0; i < std::min(50, static_cast<int>(trains.size())); i++) {
+                for (const auto& p : diagram.listTrainEvents(*trains.at(i)))
+                    n += p.second.size();
+            }
+            return n;
+            });
+
+        auto rail = diagram.railways().first();
+        bench.run(dataset, diagram, "station_event_axis", [&diagram, rail]() {
+            return diagram.stationEventAxisForRail(rail).size();
+            });
+
+        bench.run(dataset, diagram, "diagnose_all_trains", [&diagram]() {
+            return diagram.diagnoseAllTrains(false, nullptr, nullptr, nullptr).size();
+            });
+
+        Diagram other;
+        if (loadPerturbed(other, filename)) {
+            bench.run(dataset, diagram, "diff_with", [&diagram, &other]() {
+                return diagram.trainCollection().diffWith(other.trainCollection()).size();
+                });
+        }
+
+        QVector<std::shared_ptr<RailInterval>> intervals;
+        for (auto p = rail->firstDownInterval(); p; p = p->nextInterval())
+            intervals.append(p);
+        QList<std::shared_ptr<Train>> rulerTrains;
+        for (const auto& t : trains)
+            rulerTrains.append(t);
+        bench.run(dataset, diagram, "ruler_from_trains",
+            [&diagram, rail, &intervals, &rulerTrains]() {
+                return diagram.rulerFromMultiTrains(rail, intervals, rulerTrains,
+                    true, 120, 180).size();
+            });
+
+        auto ruler = rail->ordinate();
+        if (!ruler && !rail->rulers().empty())
+            ruler = rail->getRuler(0);
+        if (ruler && rail->stationCount() >= 2) {
+            GreedyPainter painter(diagram);
+            painter.setRailway(rail);
+            painter.setRuler(ruler);
+            painter.setDir(Direction::Down);
+            painter.setAnchor(rail->stations().front());
+            painter.setStart(rail->stations().front());
+            painter.setEnd(rail->stations().back());
+            painter.setLocalStarting(true);
+            painter.setLocalTerminal(true);
+            painter.setAnchorAsArrive(false);
+            painter.setAnchorTime(QTime(12, 0));
+            painter.setMaxBackoffTimes(10);
+            gapset::cr::CRSet gaps;
+            gaps.buildSet();
+            for (const auto& group : gaps) {
+                for (const auto& t : *group)
+                    painter.constraints()[t] = group->limit();
+            }
+            for (const auto& t : gaps.remainTypes())
+                painter.constraints()[t] = 0;
+            bench.run(dataset, diagram, "greedy_paint", [&painter]() {
+                painter.paint(TrainName("BENCH"));
+                return painter.train()->stationCount();
+                });
+        }
+
+        RailNet net;
+        bench.run(dataset, diagram, "railnet_build", [&net, &diagram]() {
+            net.clear();
+            net.fromRailCategory(&diagram.railCategory());
+            return net.size();
+            });
+        const QVector<QString> points{ rail->stations().front()->name.toSingleLiteral(),
+            rail->stations().back()->name.toSingleLiteral() };
+        bench.run(dataset, diagram, "railnet_slice", [&net, &points]() {
+            auto res = net.sliceBySinglePath(points, true, nullptr, 1);
+            return res.railway ? res.railway->stationCount() : 0;
+            });
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("qETRC data layer benchmark");
+    parser.addHelpOption();
+    QCommandLineOption optSample("sample", "sample diagram file", "file", "sample.pyetgr");
+    QCommandLineOption optScale("scale", "synthetic diagram size, trains x stations", "NxM");
+    QCommandLineOption optRepeat("repeat", "repetitions of each operation", "count", "5");
+    QCommandLineOption optOutput("output", "JSON result file", "file", "databench.json");
+    parser.addOptions({ optSample, optScale, optRepeat, optOutput });
+    parser.process(app);
+
+    QTemporaryDir tmpDir;
+    if (!tmpDir.isValid()) {
+        qDebug() << "DataBench: WARNING: cannot create temporary directory";
+        return 1;
+    }
+    Bench bench(std::max(1, parser.value(optRepeat).toInt()));
+
+    // 样例运行图
+    const QString& sample = parser.value(optSample);
+    if (QFileInfo::exists(sample)) {
+        Diagram diagram;
+        if (diagram.fromJson(sample)) {
+            foreach(const auto & rail, diagram.railways()) {
+                rail->calStationYCoeff();
+            }
+            benchDiagram(bench, "sample", diagram, sample, tmpDir.path());
+        }
+    }
+    else {
+        qDebug() << "DataBench: WARNING: sample file " << sample << " not found, skipped";
+    }
+
+    // 合成运行图
+    QStringList scales = parser.values(optScale);
+    if (scales.isEmpty())
+        scales = QStringList{ "500x40", "2000x80" };
+    for (const auto& scale : scales) {
+        const auto& parts = scale.split('x');
+        int nTrains = parts.value(0).toInt(), nStations = parts.value(1).toInt();
+        if (parts.size() != 2 || nTrains <= 0 || nStations < 2) {
+            qDebug() << "DataBench: WARNING: invalid scale " << scale;
+            continue;
+        }
+        Diagram diagram = makeSynthetic(nTrains, nStations, 20261018);
+        const QString dataset = QString("synthetic_%1").arg(scale);
+        const QString filename = tmpDir.filePath(dataset + ".pyetgr");
+        diagram.saveAs(filename);
+        benchDiagram(bench, dataset, diagram, filename, tmpDir.path());
+    }
+
+    QJsonArray arr;
+    for (const auto& res : bench.results())
+        arr.append(res.toJson());
+    QJsonObject obj{
+        {"version", QString::fromUtf8(qespec::VERSION.data(), static_cast<int>(qespec::VERSION.size()))},
+        {"release_code", qespec::RELEASE_CODE},
+        {"time", QDateTime::currentDateTime().toString(Qt::ISODate)},
+        {"results", arr},
+    };
+    QFile file(parser.value(optOutput));
+    if (!file.open(QFile::WriteOnly)) {
+        qDebug() << "DataBench: WARNING: open output file " << file.fileName() << " failed";
+        return 1;
+    }
+    file.write(QJsonDocument(obj).toJson());
+    return 0;
+}
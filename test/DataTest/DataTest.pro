@@ -1,4 +1,4 @@
-QT += testlib \
+QT += testlib concurrent \
     widgets
 
 CONFIG += qt console warn_on depend_includepath testcase
@@ -12,6 +12,8 @@ INCLUDEPATH += ../../src
 SOURCES +=  tst_railtest.cpp \
     ../../src/data/rail/railstation.cpp \
     ../../src/data/common/stationname.cpp \
+    ../../src/data/common/jsonstreamreader.cpp \
+    ../../src/data/common/timeutil.cpp \
     ../../src/data/rail/railway.cpp \
     ../../src/data/rail/railinterval.cpp \
     ../../src/data/rail/rulernode.cpp \
@@ -20,9 +22,18 @@ SOURCES +=  tst_railtest.cpp \
     ../../src/data/train/trainname.cpp \
     ../../src/data/train/trainstation.cpp \
     ../../src/data/train/train.cpp \
+    ../../src/data/train/timetablearrays.cpp \
     ../../src/data/train/traincollection.cpp \
+    ../../src/data/train/traintype.cpp \
+    ../../src/data/train/typemanager.cpp \
+    ../../src/data/train/typeclassifier.cpp \
+    ../../src/data/train/trainnameindex.cpp \
+    ../../src/data/train/trainstationindex.cpp \
     ../../src/data/diagram/trainadapter.cpp \
     ../../src/data/diagram/trainline.cpp \
+    ../../src/data/diagram/trainlineindex.cpp \
+    ../../src/data/diagram/binaryformat.cpp \
+    ../../src/data/diagram/diadiff.cpp \
     diagramwidget.cpp
 
 
@@ -9,6 +9,10 @@
 #include "data/train/train.h"
 #include "data/diagram/trainadapter.h"
 #include "data/train/traincollection.h"
+#include "data/diagram/binaryformat.h"
+#include "data/train/typemanager.h"
+#include "data/diagram/diadiff.h"
+#include "data/train/typeclassifier.h"
 
 class RailTest : public QObject
 {
@@ -36,6 +40,21 @@ private slots:
      */
     void test_case7();
 
+    /*
+     * 二进制格式与JSON格式的往返
+     */
+    void test_case8();
+
+    /*
+     * 车次时刻表对比 TrainDifference
+     */
+    void test_case9();
+
+    /*
+     * 车次类型判定 TypeClassifier 与逐个QRegExp匹配一致
+     */
+    void test_case10();
+
 };
 
 RailTest::RailTest()
@@ -219,6 +238,208 @@ void RailTest::test_case7()
     adp.print();
 }
 
+void RailTest::test_case8()
+{
+    QJsonArray timetable{
+        QJsonObject{ {"zhanming","成都"},{"ddsj","10:00:00"},{"cfsj","10:05:00"},{"business",true} },
+        QJsonObject{ {"zhanming","新都"},{"ddsj","10:20:00"},{"cfsj","10:20:00"},{"business",false} },
+    };
+    //TrainStation::toJson格式的时刻表，按定长记录存储
+    QJsonArray fixedTable{
+        QJsonObject{ {"zhanming","广元"},{"ddsj",""},{"cfsj","23:59:30"},{"business",true},{"note",""} },
+        QJsonObject{ {"zhanming","宝鸡"},{"ddsj","08:01:02"},{"cfsj","08:10:00"},{"business",false},
+            {"note","技术停车"},{"track","3"} },
+    };
+    QJsonObject obj{
+        {"trains", QJsonArray{ QJsonObject{ {"checi",QJsonArray{"K1158","K1158","K1155"}},
+            {"timetable",timetable},{"shown",true} },
+            QJsonObject{ {"checi",QJsonArray{"T8","T8",""}},{"timetable",fixedTable},{"shown",false} } } },
+        {"line", QJsonObject{ {"name","宝成线"},{"mile",12.5},{"neg",-3},{"big",1e12},{"null",QJsonValue()} } },
+        {"circuits", QJsonArray{} },
+        {"markdown", "" },
+    };
+    bool ok = false;
+    const QByteArray& data = qebinary::encode(obj);
+    QVERIFY(qebinary::isBinaryDiagram(data));
+    QCOMPARE(qebinary::decode(data, &ok), obj);
+    QVERIFY(ok);
+
+    const QJsonObject& part = qebinary::decode(data, &ok, { "line" });
+    QVERIFY(ok);
+    QCOMPARE(part.keys(), QStringList{ "line" });
+
+    const QJsonObject& noTrains = qebinary::decode(data, &ok, {}, { "trains" });
+    QVERIFY(ok);
+    QVERIFY(!noTrains.contains("trains"));
+    QCOMPARE(noTrains.value("line"), obj.value("line"));
+
+    //直接构造的车次与由JSON构造的相同
+    TypeManager manager;
+    const auto& trains = qebinary::decodeTrains(data, manager, &ok);
+    QVERIFY(ok);
+    QCOMPARE(trains.size(), 2);
+    for (int i = 0; i < trains.size(); i++) {
+        Train expected(obj.value("trains").toArray().at(i).toObject(), manager);
+        QCOMPARE(trains.at(i)->trainName().full(), expected.trainName().full());
+        QCOMPARE(trains.at(i)->isShow(), expected.isShow());
+        QCOMPARE(trains.at(i)->stationCount(), expected.stationCount());
+        auto p = trains.at(i)->timetable().cbegin();
+        for (auto q = expected.timetable().cbegin(); q != expected.timetable().cend(); ++p, ++q) {
+            QCOMPARE(p->name, q->name);
+            QCOMPARE(p->arrive, q->arrive);
+            QCOMPARE(p->depart, q->depart);
+            QCOMPARE(p->note, q->note);
+        }
+    }
+
+    //截断的数据不能解码
+    qebinary::decode(data.left(data.size() - 3), &ok);
+    QVERIFY(!ok);
+    qebinary::decodeTrains(data.left(data.size() - 3), manager, &ok);
+    QVERIFY(!ok);
+
+    //键数为0的记录数组不合法
+    QByteArray bad = qebinary::encode(QJsonObject{ {"line", QJsonArray{ QJsonObject{ {"a",1} },
+        QJsonObject{ {"a",2} } } } });
+    const int recordsAt = bad.indexOf(char(8));
+    QVERIFY(recordsAt > 0);
+    bad[recordsAt + 5] = 0;   //键数的低字节；原为1
+    qebinary::decode(bad, &ok);
+    QVERIFY(!ok);
+}
+
+namespace {
+    using stop_list_t = std::initializer_list<std::tuple<QString, QString, QString>>;
+
+    std::shared_ptr<Train> makeTrain(const stop_list_t& stops)
+    {
+        auto train = std::make_shared<Train>(TrainName("K1158"));
+        for (const auto& t : stops) {
+            train->appendStation(StationName::fromSingleLiteral(std::get<0>(t)),
+                QTime::fromString(std::get<1>(t), "hh:mm"),
+                QTime::fromString(std::get<2>(t), "hh:mm"));
+        }
+        return train;
+    }
+
+    std::vector<StationDiff::DiffType> diffTypes(const TrainDifference& diff)
+    {
+        std::vector<StationDiff::DiffType> res;
+        for (const auto& st : diff.stations)
+            res.push_back(st.type);
+        return res;
+    }
+}
+
+void RailTest::test_case9()
+{
+    using D = StationDiff;
+    const stop_list_t base{
+        {"成都","10:00","10:05"},
+        {"新都","10:20","10:20"},
+        {"广汉","10:40","10:42"},
+        {"德阳","11:00","11:05"},
+    };
+    auto t0 = makeTrain(base);
+
+    //未修改：前缀覆盖全部站
+    {
+        TrainDifference diff(t0, makeTrain(base));
+        QCOMPARE(diff.type, TrainDifference::Unchanged);
+        QCOMPARE(diff.similarity, 4);
+        QCOMPARE(diff.difference, 0);
+        QVERIFY(diffTypes(diff) == std::vector<D::DiffType>(4, D::Unchanged));
+    }
+
+    //中间插入一站
+    {
+        TrainDifference diff(t0, makeTrain({
+            {"成都","10:00","10:05"},
+            {"新都","10:20","10:20"},
+            {"青白江","10:30","10:31"},
+            {"广汉","10:40","10:42"},
+            {"德阳","11:00","11:05"},
+            }));
+        QCOMPARE(diff.type, TrainDifference::Changed);
+        QCOMPARE(diff.similarity, 4);
+        QCOMPARE(diff.difference, 1);
+        QVERIFY(diffTypes(diff) == (std::vector<D::DiffType>{ D::Unchanged, D::Unchanged,
+            D::NewAdded, D::Unchanged, D::Unchanged }));
+        QVERIFY(!diff.stations.at(2).station1.has_value());
+        QCOMPARE(diff.stations.at(2).station2.value()->name.station(), QString("青白江"));
+    }
+
+    //站名修改，时刻不变
+    {
+        TrainDifference diff(t0, makeTrain({
+            {"成都","10:00","10:05"},
+            {"新都东","10:20","10:20"},
+            {"广汉","10:40","10:42"},
+            {"德阳","11:00","11:05"},
+            }));
+        QCOMPARE(diff.type, TrainDifference::Changed);
+        QCOMPARE(diff.similarity, 3);
+        QCOMPARE(diff.difference, 1);
+        QVERIFY(diffTypes(diff) == (std::vector<D::DiffType>{ D::Unchanged, D::NameChanged,
+            D::Unchanged, D::Unchanged }));
+    }
+
+    //时刻平移
+    {
+        TrainDifference diff(t0, makeTrain({
+            {"成都","10:00","10:05"},
+            {"新都","10:20","10:20"},
+            {"广汉","10:45","10:47"},
+            {"德阳","11:00","11:05"},
+            }));
+        QCOMPARE(diff.type, TrainDifference::Changed);
+        QCOMPARE(diff.similarity, 4);
+        QCOMPARE(diff.difference, 1);
+        QVERIFY(diffTypes(diff) == (std::vector<D::DiffType>{ D::Unchanged, D::Unchanged,
+            D::BothModified, D::Unchanged }));
+    }
+}
+
+void RailTest::test_case10()
+{
+    TypeManager manager;
+    manager.initDefaultTypes();
+    //不能编译、退回QRegExp的规则：分组、选择等
+    manager.appendRegex(QRegExp(R"((GD|DJ)\d+)"), QObject::tr("分组"));
+    manager.appendRegex(QRegExp(R"(N\d+|S\d+)"), QObject::tr("选择"));
+    manager.appendRegex(QRegExp(R"((临)?K\d+[A-Z]*$)"), QObject::tr("临时"));
+    manager.appendRegex(QRegExp(R"(动\d+)"), QObject::tr("中文"));
+    manager.appendRegex(QRegExp(R"([^0-9]\w*$)"), QObject::tr("其他"));
+    const auto& regs = manager.regex();
+
+    TypeClassifier classifier(regs);
+    QVERIFY(classifier.compiledCount() > 0);
+    QVERIFY(classifier.compiledCount() < regs.size());
+
+    auto sequential = [&regs](const QString& name) {
+        for (int i = 0; i < regs.size(); i++) {
+            if (regs.at(i).first.indexIn(name) == 0)
+                return i;
+        }
+        return -1;
+    };
+
+    const QStringList names{
+        "G1", "D123", "DJ5", "GD12", "K1158/5", "K1158", "T8", "Z1", "C6001", "Y1",
+        "1234", "1234/3", "1234K", "12345", "6001", "7001", "7601", "8001A", "57001",
+        "X12", "X123", "X123A", "X1234", "X145", "0G12", "06GD", "01234",
+        "40001", "45001", "50001", "53001", "55001",
+        "N12", "S3", "临K123", "K12AB", "动123", "动车", "Ω12", "ｋ12",
+        "", "G", "K", "0", "$", "G1$", "1234$", " K1", "k1", "-1",
+    };
+    //第二轮经过查询缓存
+    for (int round = 0; round < 2; round++) {
+        for (const auto& name : names) {
+            QCOMPARE(classifier.classify(name), sequential(name));
+        }
+    }
+}
+
 QTEST_APPLESS_MAIN(RailTest)
 
 #include "tst_railtest.moc"